@@ -0,0 +1,167 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(__cpp_aligned_new) && defined(_WIN32)
+#include <malloc.h>
+#endif
+
+//a plain integer would be enough for the total, but the worker threads allocate too
+static std::atomic<unsigned long long> allocations(0);
+
+unsigned long long heapAllocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+static void* countedAllocate(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1); //new must return a unique pointer even for 0 bytes
+}
+
+#ifdef __cpp_aligned_new
+//for types aligned beyond what malloc guarantees; free() can't release these on Windows, hence the matching free below
+static void* countedAllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t bytes = size ? size : 1;
+    std::size_t align = (std::size_t)alignment < sizeof(void*) ? sizeof(void*) : (std::size_t)alignment;
+#ifdef _WIN32
+    return _aligned_malloc(bytes, align);
+#else
+    void* pointer = NULL;
+    return posix_memalign(&pointer, align, bytes) == 0 ? pointer : NULL;
+#endif
+}
+
+static void freeAligned(void* pointer)
+{
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    free(pointer);
+#endif
+}
+#endif
+
+// ------------------------------------
+//Every replaceable form of the global operator new and delete. The array and nothrow forms would fall back to the
+//plain ones on most standard libraries, but MSVC's don't have to. The std::align_val_t forms only exist from C++17 on,
+//so they are only replaced when the compiler has them.
+// ------------------------------------
+
+void* operator new(std::size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(pointer);
+}
+#endif
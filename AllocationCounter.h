@@ -0,0 +1,15 @@
+#pragma once
+
+//ALLOCATION COUNTER
+//***********************************************************
+/*
+  AllocationCounter.cpp replaces the global operator new and delete (the standard allows one replacement per program)
+  with versions that count every call before handing it to malloc/free. The renderer reads the count before and after
+  each frame, so an allocation that sneaks into the render loop shows up as a nonzero heap_allocs column in the
+  profiler instead of as a slow frame much later.
+
+  Only C++ allocations are counted: malloc calls inside GLFW or the GL driver don't go through operator new.
+*/
+
+//Total operator new calls since the program started, on every thread.
+unsigned long long heapAllocationCount();
@@ -0,0 +1,221 @@
+#include "AppOptions.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "CommandWorkers.h"
+#include "WindowPresenter.h"
+
+AppOptions::AppOptions()
+    : csvPath(NULL), instanceCount(0), gridCells(0), optimizeMesh(true),
+      positionType(VertexFormat::TYPE_FLOAT), meshCount(1), lod(false), lodThreshold(1.0f),
+      forceLoopDraws(false),
+      gpuCull(false), cpuCull(false), zoom(1.0f), animate(false), forceMapRange(false), useShaderCache(true),
+      shaderDirectory("shaders"), hotReload(true), lazyGL(false), glDebug(false),
+      workerCount(CommandWorkers::defaultWorkerCount()), pacing(FramePacer::MODE_VSYNC), targetFps(60.0), idle(false),
+      renderScale(1.0f), dynamicResolution(false), capturePrefix(NULL),
+      captureEvery(1), windowCount(1), benchmark(false),
+      warmupFrames(60), measuredFrames(300)
+{
+    //instance counts for the default benchmark sweep
+    sweep.push_back(1);
+    sweep.push_back(1000);
+    sweep.push_back(100000);
+    sweep.push_back(1000000);
+}
+
+//"1,1000,100000" -> {1, 1000, 100000}
+static bool parseList(const char* text, std::vector<int>& values)
+{
+    values.clear();
+    while (*text)
+    {
+        char* end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value <= 0)
+            return false;
+        values.push_back((int)value);
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',')
+            return false;
+    }
+    return !values.empty();
+}
+
+bool parseCommandLine(int argc, char** argv, AppOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(arg, "--csv") == 0 && hasValue)
+            options.csvPath = argv[++i];
+        else if (strcmp(arg, "--instances") == 0 && hasValue)
+            options.instanceCount = atoi(argv[++i]);
+        else if (strcmp(arg, "--grid") == 0 && hasValue)
+            options.gridCells = atoi(argv[++i]);
+        else if (strcmp(arg, "--no-mesh-optimize") == 0)
+            options.optimizeMesh = false;
+        else if (strcmp(arg, "--vertex-format") == 0 && hasValue)
+        {
+            if (!VertexFormat::parseType(argv[++i], options.positionType))
+            {
+                std::cout << "ERROR::OPTIONS::BAD_VERTEX_FORMAT " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--meshes") == 0 && hasValue)
+            options.meshCount = atoi(argv[++i]);
+        else if (strcmp(arg, "--lod") == 0)
+            options.lod = true;
+        else if (strcmp(arg, "--lod-threshold") == 0 && hasValue)
+        {
+            options.lodThreshold = (float)atof(argv[++i]);
+            options.lod = true;
+        }
+        else if (strcmp(arg, "--no-mdi") == 0)
+            options.forceLoopDraws = true;
+        else if (strcmp(arg, "--gpu-cull") == 0)
+            options.gpuCull = true;
+        else if (strcmp(arg, "--cpu-cull") == 0)
+            options.cpuCull = true;
+        else if (strcmp(arg, "--zoom") == 0 && hasValue)
+            options.zoom = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--animate") == 0)
+            options.animate = true;
+        else if (strcmp(arg, "--map-range") == 0)
+            options.forceMapRange = true;
+        else if (strcmp(arg, "--no-shader-cache") == 0)
+            options.useShaderCache = false;
+        else if (strcmp(arg, "--shader-dir") == 0 && hasValue)
+            options.shaderDirectory = argv[++i];
+        else if (strcmp(arg, "--no-hot-reload") == 0)
+            options.hotReload = false;
+        else if (strcmp(arg, "--lazy-gl") == 0)
+            options.lazyGL = true;
+        else if (strcmp(arg, "--gl-debug") == 0)
+            options.glDebug = true;
+        else if (strcmp(arg, "--idle") == 0)
+            options.idle = true;
+        else if (strcmp(arg, "--render-scale") == 0 && hasValue)
+            options.renderScale = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--dynamic-res") == 0)
+            options.dynamicResolution = true;
+        else if (strcmp(arg, "--mesh") == 0 && hasValue)
+            options.meshFiles.push_back(argv[++i]);
+        else if (strcmp(arg, "--texture") == 0 && hasValue)
+            options.textureFiles.push_back(argv[++i]);
+        else if (strcmp(arg, "--capture") == 0 && hasValue)
+            options.capturePrefix = argv[++i];
+        else if (strcmp(arg, "--capture-every") == 0 && hasValue)
+            options.captureEvery = atoi(argv[++i]);
+        else if (strcmp(arg, "--windows") == 0 && hasValue)
+            options.windowCount = atoi(argv[++i]);
+        else if (strcmp(arg, "--workers") == 0 && hasValue)
+            options.workerCount = atoi(argv[++i]);
+        else if (strcmp(arg, "--pacing") == 0 && hasValue)
+        {
+            if (!FramePacer::parseMode(argv[++i], options.pacing))
+            {
+                std::cout << "ERROR::OPTIONS::BAD_PACING_MODE " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if (strcmp(arg, "--fps") == 0 && hasValue)
+        {
+            options.targetFps = atof(argv[++i]);
+            options.pacing = FramePacer::MODE_LIMIT;
+        }
+        else if (strcmp(arg, "--benchmark") == 0)
+            options.benchmark = true;
+        else if (strcmp(arg, "--warmup") == 0 && hasValue)
+            options.warmupFrames = atoi(argv[++i]);
+        else if (strcmp(arg, "--frames") == 0 && hasValue)
+            options.measuredFrames = atoi(argv[++i]);
+        else if (strcmp(arg, "--sweep") == 0 && hasValue)
+        {
+            if (!parseList(argv[++i], options.sweep))
+            {
+                std::cout << "ERROR::OPTIONS::BAD_SWEEP_LIST " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cout << "ERROR::OPTIONS::UNKNOWN_OPTION " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.meshCount < 1)
+        options.meshCount = 1;
+    if (options.meshCount < (int)options.meshFiles.size())
+        options.meshCount = (int)options.meshFiles.size(); //every file needs a placeholder to replace
+    if (options.meshCount > MAX_MESHES)
+        options.meshCount = MAX_MESHES;
+    if (options.zoom <= 0.0f)
+        options.zoom = 1.0f;
+#ifdef _DEBUG
+    options.glDebug = true;
+#endif
+    if (options.lodThreshold <= 0.0f)
+        options.lodThreshold = 1.0f;
+    if (options.renderScale <= 0.0f || options.renderScale > 1.0f)
+        options.renderScale = 1.0f;
+    if (options.captureEvery < 1)
+        options.captureEvery = 1;
+    if (options.windowCount < 1)
+        options.windowCount = 1;
+    if (options.windowCount > WindowPresenter::MAX_WINDOWS + 1)
+        options.windowCount = WindowPresenter::MAX_WINDOWS + 1;
+    if (options.workerCount < 1)
+        options.workerCount = 1;
+    if (options.warmupFrames < 0)
+        options.warmupFrames = 0;
+    if (options.measuredFrames < 1)
+        options.measuredFrames = 1;
+    return true;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "usage: " << program << " [options]\n"
+        "  --csv <file>         write per-frame CPU/GPU phase timings to <file>\n"
+        "  --instances <n>      draw n instanced copies of the triangle (UP/DOWN change it)\n"
+        "  --grid <n>           draw an indexed n x n quad grid instead of the triangle\n"
+        "  --mesh <file>        stream a .mesh or Wavefront OBJ file in the background; repeat for more (mesh 1, 2, ...)\n"
+        "  --no-mesh-optimize   keep the mesh's original triangle and vertex order\n"
+        "  --vertex-format <t>  position storage: float, half, short, byte or packed (2_10_10_10)\n"
+        "  --meshes <n>         spread the instances over n different meshes (at most 64)\n"
+        "  --lod                draw each instance with the coarsest level of detail that looks the same\n"
+        "  --lod-threshold <px> how many pixels a level of detail may be off, implies --lod (default 1)\n"
+        "  --texture <file>     texture the instances with a KTX2 file (BC, ETC2, ASTC); repeat for more, T cycles\n"
+        "  --no-mdi             loop the draws on the CPU instead of glMultiDrawElementsIndirect\n"
+        "  --gpu-cull           frustum cull the instances in a compute shader (GL 4.3)\n"
+        "  --cpu-cull           frustum cull the instances with SIMD on the worker threads\n"
+        "  --zoom <z>           start zoomed in by z (+/- zoom, WASD or drag to pan)\n"
+        "  --animate            stream new instance data every frame\n"
+        "  --map-range          use the GL 3.3 glMapBufferRange streaming path\n"
+        "  --no-shader-cache    always compile shaders from source\n"
+        "  --shader-dir <dir>   where the .vert/.frag files are (default shaders)\n"
+        "  --no-hot-reload      don't recompile shaders when their files are saved\n"
+        "  --lazy-gl            look GL functions up on their first call instead of all at startup\n"
+        "  --gl-debug           debug context, print GL errors and performance warnings (always on in debug builds)\n"
+        "  --workers <n>        threads recording draw commands (default: cores - 2, at most 8)\n"
+        "  --pacing <mode>      vsync (default), adaptive, uncapped or limit (V cycles them)\n"
+        "  --fps <n>            limit the frame rate to n, implies --pacing limit\n"
+        "  --idle               only draw when something changed (input, resize, shaders, animation)\n"
+        "  --render-scale <s>   render offscreen at s (0.25 to 1) times the window size and scale it up\n"
+        "  --dynamic-res        pick the render scale from the GPU time to hold the frame rate\n"
+        "  --capture <prefix>   write every frame to <prefix><frame>.ppm without stalling the frame\n"
+        "  --capture-every <n>  with --capture, only every n-th frame\n"
+        "  --windows <n>        show the frames in n windows (at most 9), one per monitor, each with its own vsync\n"
+        "  --benchmark          vsync off, run the scene-size sweep and print results, then exit\n"
+        "  --warmup <n>         benchmark frames to skip before measuring each size (default 60)\n"
+        "  --frames <n>         benchmark frames measured for each size (default 300)\n"
+        "  --sweep <n,n,...>    benchmark instance counts (default 1,1000,100000,1000000)\n"
+        << std::endl;
+}
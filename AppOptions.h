@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "FramePacer.h"
+#include "VertexFormat.h"
+
+static const int MAX_MESHES = 64; //--meshes
+
+//Settings picked on the command line. See printUsage() / README.md for what each option does.
+struct AppOptions
+{
+    const char* csvPath;      //--csv <file>
+    int instanceCount;        //--instances <n>, 0 = classic single glDrawArrays
+    int gridCells;            //--grid <n>, 0 = the tutorial triangle
+    std::vector<const char*> meshFiles; //--mesh <file>, streamed in over the built-in meshes
+    bool optimizeMesh;        //--no-mesh-optimize turns it off
+    VertexFormat::Type positionType; //--vertex-format <type>
+    int meshCount;            //--meshes <n>, different meshes sharing the instances
+    bool lod;                 //--lod
+    float lodThreshold;       //--lod-threshold <px>, screen-space error a level of detail may have
+    std::vector<const char*> textureFiles; //--texture <file>, KTX2 textures the instanced draws can show
+    bool forceLoopDraws;      //--no-mdi
+    bool gpuCull;             //--gpu-cull
+    bool cpuCull;             //--cpu-cull
+    float zoom;               //--zoom <z>, starting zoom of the instanced view
+    bool animate;             //--animate
+    bool forceMapRange;       //--map-range
+    bool useShaderCache;      //--no-shader-cache turns it off
+    const char* shaderDirectory; //--shader-dir <dir>
+    bool hotReload;           //--no-hot-reload turns it off
+    bool lazyGL;              //--lazy-gl
+    bool glDebug;             //--gl-debug, always on in debug builds
+    int workerCount;          //--workers <n>, command recording threads
+    FramePacer::Mode pacing;  //--pacing <mode>
+    double targetFps;         //--fps <n>, implies --pacing limit
+    bool idle;                //--idle
+    float renderScale;        //--render-scale <s>, fraction of the window size rendered offscreen
+    bool dynamicResolution;   //--dynamic-res
+    const char* capturePrefix; //--capture <prefix>, files are <prefix><frame>.ppm
+    int captureEvery;         //--capture-every <n>
+    int windowCount;          //--windows <n>, windows showing the same frames
+
+    bool benchmark;           //--benchmark
+    int warmupFrames;         //--warmup <n>
+    int measuredFrames;       //--frames <n>
+    std::vector<int> sweep;   //--sweep <n,n,...>, instance counts for the benchmark
+
+    AppOptions();
+};
+
+//Fills options from argv. Prints the usage and returns false on an unknown or incomplete option.
+bool parseCommandLine(int argc, char** argv, AppOptions& options);
+
+void printUsage(const char* program);
@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+
+Benchmark::Benchmark(const std::vector<int>& sceneSizes, int warmup, int measured)
+    : sizes(sceneSizes), warmupFrames(warmup), measuredFrames(measured), step(0), frameInStep(0), changed(true),
+      stepTriangles(0)
+{
+    frameMs.reserve(measuredFrames);
+    lastFrame = Clock::now();
+}
+
+void Benchmark::begin(const char* mode)
+{
+    printf("# renderer=%s\n", (const char*)glGetString(GL_RENDERER));
+    printf("# vendor=%s\n", (const char*)glGetString(GL_VENDOR));
+    printf("# version=%s\n", (const char*)glGetString(GL_VERSION));
+    printf("# mode=%s warmup=%d frames=%d\n", mode, warmupFrames, measuredFrames);
+    printf("instances,triangles,frames,seconds,fps,triangles_per_sec,ms_avg,ms_min,ms_p50,ms_p90,ms_p99,ms_max\n");
+    fflush(stdout);
+    lastFrame = Clock::now();
+}
+
+int Benchmark::sceneSize() const
+{
+    return finished() ? 0 : sizes[step];
+}
+
+bool Benchmark::sceneChanged()
+{
+    bool result = changed;
+    changed = false;
+    return result;
+}
+
+void Benchmark::frameFinished(long long triangles)
+{
+    if (finished())
+        return;
+
+    Clock::time_point now = Clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    frameInStep++;
+    if (frameInStep <= warmupFrames)
+        return;
+
+    frameMs.push_back(ms);
+    stepTriangles += triangles;
+    if ((int)frameMs.size() < measuredFrames)
+        return;
+
+    printStep();
+
+    step++;
+    frameInStep = 0;
+    frameMs.clear();
+    stepTriangles = 0;
+    changed = true;
+}
+
+void Benchmark::printStep()
+{
+    std::vector<double> sorted(frameMs);
+    std::sort(sorted.begin(), sorted.end());
+    int count = (int)sorted.size();
+
+    double total = 0.0;
+    for (int i = 0; i < count; i++)
+        total += sorted[i];
+
+    //nearest-rank percentile
+    double p50 = sorted[(int)(0.50 * (count - 1) + 0.5)];
+    double p90 = sorted[(int)(0.90 * (count - 1) + 0.5)];
+    double p99 = sorted[(int)(0.99 * (count - 1) + 0.5)];
+
+    double seconds = total / 1000.0;
+    double fps = count / seconds;
+    long long triangles = (stepTriangles + count / 2) / count; //per frame, what was drawn rather than the scene size
+
+    printf("%d,%lld,%d,%.4f,%.2f,%.0f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", sizes[step], triangles, count, seconds, fps,
+        stepTriangles / seconds, total / count, sorted[0], p50, p90, p99, sorted[count - 1]);
+    fflush(stdout);
+}
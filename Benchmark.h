@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+//BENCHMARK MODE
+//***********************************************************
+/*
+  Runs the normal render loop with vsync off (glfwSwapInterval(0)) over a sweep of scene sizes. For each size the first
+  warmupFrames frames are thrown away (driver caches, shader cache, buffer growth settle there) and the next
+  measuredFrames are timed frame-to-frame with steady_clock, which includes the swap and therefore GPU back-pressure.
+
+  Results go to stdout as CSV so they can be collected by scripts and compared across drivers and hardware:
+      # lines are metadata (renderer, driver version, settings)
+      one header line, then one row per scene size
+
+  The triangle columns come from what the measured frames submitted, not from the instance count, so culling and LOD
+  selection show up in them.
+
+  The benchmark doesn't own the loop. The render loop asks it which scene size to draw, calls frameFinished() after every
+  swap, and stops when finished() is true.
+*/
+
+class Benchmark
+{
+public:
+    Benchmark(const std::vector<int>& sceneSizes, int warmupFrames, int measuredFrames);
+
+    //Prints the metadata and the CSV header. Needs a current context for the renderer strings.
+    void begin(const char* mode);
+
+    //Instance count the current step wants drawn.
+    int sceneSize() const;
+
+    //True once when a new step starts, so the caller can resize the scene.
+    bool sceneChanged();
+
+    //Call once per frame right after the swap, with the triangles the frame submitted (after culling and LOD selection).
+    void frameFinished(long long triangles);
+
+    bool finished() const { return step >= (int)sizes.size(); }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void printStep();
+
+    std::vector<int> sizes;
+    int warmupFrames;
+    int measuredFrames;
+
+    int step;
+    int frameInStep;
+    bool changed;
+    Clock::time_point lastFrame;
+    std::vector<double> frameMs; //measured frame times of the current step, reserved up front
+    long long stepTriangles;     //submitted by the measured frames of the current step
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+#include "RenderQueue.h"
+
+//DRAW COMMAND LISTS
+//***********************************************************
+/*
+  Worker threads can't call OpenGL: only the render thread has the context current. Instead they record what should be
+  drawn as plain DrawCommand structs, and the render thread replays the lists in order.
+
+  A command is everything one draw call needs: program, VAO, the vertex (or index) range, the material its DrawUniforms
+  come from, and for instanced draws the buffer the per-instance attributes come from plus the range of instances to
+  draw.
+
+  Every command also carries the sort key it is submitted by (RenderQueue.h). The worker that recorded a list sorts it
+  before handing it back; the list keeps the commands where they were recorded and only orders an index.
+*/
+
+struct DrawCommand
+{
+    GLuint program;
+    GLuint vao;
+    GLenum mode;
+    GLenum indexType; //0 = glDrawArrays, otherwise glDrawElements with the VAO's element buffer
+    GLint first;      //first vertex, or first index when indexed
+    GLsizei count;    //vertices, or indices when indexed
+    GLint baseVertex; //added to every index, indexed draws only
+
+    //instanced draws only (instanceCount > 0)
+    GLsizei instanceCount;
+    GLuint instanceBuffer;
+    GLintptr instanceBase; //byte offset of instance 0 inside instanceBuffer
+    GLint firstInstance;
+
+    int material; //which DrawUniforms the draw gets, an index into the renderer's material table
+
+    uint64_t sortKey; //makeSortKey() of the fields above
+};
+
+class CommandList
+{
+public:
+    //The storage is reserved up front and reused every frame, recording doesn't allocate once it is warm.
+    explicit CommandList(size_t reserve = 256)
+    {
+        commands.reserve(reserve);
+        order.reserve(reserve);
+        scratch.reserve(reserve);
+    }
+
+    void clear() { commands.clear(); order.clear(); }
+    void add(const DrawCommand& command) { commands.push_back(command); }
+    size_t size() const { return commands.size(); }
+    const DrawCommand& operator[](size_t index) const { return commands[index]; } //in recorded order
+
+    //Orders the commands by sortKey, equal keys in recorded order. Call once recording is done.
+    void sort()
+    {
+        order.resize(commands.size());
+        scratch.resize(commands.size());
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            SortEntry entry = { commands[i].sortKey, (uint32_t)i, 0 };
+            order[i] = entry;
+        }
+        radixSort(order.data(), scratch.data(), order.size());
+    }
+
+    //The index-th command by sort key, after sort().
+    const DrawCommand& sorted(size_t index) const { return commands[order[index].index]; }
+    uint64_t sortedKey(size_t index) const { return order[index].key; }
+
+private:
+    std::vector<DrawCommand> commands;
+    std::vector<SortEntry> order;   //by sort key
+    std::vector<SortEntry> scratch; //for the radix passes
+};
@@ -0,0 +1,102 @@
+#include "CommandWorkers.h"
+
+#include <algorithm>
+
+CommandWorkers::CommandWorkers()
+    : recorder(NULL), stopping(false), generation(0)
+{
+}
+
+CommandWorkers::~CommandWorkers()
+{
+    stop();
+}
+
+int CommandWorkers::defaultWorkerCount()
+{
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(cores - 2, 8));
+}
+
+void CommandWorkers::start(int workerCount, CommandRecorder* commandRecorder)
+{
+    stop();
+    recorder = commandRecorder;
+    stopping = false;
+    for (int i = 0; i < workerCount; i++)
+        workers.push_back(new Worker());
+    for (int i = 0; i < workerCount; i++)
+        workers[i]->thread = std::thread(&CommandWorkers::workerMain, this, i);
+}
+
+void CommandWorkers::stop()
+{
+    if (workers.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(doorbellMutex);
+        stopping = true;
+        generation++;
+    }
+    doorbell.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->thread.join();
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+void CommandWorkers::kick(const FrameJob& job)
+{
+    //the previous job was collected before this one is kicked, so the job queues always have room
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i]->jobs.push(job);
+
+    {
+        std::lock_guard<std::mutex> lock(doorbellMutex);
+        generation++;
+    }
+    doorbell.notify_all();
+}
+
+void CommandWorkers::collect(std::vector<const CommandList*>& lists)
+{
+    lists.resize(workers.size());
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        //workers usually finish while the render thread is clearing, so this rarely spins for long
+        const CommandList* list = NULL;
+        while (!workers[i]->done.pop(list))
+            std::this_thread::yield();
+        lists[i] = list;
+    }
+}
+
+void CommandWorkers::workerMain(int index)
+{
+    Worker& worker = *workers[index];
+    unsigned long long seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(doorbellMutex);
+            doorbell.wait(lock, [&] { return generation != seen; });
+            seen = generation;
+        }
+        if (stopping)
+            return;
+
+        FrameJob job;
+        while (worker.jobs.pop(job))
+        {
+            worker.list.clear();
+            recorder->record(job, index, (int)workers.size(), worker.list);
+            worker.list.sort(); //in parallel with the other workers, the render thread only merges
+            worker.done.push(&worker.list);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CommandList.h"
+#include "SpscQueue.h"
+
+//PARALLEL COMMAND RECORDING
+//***********************************************************
+/*
+  A small fixed pool of worker threads that record the frame's CommandLists in parallel.
+
+  Each frame the render thread kick()s a FrameJob. Every worker gets its own copy through its own SPSC job queue, records
+  its share of the scene into its own CommandList (see CommandRecorder::record), sorts it by the commands' sort keys
+  (RenderQueue.h) and hands the list back through its own SPSC result queue. Because every queue has exactly one
+  producer and one consumer none of them need a lock.
+
+  The only lock is the doorbell that wakes sleeping workers when a job arrives; it carries no data. collect() waits for
+  every worker's list and returns them in worker order, so replaying them is deterministic no matter which worker
+  finished first.
+*/
+
+//Shared description of the frame being recorded. Filled in by the render thread.
+struct FrameJob
+{
+    unsigned long long frame;
+    double time;
+    void* instanceData; //mapped instance region to write into, or NULL when the instance data is static
+};
+
+//Interface the recorded scene implements. record() runs on a worker thread and must not call OpenGL.
+class CommandRecorder
+{
+public:
+    virtual ~CommandRecorder() {}
+    virtual void record(const FrameJob& job, int worker, int workerCount, CommandList& out) = 0;
+};
+
+class CommandWorkers
+{
+public:
+    CommandWorkers();
+    ~CommandWorkers();
+
+    //Starts workerCount threads that record through recorder.
+    void start(int workerCount, CommandRecorder* recorder);
+    void stop();
+
+    int count() const { return (int)workers.size(); }
+
+    //Hands job to every worker and wakes them up. Returns immediately.
+    void kick(const FrameJob& job);
+
+    //Waits until every worker finished the last kicked job. lists[i] is worker i's list, valid until the next kick().
+    void collect(std::vector<const CommandList*>& lists);
+
+    //Recommended default: leave one core each for the event and the render thread.
+    static int defaultWorkerCount();
+
+private:
+    struct Worker
+    {
+        std::thread thread;
+        SpscQueue<FrameJob, 4> jobs;            //render thread -> worker
+        SpscQueue<const CommandList*, 4> done;  //worker -> render thread
+        CommandList list;
+    };
+
+    void workerMain(int index);
+
+    std::vector<Worker*> workers;
+    CommandRecorder* recorder;
+    std::atomic<bool> stopping;
+
+    //doorbell: woken once per kick, data travels through the queues
+    std::mutex doorbellMutex;
+    std::condition_variable doorbell;
+    unsigned long long generation;
+};
@@ -0,0 +1,53 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+const int DynamicResolution::SETTLE_FRAMES;
+const float DynamicResolution::HEADROOM = 0.85f;
+const float DynamicResolution::DEAD_BAND = 0.08f;
+const float DynamicResolution::MAX_STEP = 0.15f;
+
+//weight of a new sample in the smoothed GPU time
+static const double SMOOTHING = 0.2;
+
+DynamicResolution::DynamicResolution()
+    : current(1.0f), minimum(0.5f), maximum(1.0f), smoothedMs(0.0), samplesSinceChange(0), changeCount(0)
+{
+}
+
+void DynamicResolution::setRange(float minScale, float maxScale)
+{
+    minimum = minScale;
+    maximum = std::max(minScale, maxScale);
+    current = std::min(maximum, std::max(minimum, current));
+}
+
+float DynamicResolution::update(double gpuFrameMs, double budgetMs)
+{
+    if (gpuFrameMs <= 0.0 || budgetMs <= 0.0)
+        return current; //no timer query results (yet)
+
+    smoothedMs = smoothedMs > 0.0 ? smoothedMs + (gpuFrameMs - smoothedMs) * SMOOTHING : gpuFrameMs;
+    if (++samplesSinceChange < SETTLE_FRAMES)
+        return current;
+
+    double target = budgetMs * HEADROOM;
+    double error = smoothedMs / target - 1.0;
+    if (std::fabs(error) < DEAD_BAND)
+        return current;
+
+    float factor = (float)std::sqrt(target / smoothedMs);
+    factor = std::min(1.0f + MAX_STEP, std::max(1.0f - MAX_STEP, factor));
+    float next = std::min(maximum, std::max(minimum, current * factor));
+    if (next != current)
+    {
+        //the smoothed time was measured at the old size; start the new one from the expected value
+        double ratio = next / current;
+        smoothedMs *= ratio * ratio;
+        current = next;
+        changeCount++;
+    }
+    samplesSinceChange = 0;
+    return current;
+}
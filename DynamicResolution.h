@@ -0,0 +1,50 @@
+#pragma once
+
+//DYNAMIC RESOLUTION
+//***********************************************************
+/*
+  Instead of letting the frame rate drop when the GPU can't keep up, lower the number of pixels it has to shade: the
+  scene is rendered into a RenderTarget at a fraction of the window size and stretched back up. This class only picks
+  that fraction; it never touches GL.
+
+  It is fed the GPU time of every resolved frame's own work (FrameProfiler's render work spans: GL_TIME_ELAPSED around
+  the clear and around the draws and the upscale, a few frames late) and the frame budget (a display refresh, or the
+  --fps period). Neither the swap nor the wait for the worker threads is in it: with vsync the swap's wait for the
+  refresh fills up the rest of the budget, so the whole frame always looks about one refresh long, and a CPU bound
+  frame would look like fill cost that no smaller scale can take away. The GPU time is smoothed, and the scale aims
+  for HEADROOM of the budget so a single slow frame doesn't miss the refresh. Fill cost goes with the pixel count, i.e.
+  with the scale squared, so the new scale is the old one times sqrt(target / measured), limited to MAX_STEP per
+  change. After a change it waits SETTLE_FRAMES samples for the measurements to show the new size before it changes
+  again, and it ignores differences smaller than DEAD_BAND: otherwise the scale would oscillate around the target and
+  the picture would shimmer.
+
+  A GPU time that doesn't go down with the scale (vertex bound, or the time isn't spent on pixels) simply pushes the
+  scale to the minimum and leaves it there; it costs sharpness but never frame rate.
+*/
+
+class DynamicResolution
+{
+public:
+    static const int SETTLE_FRAMES = 8;
+    static const float HEADROOM;   //fraction of the frame budget the GPU time should use
+    static const float DEAD_BAND;  //relative error that is left alone
+    static const float MAX_STEP;   //largest relative change of the scale at once
+
+    DynamicResolution();
+
+    void setRange(float minScale, float maxScale);
+
+    //One resolved GPU frame. Returns the scale to render the next frames at.
+    float update(double gpuFrameMs, double budgetMs);
+
+    float scale() const { return current; }
+    int changes() const { return changeCount; }
+
+private:
+    float current;
+    float minimum;
+    float maximum;
+    double smoothedMs;
+    int samplesSinceChange;
+    int changeCount;
+};
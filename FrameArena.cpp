@@ -0,0 +1,87 @@
+#include "FrameArena.h"
+
+#include <cstdint>
+#include <new>
+
+const size_t FrameArena::DEFAULT_CAPACITY;
+const size_t FrameArena::DEFAULT_ALIGNMENT;
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameArena::FrameArena()
+    : block(NULL), blockSize(0), offset(0), overflowBlocks(NULL), overflowBytes(0), peak(0), overflows(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    shutdown();
+}
+
+void FrameArena::init(size_t capacity)
+{
+    shutdown();
+    //through operator new on purpose, so the allocation counter sees the arena's own (rare) allocations too
+    block = (char*)::operator new(capacity);
+    blockSize = capacity;
+}
+
+void FrameArena::shutdown()
+{
+    freeOverflow();
+    ::operator delete(block);
+    block = NULL;
+    blockSize = 0;
+    offset = 0;
+}
+
+void FrameArena::freeOverflow()
+{
+    while (overflowBlocks)
+    {
+        Overflow* next = overflowBlocks->next;
+        ::operator delete(overflowBlocks);
+        overflowBlocks = next;
+    }
+    overflowBytes = 0;
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    //align the address, not just the offset: the block itself is only aligned to what operator new guarantees
+    uintptr_t base = (uintptr_t)block;
+    size_t start = alignUp(base + offset, alignment) - base;
+    if (block && start + bytes <= blockSize)
+    {
+        offset = start + bytes;
+        return block + start;
+    }
+
+    //doesn't fit: a heap block just for this request, linked in so reset() can free it
+    size_t header = alignUp(sizeof(Overflow), alignment);
+    char* memory = (char*)::operator new(header + bytes + alignment);
+    Overflow* overflow = (Overflow*)memory;
+    overflow->next = overflowBlocks;
+    overflowBlocks = overflow;
+    overflowBytes += bytes + alignment;
+    return (void*)alignUp((uintptr_t)memory + header, alignment);
+}
+
+void FrameArena::reset()
+{
+    size_t frameBytes = used();
+    if (frameBytes > peak)
+        peak = frameBytes;
+
+    if (overflowBlocks)
+    {
+        //this frame didn't fit: grow once, with some headroom, so the next one does
+        overflows++;
+        freeOverflow();
+        init(alignUp(peak + peak / 2, 4096));
+    }
+    offset = 0;
+}
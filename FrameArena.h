@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+//PER-FRAME ARENA
+//***********************************************************
+/*
+  Most of what the render loop builds only lives until the frame is swapped: the merged command list, the indirect
+  slot table, scratch text. Getting that memory from the heap means a malloc and a free per object per frame, possibly
+  contended with the worker threads.
+
+  A linear arena hands it out from one big block instead: allocate() just bumps an offset, and reset() after
+  glfwSwapBuffers throws everything away at once by setting the offset back to 0. Nothing is freed individually and no
+  destructors run, so only plain data belongs in here.
+
+  If a frame needs more than the block holds, the extra requests get overflow blocks from the heap so the frame still
+  works. The next reset() frees those and replaces the main block with one big enough for that frame, so the arena
+  settles at the largest frame and steady-state frames don't allocate at all.
+*/
+
+class FrameArena
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 256 * 1024;
+    static const size_t DEFAULT_ALIGNMENT = 16;
+
+    FrameArena();
+    ~FrameArena();
+
+    void init(size_t capacity = DEFAULT_CAPACITY);
+    void shutdown();
+
+    //alignment must be a power of two
+    void* allocate(size_t bytes, size_t alignment = DEFAULT_ALIGNMENT);
+
+    //Uninitialized room for count Ts.
+    template <typename T>
+    T* allocateArray(size_t count) { return (T*)allocate(count * sizeof(T), alignof(T) > DEFAULT_ALIGNMENT ? alignof(T) : DEFAULT_ALIGNMENT); }
+
+    //Ends the frame: everything allocated since the last reset() is gone.
+    void reset();
+
+    size_t capacity() const { return blockSize; }
+    size_t used() const { return offset + overflowBytes; }
+    size_t highWater() const { return peak; } //most bytes any frame used
+    unsigned long long overflowCount() const { return overflows; } //frames that didn't fit
+
+private:
+    struct Overflow
+    {
+        Overflow* next;
+    };
+
+    FrameArena(const FrameArena&);
+    FrameArena& operator=(const FrameArena&);
+
+    void freeOverflow();
+
+    char* block;
+    size_t blockSize;
+    size_t offset;
+    Overflow* overflowBlocks; //heap blocks of this frame that didn't fit, freed by reset()
+    size_t overflowBytes;
+    size_t peak;
+    unsigned long long overflows;
+};
@@ -0,0 +1,241 @@
+#include "FrameCapture.h"
+#include "GLStateCache.h"
+
+#include <cstdio>
+#include <iostream>
+
+const int FrameCapture::RING_SIZE;
+
+//rows up to 4K wide never make the writer allocate
+static const size_t MAX_RESERVED_WIDTH = 4096;
+
+FrameCapture::FrameCapture()
+    : nextSlot(0), filePrefix(NULL), interval(1), droppedCount(0), writtenCount(0), failedCount(0), running(false)
+{
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        slots[i].capacity = 0;
+        slots[i].width = slots[i].height = 0;
+        slots[i].frame = 0;
+        slots[i].pixels = NULL;
+        slots[i].state.store(STATE_FREE);
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    //shutdown() runs with the context; this only makes sure the thread is never left running
+    if (writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+}
+
+bool FrameCapture::init(const char* prefix, int every)
+{
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        if (!slots[i].buffer.create("capture pixel buffer"))
+        {
+            std::cout << "ERROR::CAPTURE::BUFFER_CREATION_FAILED" << std::endl;
+            shutdown();
+            return false;
+        }
+    }
+    filePrefix = prefix;
+    interval = every > 1 ? every : 1;
+    row.reserve(MAX_RESERVED_WIDTH * 3); //so the writer doesn't allocate in the frames the heap counter watches
+    running = true;
+    writer = std::thread(&FrameCapture::writerMain, this);
+    return true;
+}
+
+void FrameCapture::shutdown()
+{
+    GLStateCache& glState = GLStateCache::current();
+
+    if (writer.joinable())
+    {
+        //everything already read still gets written
+        for (int i = 0; i < RING_SIZE; i++)
+        {
+            Slot& slot = slots[(nextSlot + i) % RING_SIZE];
+            if (slot.state.load(std::memory_order_acquire) == STATE_READING)
+            {
+                slot.fence.wait();
+                mapSlot(slot);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_one();
+        writer.join(); //drains the queue before it exits
+    }
+
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        Slot& slot = slots[i];
+        if (slot.pixels)
+        {
+            glState.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            slot.pixels = NULL;
+        }
+        slot.fence.reset();
+        slot.buffer.reset();
+        slot.capacity = 0;
+        slot.state.store(STATE_FREE);
+    }
+    glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::capture(unsigned long long frame, int width, int height)
+{
+    if (!active() || frame % interval != 0 || width <= 0 || height <= 0)
+        return;
+
+    Slot& slot = slots[nextSlot];
+    if (slot.state.load(std::memory_order_acquire) != STATE_FREE)
+    {
+        droppedCount++; //the writer is behind; losing a frame is better than stalling on it
+        return;
+    }
+
+    GLStateCache& glState = GLStateCache::current();
+    glState.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    size_t size = (size_t)width * height * 4;
+    if (size > slot.capacity)
+    {
+        //only when the window grew; GL_STREAM_READ: written once by the GPU, read once by us
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    //with a pack buffer bound the last argument is an offset into it, and the call returns without waiting
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0); //so a plain glReadPixels elsewhere still reads into client memory
+    slot.fence.insert();
+
+    slot.width = width;
+    slot.height = height;
+    slot.frame = frame;
+    slot.state.store(STATE_READING, std::memory_order_relaxed);
+    nextSlot = (nextSlot + 1) % RING_SIZE;
+}
+
+void FrameCapture::update()
+{
+    if (!active())
+        return;
+
+    GLStateCache& glState = GLStateCache::current();
+    for (int i = 0; i < RING_SIZE; i++)
+    {
+        Slot& slot = slots[i];
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == STATE_READING && slot.fence.signaled())
+            mapSlot(slot);
+        else if (state == STATE_WRITTEN)
+        {
+            glState.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.pixels = NULL;
+            slot.state.store(STATE_FREE, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool FrameCapture::busy() const
+{
+    for (int i = 0; i < RING_SIZE; i++)
+        if (slots[i].state.load(std::memory_order_relaxed) != STATE_FREE)
+            return true;
+    return false;
+}
+
+void FrameCapture::mapSlot(Slot& slot)
+{
+    GLStateCache& glState = GLStateCache::current();
+    glState.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    slot.pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+        (GLsizeiptr)slot.width * slot.height * 4, GL_MAP_READ_BIT);
+    glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence.reset();
+    if (!slot.pixels)
+    {
+        failedCount.fetch_add(1, std::memory_order_relaxed);
+        slot.state.store(STATE_FREE, std::memory_order_relaxed);
+        return;
+    }
+
+    //the pointer and the slot's fields are published by the release store, the queue only carries the index
+    slot.state.store(STATE_WRITING, std::memory_order_release);
+    int index = (int)(&slot - slots);
+    writeQueue.push(index); //never full: it has room for more slots than the ring has
+    std::lock_guard<std::mutex> lock(mutex);
+    wake.notify_one();
+}
+
+void FrameCapture::writerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        while (running && writeQueue.empty())
+            wake.wait(lock);
+        bool stopping = !running;
+        lock.unlock();
+
+        int index;
+        while (writeQueue.pop(index))
+        {
+            Slot& slot = slots[index];
+            writeFile(slot);
+            slot.state.store(STATE_WRITTEN, std::memory_order_release);
+        }
+
+        lock.lock();
+        if (stopping && writeQueue.empty())
+            return;
+    }
+}
+
+void FrameCapture::writeFile(const Slot& slot)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s%06llu.ppm", filePrefix, slot.frame);
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        //only the first failure is worth a line, the rest would be the same
+        if (failedCount.fetch_add(1, std::memory_order_relaxed) == 0)
+            std::cout << "WARNING::CAPTURE::CANNOT_WRITE " << path << std::endl;
+        return;
+    }
+
+    //PPM rows go top to bottom, GL's bottom to top; RGBA -> RGB on the way
+    fprintf(file, "P6\n%d %d\n255\n", slot.width, slot.height);
+    row.resize((size_t)slot.width * 3);
+    for (int y = slot.height - 1; y >= 0; y--)
+    {
+        const unsigned char* source = slot.pixels + (size_t)y * slot.width * 4;
+        for (int x = 0; x < slot.width; x++)
+        {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+}
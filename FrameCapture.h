@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GLResource.h"
+#include "SpscQueue.h"
+
+//FRAME CAPTURE
+//***********************************************************
+/*
+  glReadPixels into client memory has to return the pixels, so it waits until the GPU has finished the frame: the CPU
+  and GPU stop overlapping and the frame rate drops to whatever the round trip allows. With a buffer bound to
+  GL_PIXEL_PACK_BUFFER the same call only queues a copy into that buffer and returns immediately; the pixels are there
+  once the GPU gets to it.
+
+  So capturing runs through a ring of RING_SIZE pixel buffers, each one step of a little pipeline:
+
+      FREE      -> capture() queues glReadPixels of the back buffer into it and puts a fence behind it  -> READING
+      READING   -> update() sees the fence signaled (a few frames later), maps the buffer for reading   -> WRITING
+      WRITING   -> the writer thread encodes straight from the mapped pointer and writes the file       -> WRITTEN
+      WRITTEN   -> update() unmaps it (mapping and unmapping are GL calls, so both stay on the render thread) -> FREE
+
+  The writer never copies the pixels out first: it converts rows from the mapped memory into the file. Nothing in here
+  waits on the GPU or the disk. If every buffer is still in use (the disk can't keep up), the frame is not captured and
+  counted as dropped rather than stalling the render loop. The files are binary PPMs, numbered by frame.
+*/
+
+class FrameCapture
+{
+public:
+    static const int RING_SIZE = 4;
+
+    FrameCapture();
+    ~FrameCapture();
+
+    //Render thread with the context current. Files are written to <prefix><frame>.ppm. every > 1 captures every n-th
+    //frame only.
+    bool init(const char* prefix, int every);
+    //Waits for the captures in flight to be written, then deletes the buffers.
+    void shutdown();
+
+    bool active() const { return writer.joinable(); }
+
+    //After the frame was drawn, before the swap: queues the read of the width x height back buffer.
+    void capture(unsigned long long frame, int width, int height);
+
+    //Once per frame: hands finished reads to the writer and recycles written buffers. Never blocks.
+    void update();
+
+    //True while a read or a write is in flight, so an idle render loop keeps calling update().
+    bool busy() const;
+
+    unsigned long long written() const { return writtenCount.load(std::memory_order_relaxed); }
+    unsigned long long dropped() const { return droppedCount; }
+    unsigned long long failed() const { return failedCount.load(std::memory_order_relaxed); }
+
+private:
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator=(const FrameCapture&);
+
+    enum State
+    {
+        STATE_FREE,
+        STATE_READING,
+        STATE_WRITING,
+        STATE_WRITTEN
+    };
+
+    struct Slot
+    {
+        GLBuffer buffer;
+        GLFence fence;
+        size_t capacity;            //bytes the buffer was allocated with
+        int width;
+        int height;
+        unsigned long long frame;
+        const unsigned char* pixels; //mapped while STATE_WRITING
+        std::atomic<int> state;     //STATE_WRITING -> STATE_WRITTEN is the writer's, everything else ours
+    };
+
+    void writerMain();
+    void writeFile(const Slot& slot);
+    void mapSlot(Slot& slot);
+
+    Slot slots[RING_SIZE];
+    int nextSlot;
+    const char* filePrefix;
+    int interval;
+    unsigned long long droppedCount;
+    std::atomic<unsigned long long> writtenCount;
+    std::atomic<unsigned long long> failedCount;
+
+    std::thread writer;
+    SpscQueue<int, RING_SIZE * 2> writeQueue; //slot indices, render thread -> writer
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running;
+    std::vector<unsigned char> row; //the writer's RGB row, sized once per frame size
+};
@@ -0,0 +1,132 @@
+#include "FramePacer.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+//a sleep can overshoot by a scheduler tick, so the last part before the deadline is spun
+static const double SPIN_MARGIN = 0.002;
+
+static const char* modeNames[FramePacer::MODE_COUNT] = { "vsync", "adaptive", "uncapped", "limit" };
+
+FramePacer::FramePacer()
+    : currentMode(MODE_VSYNC), target(60.0), refreshRate(60.0), nextFrame(0.0), fineTimer(false), inputs(0), latencySum(0.0),
+      latencyMax(0.0)
+{
+}
+
+FramePacer::~FramePacer()
+{
+    setTimerResolution(false);
+}
+
+bool FramePacer::adaptiveSupported()
+{
+    return glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
+
+FramePacer::Mode FramePacer::nextMode() const
+{
+    Mode next = (Mode)((currentMode + 1) % MODE_COUNT);
+    if (next == MODE_ADAPTIVE && !adaptiveSupported())
+        next = MODE_UNCAPPED;
+    return next;
+}
+
+void FramePacer::setMode(Mode mode, double targetFps)
+{
+    if (mode == MODE_ADAPTIVE && !adaptiveSupported())
+    {
+        std::cout << "WARNING::FRAME_PACER::NO_SWAP_CONTROL_TEAR using vsync" << std::endl;
+        mode = MODE_VSYNC;
+    }
+
+    currentMode = mode;
+    target = targetFps > 0.0 ? targetFps : 60.0;
+    nextFrame = 0.0;
+    setTimerResolution(mode == MODE_LIMIT);
+
+    switch (mode)
+    {
+    case MODE_VSYNC: glfwSwapInterval(1); break;
+    case MODE_ADAPTIVE: glfwSwapInterval(-1); break;
+    default: glfwSwapInterval(0); break;
+    }
+}
+
+void FramePacer::waitForFrame()
+{
+    if (currentMode != MODE_LIMIT)
+        return;
+
+    double period = 1.0 / target;
+    double now = glfwGetTime();
+    if (nextFrame == 0.0 || now > nextFrame + period)
+    {
+        //first frame, or more than a frame late: start the schedule over from here
+        nextFrame = now + period;
+        return;
+    }
+
+    double remaining = nextFrame - now;
+    if (remaining > SPIN_MARGIN)
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_MARGIN));
+    while (glfwGetTime() < nextFrame)
+        std::this_thread::yield();
+    nextFrame += period;
+}
+
+double FramePacer::presented(double inputTime)
+{
+    if (inputTime <= 0.0)
+        return 0.0;
+    double latency = glfwGetTime() - inputTime;
+    inputs++;
+    latencySum += latency;
+    if (latency > latencyMax)
+        latencyMax = latency;
+    return latency;
+}
+
+void FramePacer::setTimerResolution(bool fine)
+{
+    if (fine == fineTimer)
+        return;
+#ifdef _WIN32
+    //the default 15.6 ms tick would make every sleep of the limiter useless
+    if (fine)
+        timeBeginPeriod(1);
+    else
+        timeEndPeriod(1);
+#endif
+    fineTimer = fine;
+}
+
+const char* FramePacer::modeName(Mode mode)
+{
+    return mode >= 0 && mode < MODE_COUNT ? modeNames[mode] : "unknown";
+}
+
+bool FramePacer::parseMode(const char* name, Mode& mode)
+{
+    for (int i = 0; i < MODE_COUNT; i++)
+    {
+        if (strcmp(name, modeNames[i]) == 0)
+        {
+            mode = (Mode)i;
+            return true;
+        }
+    }
+    return false;
+}
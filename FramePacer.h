@@ -0,0 +1,84 @@
+#pragma once
+
+//FRAME PACING
+//***********************************************************
+/*
+  How the loop lines up with the display decides between tearing and latency:
+
+  vsync       swap interval 1. No tearing, but a frame that misses a refresh waits for the next one, so the latency of
+              that frame jumps by a whole refresh period.
+  adaptive    swap interval -1 (WGL_EXT_swap_control_tear / GLX_EXT_swap_control_tear): vsync while the frame is on
+              time, an immediate (torn) swap when it is late instead of the full-period stall. Falls back to vsync
+              where the extension is missing.
+  uncapped    swap interval 0. Lowest latency, tears, and renders frames nobody sees.
+  limit       swap interval 0 plus our own limiter at a target rate (--fps). The frame waits *before* the input is
+              read instead of blocking in the swap after it, so the input it shows is as fresh as possible.
+
+  The limiter sleeps until SPIN_MARGIN before the deadline and spins the rest: sleeps overshoot by up to a scheduler
+  tick (1 ms once timeBeginPeriod(1) is set on Windows, a lot more without), a spin doesn't. A frame that comes in later
+  than a whole period restarts the schedule instead of trying to catch up with a burst of frames.
+
+  Input to present latency: every RenderEvent is stamped when the main thread posts it. The render thread passes the
+  oldest input it applied in a frame to presented(), called once glfwSwapBuffers returns. That is when the driver took
+  the frame, not when it was scanned out (only present timestamps could tell), so with vsync the real number can be up
+  to a refresh period higher.
+*/
+
+class FramePacer
+{
+public:
+    enum Mode
+    {
+        MODE_VSYNC,
+        MODE_ADAPTIVE,
+        MODE_UNCAPPED,
+        MODE_LIMIT,
+        MODE_COUNT
+    };
+
+    FramePacer();
+    ~FramePacer();
+
+    //Render thread with the context current: sets the swap interval for mode. targetFps is only used by MODE_LIMIT.
+    void setMode(Mode mode, double targetFps = 60.0);
+    Mode mode() const { return currentMode; }
+    //The mode after this one for the V key, skipping MODE_ADAPTIVE where the driver can't do it (setMode() would turn
+    //it back into vsync, and the cycle would never get past it). Context current.
+    Mode nextMode() const;
+    static bool adaptiveSupported();
+    double targetFps() const { return target; }
+
+    //Refresh rate of the display, for framePeriod(). 60 until set. The monitor is only known to the main thread.
+    void setRefreshRate(double hz) { refreshRate = hz > 0.0 ? hz : 60.0; }
+    //How often a frame would be shown: the --fps target in MODE_LIMIT, a display refresh otherwise.
+    double framePeriod() const { return currentMode == MODE_LIMIT ? 1.0 / target : 1.0 / refreshRate; }
+
+    //Start of the frame, before the input is applied. Only waits in MODE_LIMIT.
+    void waitForFrame();
+
+    //Right after the swap. inputTime is the glfwGetTime() of the oldest input the frame applied, 0 for none. Returns
+    //the latency in seconds, or 0 without input.
+    double presented(double inputTime);
+
+    unsigned long long inputCount() const { return inputs; }
+    double averageLatency() const { return inputs ? latencySum / inputs : 0.0; }
+    double maxLatency() const { return latencyMax; }
+
+    static const char* modeName(Mode mode);
+    static bool parseMode(const char* name, Mode& mode);
+
+private:
+    FramePacer(const FramePacer&);
+    FramePacer& operator=(const FramePacer&);
+
+    void setTimerResolution(bool fine);
+
+    Mode currentMode;
+    double target;
+    double refreshRate;
+    double nextFrame; //deadline of the frame about to start, MODE_LIMIT only
+    bool fineTimer;   //timeBeginPeriod(1) is in effect
+    unsigned long long inputs;
+    double latencySum;
+    double latencyMax;
+};
@@ -0,0 +1,361 @@
+#include "FrameProfiler.h"
+#include "GLDebug.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const char* PHASE_NAMES[FrameProfiler::PHASE_COUNT] = { "input", "clear", "record", "draw", "swap" };
+
+static double millisecondsBetween(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// History
+// ------------------------------------
+void FrameProfiler::History::push(double v)
+{
+    values[next] = v;
+    next = (next + 1) % HISTORY_SIZE;
+    if (count < HISTORY_SIZE)
+        count++;
+}
+
+double FrameProfiler::History::average() const
+{
+    if (count == 0)
+        return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < count; i++)
+        sum += values[i];
+    return sum / count;
+}
+
+FrameProfiler::Stats FrameProfiler::History::stats() const
+{
+    Stats s = { 0.0, 0.0, 0.0, 0.0, count };
+    if (count == 0)
+        return s;
+
+    //sort a copy on the stack so the percentile doesn't disturb the ring order or touch the heap
+    double sorted[HISTORY_SIZE];
+    std::memcpy(sorted, values, count * sizeof(double));
+    std::sort(sorted, sorted + count);
+
+    s.minMs = sorted[0];
+    s.maxMs = sorted[count - 1];
+    s.avgMs = average();
+    int p99Index = (int)(0.99 * (count - 1) + 0.5);
+    s.p99Ms = sorted[p99Index];
+    return s;
+}
+// ------------------------------------
+
+FrameProfiler::FrameProfiler()
+    : counterCount(0), currentPhase(-1), nextQuery(1), inRenderWork(false), frameCounter(0), droppedGpu(0), resolvedGpu(0),
+      latestGpuMs(0.0), latestRenderMs(0.0), initialized(false), csv(NULL), csvHeaderWritten(false)
+{
+    std::memset(slots, 0, sizeof(slots));
+    std::memset(&cpuFrames, 0, sizeof(cpuFrames));
+    std::memset(&gpuFrames, 0, sizeof(gpuFrames));
+    std::memset(cpuPhases, 0, sizeof(cpuPhases));
+    std::memset(gpuPhases, 0, sizeof(gpuPhases));
+    std::memset(counterHistory, 0, sizeof(counterHistory));
+    std::memset(counterNames, 0, sizeof(counterNames));
+    std::memset(counterValues, 0, sizeof(counterValues));
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    if (csv)
+        fclose(csv);
+}
+
+bool FrameProfiler::init()
+{
+    for (int i = 0; i < QUERY_RING_SIZE; i++)
+    {
+        glGenQueries(PHASE_COUNT + 1, slots[i].queries);
+        glGenQueries(MAX_RENDER_SPANS, slots[i].renderQueries);
+        slots[i].pending = false;
+    }
+    initialized = glGetError() == GL_NO_ERROR;
+    return initialized;
+}
+
+void FrameProfiler::shutdown()
+{
+    if (!initialized)
+        return;
+
+    //flush the frames still in flight so the CSV doesn't lose its last rows
+    glFinish();
+    //endFrame() already moved frameCounter on, so the slot it points at holds the oldest frame
+    for (int i = 0; i < QUERY_RING_SIZE; i++)
+    {
+        FrameSlot& slot = slots[(frameCounter + i) % QUERY_RING_SIZE];
+        if (slot.pending)
+            resolveSlot(slot);
+    }
+    if (csv)
+        fflush(csv);
+
+    for (int i = 0; i < QUERY_RING_SIZE; i++)
+    {
+        glDeleteQueries(PHASE_COUNT + 1, slots[i].queries);
+        glDeleteQueries(MAX_RENDER_SPANS, slots[i].renderQueries);
+    }
+    initialized = false;
+}
+
+bool FrameProfiler::openCsv(const char* path)
+{
+    if (csv)
+        fclose(csv);
+    csv = fopen(path, "w");
+    csvHeaderWritten = false;
+    return csv != NULL;
+}
+
+void FrameProfiler::writeCsvHeader()
+{
+    fprintf(csv, "frame,cpu_frame_ms");
+    for (int p = 0; p < PHASE_COUNT; p++)
+        fprintf(csv, ",cpu_%s_ms", PHASE_NAMES[p]);
+    fprintf(csv, ",gpu_frame_ms");
+    for (int p = 0; p < PHASE_COUNT; p++)
+        fprintf(csv, ",gpu_%s_ms", PHASE_NAMES[p]);
+    for (int c = 0; c < counterCount; c++)
+        fprintf(csv, ",%s", counterNames[c]);
+    fprintf(csv, "\n");
+    csvHeaderWritten = true;
+}
+
+int FrameProfiler::addCounter(const char* name)
+{
+    //a new column after the header went out would misalign the CSV
+    if (counterCount >= MAX_COUNTERS || csvHeaderWritten)
+        return -1;
+    counterNames[counterCount] = name;
+    return counterCount++;
+}
+
+void FrameProfiler::setCounter(int id, double value)
+{
+    if (id >= 0 && id < counterCount)
+        counterValues[id] = value;
+}
+
+double FrameProfiler::counterAverage(int id) const
+{
+    if (id < 0 || id >= counterCount)
+        return 0.0;
+    return counterHistory[id].average();
+}
+
+void FrameProfiler::beginFrame()
+{
+    FrameSlot& slot = slots[frameCounter % QUERY_RING_SIZE];
+
+    //The slot we are about to reuse was issued QUERY_RING_SIZE frames ago. If the GPU still isn't done with it we drop
+    //that frame's GPU sample rather than wait for it.
+    if (slot.pending)
+        resolveSlot(slot);
+
+    frameStart = Clock::now();
+    phaseStart = frameStart;
+    currentPhase = -1;
+    nextQuery = 1;
+    slot.renderSpans = 0;
+    slot.frameIndex = frameCounter;
+    slot.cpuFrameMs = 0.0;
+    for (int p = 0; p < PHASE_COUNT; p++)
+        slot.cpuPhaseMs[p] = 0.0;
+
+    if (initialized)
+        glQueryCounter(slot.queries[0], GL_TIMESTAMP);
+}
+
+void FrameProfiler::beginPhase(Phase phase)
+{
+    FrameSlot& slot = slots[frameCounter % QUERY_RING_SIZE];
+    Clock::time_point now = Clock::now();
+
+    if (currentPhase >= 0)
+        slot.cpuPhaseMs[currentPhase] += millisecondsBetween(phaseStart, now);
+    writeTimestampsUpTo(slot, phase);
+    phaseStart = now;
+
+    if (currentPhase >= 0 && currentPhase != PHASE_SWAP)
+        popGLDebugGroup();
+    if (phase != PHASE_SWAP)
+        pushGLDebugGroup(phaseName(phase));
+    currentPhase = phase;
+}
+
+void FrameProfiler::endFrame()
+{
+    FrameSlot& slot = slots[frameCounter % QUERY_RING_SIZE];
+    Clock::time_point now = Clock::now();
+
+    if (currentPhase >= 0)
+        slot.cpuPhaseMs[currentPhase] += millisecondsBetween(phaseStart, now);
+    endRenderWork();
+    writeTimestampsUpTo(slot, PHASE_COUNT);
+    slot.cpuFrameMs = millisecondsBetween(frameStart, now);
+
+    cpuFrames.push(slot.cpuFrameMs);
+    for (int p = 0; p < PHASE_COUNT; p++)
+        cpuPhases[p].push(slot.cpuPhaseMs[p]);
+    for (int c = 0; c < counterCount; c++)
+    {
+        slot.counters[c] = counterValues[c];
+        counterHistory[c].push(counterValues[c]);
+        counterValues[c] = 0.0;
+    }
+
+    slot.pending = initialized;
+    if (currentPhase >= 0 && currentPhase != PHASE_SWAP)
+        popGLDebugGroup();
+    currentPhase = -1;
+    frameCounter++;
+}
+
+void FrameProfiler::beginRenderWork()
+{
+    FrameSlot& slot = slots[frameCounter % QUERY_RING_SIZE];
+    if (!initialized || inRenderWork || slot.renderSpans == MAX_RENDER_SPANS)
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, slot.renderQueries[slot.renderSpans]);
+    inRenderWork = true;
+}
+
+void FrameProfiler::endRenderWork()
+{
+    if (!inRenderWork)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    slots[frameCounter % QUERY_RING_SIZE].renderSpans++;
+    inRenderWork = false;
+}
+
+void FrameProfiler::writeTimestampsUpTo(FrameSlot& slot, int phase)
+{
+    //queries[i] marks the end of phase i - 1. Phases that were skipped this frame get their end written at the same
+    //point as the one before them so they read back as zero length and the readback never waits on an unused query.
+    while (nextQuery <= phase)
+    {
+        if (initialized)
+            glQueryCounter(slot.queries[nextQuery], GL_TIMESTAMP);
+        nextQuery++;
+    }
+}
+
+void FrameProfiler::resolveSlot(FrameSlot& slot)
+{
+    slot.pending = false;
+
+    //the last query of the frame is written last, so once it is available all the earlier ones are too; the render
+    //spans are a different query type, their last one is asked separately
+    GLint available = 0;
+    glGetQueryObjectiv(slot.queries[PHASE_COUNT], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available && slot.renderSpans > 0)
+        glGetQueryObjectiv(slot.renderQueries[slot.renderSpans - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        droppedGpu++;
+        writeCsvRow(slot, NULL, 0.0);
+        return;
+    }
+
+    GLuint64 stamps[PHASE_COUNT + 1];
+    for (int i = 0; i <= PHASE_COUNT; i++)
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &stamps[i]);
+
+    //timestamps are in nanoseconds; clamp in case phases were entered out of order
+    double gpuPhaseMs[PHASE_COUNT];
+    GLuint64 previous = stamps[0];
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        GLuint64 stamp = std::max(stamps[p + 1], previous);
+        gpuPhaseMs[p] = (stamp - previous) / 1.0e6;
+        previous = stamp;
+        gpuPhases[p].push(gpuPhaseMs[p]);
+    }
+    double gpuFrameMs = (previous - stamps[0]) / 1.0e6;
+    gpuFrames.push(gpuFrameMs);
+    latestGpuMs = gpuFrameMs;
+    GLuint64 renderNs = 0;
+    for (int i = 0; i < slot.renderSpans; i++)
+    {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(slot.renderQueries[i], GL_QUERY_RESULT, &elapsed);
+        renderNs += elapsed;
+    }
+    latestRenderMs = renderNs / 1.0e6;
+    resolvedGpu++;
+
+    writeCsvRow(slot, gpuPhaseMs, gpuFrameMs);
+}
+
+void FrameProfiler::writeCsvRow(const FrameSlot& slot, const double* gpuPhaseMs, double gpuFrameMs)
+{
+    if (!csv)
+        return;
+    if (!csvHeaderWritten)
+        writeCsvHeader();
+
+    fprintf(csv, "%llu,%.4f", slot.frameIndex, slot.cpuFrameMs);
+    for (int p = 0; p < PHASE_COUNT; p++)
+        fprintf(csv, ",%.4f", slot.cpuPhaseMs[p]);
+
+    //a dropped GPU sample leaves the GPU columns empty instead of reporting a fake zero
+    if (gpuPhaseMs)
+    {
+        fprintf(csv, ",%.4f", gpuFrameMs);
+        for (int p = 0; p < PHASE_COUNT; p++)
+            fprintf(csv, ",%.4f", gpuPhaseMs[p]);
+    }
+    else
+    {
+        fprintf(csv, ",");
+        for (int p = 0; p < PHASE_COUNT; p++)
+            fprintf(csv, ",");
+    }
+    for (int c = 0; c < counterCount; c++)
+        fprintf(csv, ",%g", slot.counters[c]);
+    fprintf(csv, "\n");
+}
+
+FrameProfiler::Stats FrameProfiler::cpuFrameStats() const
+{
+    return cpuFrames.stats();
+}
+
+FrameProfiler::Stats FrameProfiler::gpuFrameStats() const
+{
+    return gpuFrames.stats();
+}
+
+double FrameProfiler::cpuPhaseAvgMs(Phase phase) const
+{
+    return cpuPhases[phase].average();
+}
+
+double FrameProfiler::gpuPhaseAvgMs(Phase phase) const
+{
+    return gpuPhases[phase].average();
+}
+
+void FrameProfiler::formatSummary(char* text, size_t size) const
+{
+    Stats cpu = cpuFrameStats();
+    Stats gpu = gpuFrameStats();
+    snprintf(text, size, "frame %.2f ms (min %.2f / p99 %.2f) | gpu %.2f ms (p99 %.2f) | draw cpu %.3f ms",
+        cpu.avgMs, cpu.minMs, cpu.p99Ms, gpu.avgMs, gpu.p99Ms, cpuPhaseAvgMs(PHASE_DRAW));
+}
+
+const char* FrameProfiler::phaseName(Phase phase)
+{
+    return PHASE_NAMES[phase];
+}
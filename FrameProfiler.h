@@ -0,0 +1,170 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+//FRAME PROFILER
+//***********************************************************
+/*
+  Measures every phase of the render loop on both sides of the driver:
+
+  CPU time:
+  Taken with std::chrono::steady_clock at the start of each phase. This tells us how long our own code (and the driver's
+  CPU side) spends in glClear, glDrawArrays, glfwSwapBuffers and so on. All phases run on the render thread.
+
+  GPU time:
+  Taken with GL_TIMESTAMP query objects written by glQueryCounter at the same points. GPU commands run asynchronously, so
+  the results are not ready until a few frames later. The queries live in a ring of QUERY_RING_SIZE frames and we only read
+  a slot back once GL_QUERY_RESULT_AVAILABLE says it is done, so reading results never stalls the pipeline.
+  (Timestamps are used instead of GL_TIME_ELAPSED because GL_TIME_ELAPSED queries can't be nested or overlapped, while one
+  timestamp per phase boundary gives every phase duration at once.)
+
+  Render work:
+  A phase's GPU time is only the gap between two timestamps, which includes the GPU sitting idle while the CPU waits
+  for the workers' command lists or is still submitting. For the time the frame's own GPU work takes (what dynamic
+  resolution scales with), the renderer brackets the clear and the draws with beginRenderWork()/endRenderWork(), which
+  are GL_TIME_ELAPSED queries (they never overlap each other) and leave the waits between them out.
+
+  Stats:
+  The last HISTORY_SIZE frame times are kept to report a rolling min/avg/p99/max. Every resolved frame can also be written
+  as a row to a CSV file.
+
+  Counters:
+  Other subsystems can register a named per-frame counter (state changes avoided, allocations, ...) with addCounter() and
+  set its value each frame. Counters are averaged like the phase times and get their own CSV column.
+
+  Debug groups:
+  Every phase but the swap also runs inside a GL debug group of its name (GLDebug.h), so a RenderDoc or Nsight capture
+  shows the same phases as the stats. The swap stays outside: its group would close after the frame boundary the
+  capture tools cut at.
+*/
+
+class FrameProfiler
+{
+public:
+    //Phases of the render loop, in the order they run each frame.
+    enum Phase
+    {
+        PHASE_INPUT,  //applying the events the event thread forwarded
+        PHASE_CLEAR,
+        PHASE_RECORD, //waiting for the worker threads' command lists
+        PHASE_DRAW,
+        PHASE_SWAP,
+        PHASE_COUNT
+    };
+
+    static const int QUERY_RING_SIZE = 3; //frames a GPU query may be in flight before we look at it again
+    static const int HISTORY_SIZE = 240;  //frames kept for the rolling statistics
+    static const int MAX_COUNTERS = 16;
+    static const int MAX_RENDER_SPANS = 4; //beginRenderWork()/endRenderWork() pairs per frame
+
+    struct Stats
+    {
+        double minMs;
+        double avgMs;
+        double p99Ms;
+        double maxMs;
+        int samples;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    bool init(); //creates the query objects, needs a current GL context
+    void shutdown();
+
+    //Start writing one row per resolved frame to a CSV file. Returns false if the file can't be opened.
+    //The header is written with the first row, so counters may still be added after this.
+    bool openCsv(const char* path);
+
+    //Registers a per-frame counter and returns its id, or -1 when all MAX_COUNTERS are taken. name must stay valid.
+    int addCounter(const char* name);
+    //Sets the counter's value for the frame being recorded. Counters not set in a frame read as 0.
+    void setCounter(int id, double value);
+    double counterAverage(int id) const;
+
+    void beginFrame();
+    void beginPhase(Phase phase);
+    void endFrame();
+
+    //GL_TIME_ELAPSED around GPU work of the frame, up to MAX_RENDER_SPANS times a frame; their sum is
+    //latestGpuRenderMs(). Leave CPU waits outside the spans.
+    void beginRenderWork();
+    void endRenderWork();
+
+    Stats cpuFrameStats() const;
+    Stats gpuFrameStats() const;
+    double cpuPhaseAvgMs(Phase phase) const;
+    double gpuPhaseAvgMs(Phase phase) const;
+    unsigned long long droppedGpuFrames() const { return droppedGpu; }
+
+    //The newest GPU frame time, QUERY_RING_SIZE frames old, and how many frames have been resolved so far; a caller
+    //reacting to the GPU time only looks again once the count moved.
+    double latestGpuFrameMs() const { return latestGpuMs; }
+    //Of the same frame, the sum of its render work spans: the GPU work of the frame itself, without the swap (and the
+    //vsync wait inside it) or the GPU idling while the CPU handles input or waits for the workers.
+    double latestGpuRenderMs() const { return latestRenderMs; }
+    unsigned long long resolvedGpuFrames() const { return resolvedGpu; }
+
+    //Short one-line summary, used as the window title overlay. Writes into the caller's buffer so it never allocates.
+    void formatSummary(char* text, size_t size) const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    //one frame in flight: GPU timestamps plus the CPU times recorded for the same frame
+    struct FrameSlot
+    {
+        GLuint queries[PHASE_COUNT + 1];
+        GLuint renderQueries[MAX_RENDER_SPANS];
+        int renderSpans; //render work spans ended this frame
+        double cpuPhaseMs[PHASE_COUNT];
+        double cpuFrameMs;
+        double counters[MAX_COUNTERS];
+        unsigned long long frameIndex;
+        bool pending;
+    };
+
+    struct History
+    {
+        double values[HISTORY_SIZE];
+        int count;
+        int next;
+        void push(double v);
+        Stats stats() const;
+        double average() const;
+    };
+
+    void writeTimestampsUpTo(FrameSlot& slot, int phase);
+    void resolveSlot(FrameSlot& slot);
+    void writeCsvHeader();
+    void writeCsvRow(const FrameSlot& slot, const double* gpuPhaseMs, double gpuFrameMs);
+
+    FrameSlot slots[QUERY_RING_SIZE];
+    History cpuFrames;
+    History gpuFrames;
+    History cpuPhases[PHASE_COUNT];
+    History gpuPhases[PHASE_COUNT];
+    History counterHistory[MAX_COUNTERS];
+    const char* counterNames[MAX_COUNTERS];
+    double counterValues[MAX_COUNTERS];
+    int counterCount;
+
+    Clock::time_point frameStart;
+    Clock::time_point phaseStart;
+    int currentPhase;
+    int nextQuery;
+    bool inRenderWork;
+    unsigned long long frameCounter;
+    unsigned long long droppedGpu;
+    unsigned long long resolvedGpu;
+    double latestGpuMs;
+    double latestRenderMs;
+    bool initialized;
+    FILE* csv;
+    bool csvHeaderWritten;
+};
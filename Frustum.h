@@ -0,0 +1,48 @@
+#pragma once
+
+//VIEW FRUSTUM
+//***********************************************************
+/*
+  The instances are placed in a 2D world that the instanced vertex shader maps to clip space with a pan and a zoom:
+      clip = (world - pan) * zoom
+  Only world positions within 1 / zoom of the pan end up inside the [-1, 1] clip square, and everything else is thrown
+  away by the clipper, but only after its vertices were fetched and shaded.
+
+  Culling rejects those objects earlier. Each side of the visible area is a plane (a, b, c, d) whose normal points
+  inwards: a point p is on the visible side when dot(abc, p) + d >= 0. A bounding sphere with center p and radius r is
+  completely outside when dot(abc, p) + d < -r for any of the planes. That's conservative: some spheres pass the test
+  while their mesh is still invisible, but nothing visible is ever rejected.
+*/
+
+struct Frustum
+{
+    static const int PLANE_COUNT = 4; //left, right, bottom, top; no near/far in 2D
+
+    float planes[PLANE_COUNT][4];
+
+    static Frustum fromView(float panX, float panY, float zoom)
+    {
+        float halfExtent = 1.0f / zoom;
+        Frustum frustum;
+        float values[PLANE_COUNT][4] = {
+            {  1.0f,  0.0f, 0.0f, -(panX - halfExtent) }, //x >= panX - halfExtent
+            { -1.0f,  0.0f, 0.0f,   panX + halfExtent  }, //x <= panX + halfExtent
+            {  0.0f,  1.0f, 0.0f, -(panY - halfExtent) },
+            {  0.0f, -1.0f, 0.0f,   panY + halfExtent  }
+        };
+        for (int p = 0; p < PLANE_COUNT; p++)
+            for (int i = 0; i < 4; i++)
+                frustum.planes[p][i] = values[p][i];
+        return frustum;
+    }
+
+    bool sphereVisible(float x, float y, float z, float radius) const
+    {
+        for (int p = 0; p < PLANE_COUNT; p++)
+        {
+            if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < -radius)
+                return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,150 @@
+#include "GLDebug.h"
+#include "GLExtensions.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+    const int MAX_TRACKED_MESSAGES = 128;
+    const int PRINTS_PER_MESSAGE = 3;
+
+    struct TrackedMessage
+    {
+        GLenum source;
+        GLenum type;
+        GLuint id;
+        int seen;
+    };
+
+    std::atomic<bool> outputEnabled(false);
+    std::atomic<unsigned long long> errorCount(0);
+    std::atomic<unsigned long long> performanceCount(0);
+    std::atomic<unsigned long long> otherCount(0);
+
+    //asynchronous output may call back from a driver thread, and every context has its own callback
+    std::mutex trackMutex;
+    TrackedMessage tracked[MAX_TRACKED_MESSAGES];
+    int trackedCount = 0;
+
+    const char* sourceName(GLenum source)
+    {
+        switch (source)
+        {
+        case GL_DEBUG_SOURCE_API: return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+        }
+    }
+
+    const char* typeName(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_DEBUG_TYPE_ERROR: return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED_BEHAVIOR";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED_BEHAVIOR";
+        case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+        case GL_DEBUG_TYPE_MARKER: return "MARKER";
+        default: return "OTHER";
+        }
+    }
+
+    const char* severityName(GLenum severity)
+    {
+        switch (severity)
+        {
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        default: return "notification";
+        }
+    }
+
+    //How often this message was seen before, counting this time. The table only fills up with distinct ids; past that
+    //every new id counts as seen often enough, so a driver that makes up ids can't flood the console.
+    int track(GLenum source, GLenum type, GLuint id)
+    {
+        std::lock_guard<std::mutex> lock(trackMutex);
+        for (int i = 0; i < trackedCount; i++)
+        {
+            if (tracked[i].source == source && tracked[i].type == type && tracked[i].id == id)
+                return ++tracked[i].seen;
+        }
+        if (trackedCount == MAX_TRACKED_MESSAGES)
+            return PRINTS_PER_MESSAGE + 1;
+        TrackedMessage message = { source, type, id, 1 };
+        tracked[trackedCount++] = message;
+        return 1;
+    }
+
+    void APIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+        const GLchar* message, const void* userParam)
+    {
+        (void)length; //message is null-terminated
+        bool error = type == GL_DEBUG_TYPE_ERROR || type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR;
+        if (error)
+            errorCount.fetch_add(1);
+        else if (type == GL_DEBUG_TYPE_PERFORMANCE)
+            performanceCount.fetch_add(1);
+        else
+            otherCount.fetch_add(1);
+
+        int seen = track(source, type, id);
+        if (seen > PRINTS_PER_MESSAGE)
+            return;
+        std::cout << (error ? "ERROR::GL::" : "WARNING::GL::") << typeName(type) << " (" << (const char*)userParam
+            << " context, " << sourceName(source) << ", " << severityName(severity) << ", id " << id << "): "
+            << message << (seen == PRINTS_PER_MESSAGE ? " (repeats are only counted from now on)" : "") << std::endl;
+    }
+}
+
+void enableGLDebugOutput(const char* contextName, bool synchronous)
+{
+    if (!glext.debug)
+        return;
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glext.DebugMessageCallback(debugCallback, contextName);
+
+    //notifications are mostly chatter (buffer placement, our own debug groups), except for performance hints; the
+    //later call wins for the messages both match
+    glext.DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+    glext.DebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+    outputEnabled.store(true);
+}
+
+bool glDebugOutputEnabled()
+{
+    return outputEnabled.load();
+}
+
+void labelGLObject(GLenum identifier, GLuint name, const char* label)
+{
+    if (glext.debug && name && label)
+        glext.ObjectLabel(identifier, name, -1, label);
+}
+
+void pushGLDebugGroup(const char* name)
+{
+    if (glext.debug)
+        glext.PushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void popGLDebugGroup()
+{
+    if (glext.debug)
+        glext.PopDebugGroup();
+}
+
+GLDebugCounts glDebugCounts()
+{
+    GLDebugCounts counts = { errorCount.load(), performanceCount.load(), otherCount.load() };
+    return counts;
+}
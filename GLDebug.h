@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glad/glad.h>
+
+//GL DEBUG OUTPUT
+//***********************************************************
+/*
+  glGetError only says that something went wrong, not what or where, and the driver's performance warnings (a buffer
+  moved to system memory, a shader recompiled for a new state, a sync stall) never show up at all. KHR_debug (core in
+  GL 4.3) gives the driver a channel to say so: a callback that gets every message with its source, type, id and
+  severity. Drivers only say much on a debug context (GLFW_OPENGL_DEBUG_CONTEXT), which debug builds and --gl-debug
+  ask for.
+
+  The callback prints errors, undefined behavior and performance warnings with the context they came from, every other
+  message that isn't a mere notification as a warning, and counts them all. A message that keeps coming (the same
+  source, type and id every frame) is printed a few times and then only counted.
+
+  The same extension lets a capture tool (RenderDoc, Nsight) show our names instead of numbers: every GL object the
+  GLObjects registry knows gets its label with glObjectLabel, and the frame profiler puts each phase of the render loop
+  into a debug group of the phase's name. Those two work on any context that has the extension, debug or not.
+*/
+
+//Sends the debug messages of the context current on this thread to the callback. contextName tags its messages
+//("render", "upload"). synchronous makes the driver call back from inside the GL call that caused the message, so a
+//breakpoint in the callback shows the caller. Does nothing without KHR_debug.
+void enableGLDebugOutput(const char* contextName, bool synchronous);
+
+//Whether enableGLDebugOutput() ran for any context, so further contexts can follow.
+bool glDebugOutputEnabled();
+
+//glObjectLabel / glPushDebugGroup / glPopDebugGroup, or nothing without KHR_debug.
+void labelGLObject(GLenum identifier, GLuint name, const char* label);
+void pushGLDebugGroup(const char* name);
+void popGLDebugGroup();
+
+//Messages seen so far on every context, printed or not. Any thread.
+struct GLDebugCounts
+{
+    unsigned long long errors;      //GL_DEBUG_TYPE_ERROR and GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR
+    unsigned long long performance; //GL_DEBUG_TYPE_PERFORMANCE
+    unsigned long long other;
+};
+GLDebugCounts glDebugCounts();
@@ -0,0 +1,161 @@
+#include "GLDeletionQueue.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+const int GLDeletionQueue::MAX_PENDING;
+const int GLDeletionQueue::MAX_BATCHES;
+const int GLDeletionQueue::KIND_SYNC;
+
+static thread_local GLDeletionQueue* currentQueue = NULL;
+
+GLDeletionQueue::GLDeletionQueue()
+    : head(0), count(0), batchHead(0), batchCount(0), currentBatch(0), deleted(0), isFallback(false)
+{
+}
+
+void GLDeletionQueue::makeCurrent()
+{
+    currentQueue = this;
+}
+
+GLDeletionQueue& GLDeletionQueue::current()
+{
+    static thread_local GLDeletionQueue fallback;
+    fallback.isFallback = true;
+    return currentQueue ? *currentQueue : fallback;
+}
+
+void GLDeletionQueue::enqueue(GLObjects::Kind kind, GLuint name)
+{
+    if (!name)
+        return;
+    Entry entry = { kind, name, 0, currentBatch };
+    push(entry);
+}
+
+void GLDeletionQueue::enqueue(GLsync sync)
+{
+    if (!sync)
+        return;
+    Entry entry = { KIND_SYNC, 0, sync, currentBatch };
+    push(entry);
+}
+
+void GLDeletionQueue::push(const Entry& entry)
+{
+    if (isFallback)
+    {
+        std::cout << "WARNING::GL_DELETION_QUEUE::NO_CONTEXT object dropped" << std::endl;
+        return;
+    }
+
+    //full: make room by waiting for the oldest fenced frame, or delete unfenced entries outright if nothing is fenced
+    while (count == MAX_PENDING)
+    {
+        if (batchCount > 0)
+        {
+            retireOldestBatch(true);
+        }
+        else
+        {
+            destroy(entries[head]);
+            head = (head + 1) % MAX_PENDING;
+            count--;
+        }
+    }
+    entries[(head + count) % MAX_PENDING] = entry;
+    count++;
+}
+
+void GLDeletionQueue::destroy(const Entry& entry)
+{
+    GLStateCache& glState = GLStateCache::current();
+    switch (entry.kind)
+    {
+    case GLObjects::KIND_BUFFER:
+        glDeleteBuffers(1, &entry.name);
+        glState.forgetBuffer(entry.name);
+        break;
+    case GLObjects::KIND_VERTEX_ARRAY:
+        glDeleteVertexArrays(1, &entry.name);
+        glState.forgetVertexArray(entry.name);
+        break;
+    case GLObjects::KIND_SHADER:
+        glDeleteShader(entry.name);
+        break;
+    case GLObjects::KIND_PROGRAM:
+        glDeleteProgram(entry.name);
+        glState.forgetProgram(entry.name);
+        break;
+    case GLObjects::KIND_TEXTURE:
+        glDeleteTextures(1, &entry.name);
+        glState.forgetTexture(entry.name);
+        break;
+    case GLObjects::KIND_FRAMEBUFFER:
+        glDeleteFramebuffers(1, &entry.name);
+        break;
+    case KIND_SYNC:
+        glDeleteSync(entry.sync);
+        break;
+    }
+    if (entry.kind != KIND_SYNC)
+        GLObjects::current().remove((GLObjects::Kind)entry.kind, entry.name);
+    deleted++;
+}
+
+void GLDeletionQueue::retireOldestBatch(bool wait)
+{
+    Batch& batch = batches[batchHead];
+    if (wait)
+    {
+        GLenum result = glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        while (result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(batch.fence, 0, 1000000);
+    }
+
+    //everything queued up to and including that frame is safe now
+    while (count > 0 && entries[head].batch <= batch.id)
+    {
+        destroy(entries[head]);
+        head = (head + 1) % MAX_PENDING;
+        count--;
+    }
+    glDeleteSync(batch.fence);
+    batchHead = (batchHead + 1) % MAX_BATCHES;
+    batchCount--;
+}
+
+void GLDeletionQueue::endFrame()
+{
+    //fence this frame's entries, if there are any
+    if (count > 0 && entries[(head + count - 1) % MAX_PENDING].batch == currentBatch)
+    {
+        if (batchCount == MAX_BATCHES)
+            retireOldestBatch(true);
+        Batch batch = { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), currentBatch };
+        batches[(batchHead + batchCount) % MAX_BATCHES] = batch;
+        batchCount++;
+    }
+    currentBatch++;
+
+    //delete whatever the GPU is done with; a fence that isn't signaled yet is simply checked again next frame
+    while (batchCount > 0 && glClientWaitSync(batches[batchHead].fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+        retireOldestBatch(false);
+}
+
+void GLDeletionQueue::flush()
+{
+    while (count > 0)
+    {
+        destroy(entries[head]);
+        head = (head + 1) % MAX_PENDING;
+        count--;
+    }
+    while (batchCount > 0)
+    {
+        glDeleteSync(batches[batchHead].fence);
+        batchHead = (batchHead + 1) % MAX_BATCHES;
+        batchCount--;
+    }
+}
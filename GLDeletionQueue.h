@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLObjects.h"
+
+//DEFERRED DELETION
+//***********************************************************
+/*
+  glDeleteBuffers on a buffer the GPU is still reading can't actually free it: the driver either waits for the GPU
+  right there or keeps the storage alive behind our back and cleans up later, and we don't get to choose which.
+
+  The GLResource wrappers don't delete anything themselves. They queue the name here, and at the end of each frame the
+  queue puts one fence behind the frame's commands. Once that fence is signaled, nothing the GPU still has to do can
+  reference the objects queued before it, and they are deleted for real. In steady state that is a few frames later,
+  checked without ever blocking.
+
+  The queue is a fixed ring, like everything else the render loop touches, so queueing never allocates. If it fills up
+  (thousands of deletions in a frame or two) the oldest batch is waited for; that is the only time it blocks.
+
+  One queue per context, made current on the thread that has the context; GLDeletionQueue::current() returns it.
+  Names queued on a thread without one are dropped with a warning: there is no context to delete them with, and they
+  disappear with the context anyway.
+*/
+
+class GLDeletionQueue
+{
+public:
+    static const int MAX_PENDING = 512; //objects waiting for their fence
+    static const int MAX_BATCHES = 8;   //fenced frames in flight
+
+    GLDeletionQueue();
+
+    void makeCurrent();
+    static GLDeletionQueue& current();
+
+    void enqueue(GLObjects::Kind kind, GLuint name);
+    void enqueue(GLsync sync);
+
+    //Once per frame after the swap: fences what was queued this frame and deletes what the GPU is done with.
+    void endFrame();
+
+    //Deletes everything right away, fenced or not. For shutdown, once nothing is drawn anymore.
+    void flush();
+
+    int pendingCount() const { return count; }
+    unsigned long long deletedCount() const { return deleted; }
+
+private:
+    static const int KIND_SYNC = GLObjects::KIND_COUNT; //marks sync entries, which have no GLuint name
+
+    struct Entry
+    {
+        int kind;
+        GLuint name;
+        GLsync sync;
+        unsigned long long batch; //frame that queued it
+    };
+
+    struct Batch
+    {
+        GLsync fence;
+        unsigned long long id;
+    };
+
+    void push(const Entry& entry);
+    void destroy(const Entry& entry);
+    void retireOldestBatch(bool wait);
+
+    Entry entries[MAX_PENDING]; //FIFO ring, oldest first
+    int head;
+    int count;
+    Batch batches[MAX_BATCHES];
+    int batchHead;
+    int batchCount;
+    unsigned long long currentBatch;
+    unsigned long long deleted;
+    bool isFallback; //current() of a thread that never made a queue current
+};
@@ -0,0 +1,126 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+GLExtensions glext;
+
+bool glVersionAtLeast(int major, int minor)
+{
+    return glext.major > major || (glext.major == major && glext.minor >= minor);
+}
+
+bool hasGLExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+    memset(&glext, 0, sizeof(glext));
+    glGetIntegerv(GL_MAJOR_VERSION, &glext.major);
+    glGetIntegerv(GL_MINOR_VERSION, &glext.minor);
+
+    // buffer storage: core in 4.4, otherwise ARB_buffer_storage
+    // ------------------------------------
+    if (glVersionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+    {
+        glext.BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+        glext.bufferStorage = glext.BufferStorage != NULL;
+    }
+    // ------------------------------------
+
+    // program binaries: core in 4.1, otherwise ARB_get_program_binary
+    // ------------------------------------
+    if (glVersionAtLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+    {
+        glext.GetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+        glext.ProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+        glext.ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+
+        //drivers are allowed to support the API with zero formats, which makes it useless
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        glext.programBinary = glext.GetProgramBinary && glext.ProgramBinary && glext.ProgramParameteri && formats > 0;
+    }
+    // ------------------------------------
+
+    // multi-draw indirect: core in 4.3. The extension alone doesn't make the GPU honor the baseInstance field of the
+    // commands (which offsets the per-instance attributes), that takes 4.2 or ARB_base_instance.
+    // ------------------------------------
+    bool baseInstance = glVersionAtLeast(4, 2) || hasGLExtension("GL_ARB_base_instance");
+    if (glVersionAtLeast(4, 3) || (baseInstance && hasGLExtension("GL_ARB_multi_draw_indirect")))
+    {
+        glext.MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+        glext.multiDrawIndirect = glext.MultiDrawElementsIndirect != NULL;
+    }
+    // ------------------------------------
+
+    // compute shaders: core in 4.3; they are only useful to us together with shader storage buffers
+    // ------------------------------------
+    if (glVersionAtLeast(4, 3) ||
+        (hasGLExtension("GL_ARB_compute_shader") && hasGLExtension("GL_ARB_shader_storage_buffer_object")))
+    {
+        glext.DispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+        glext.MemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+        glext.computeShader = glext.DispatchCompute && glext.MemoryBarrier;
+    }
+    // ------------------------------------
+
+    // parallel shader compile: the KHR and ARB versions share enums, only the function name differs
+    // ------------------------------------
+    if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+    {
+        glext.MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+        glext.parallelShaderCompile = true;
+    }
+    else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+    {
+        glext.MaxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+        glext.parallelShaderCompile = true;
+    }
+    // ------------------------------------
+
+    // debug output: core in 4.3, otherwise KHR_debug, which uses the same unsuffixed names in a core context
+    // ------------------------------------
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    glext.debugContext = (flags & GL_CONTEXT_FLAG_DEBUG_BIT) != 0;
+    if (glVersionAtLeast(4, 3) || hasGLExtension("GL_KHR_debug"))
+    {
+        glext.DebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)load("glDebugMessageCallback");
+        glext.DebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)load("glDebugMessageControl");
+        glext.ObjectLabel = (PFNGLOBJECTLABELPROC)load("glObjectLabel");
+        glext.PushDebugGroup = (PFNGLPUSHDEBUGGROUPPROC)load("glPushDebugGroup");
+        glext.PopDebugGroup = (PFNGLPOPDEBUGGROUPPROC)load("glPopDebugGroup");
+        glext.debug = glext.DebugMessageCallback && glext.DebugMessageControl && glext.ObjectLabel &&
+            glext.PushDebugGroup && glext.PopDebugGroup;
+    }
+    // ------------------------------------
+
+    // immutable textures: core in 4.2, otherwise ARB_texture_storage. Only the array form is needed.
+    // ------------------------------------
+    if (glVersionAtLeast(4, 2) || hasGLExtension("GL_ARB_texture_storage"))
+    {
+        glext.TexStorage3D = (PFNGLTEXSTORAGE3DPROC)load("glTexStorage3D");
+        glext.textureStorage = glext.TexStorage3D != NULL;
+    }
+    // ------------------------------------
+
+    // compressed texture formats: no entry points, only the driver's word that it decodes them
+    // ------------------------------------
+    glext.textureS3tc = hasGLExtension("GL_EXT_texture_compression_s3tc");
+    glext.textureS3tcSrgb = glext.textureS3tc &&
+        (hasGLExtension("GL_EXT_texture_sRGB") || hasGLExtension("GL_EXT_texture_compression_s3tc_srgb"));
+    glext.textureBptc = glVersionAtLeast(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+    glext.textureEtc2 = glVersionAtLeast(4, 3) || hasGLExtension("GL_ARB_ES3_compatibility");
+    glext.textureAstc = hasGLExtension("GL_KHR_texture_compression_astc_ldr");
+    // ------------------------------------
+}
@@ -0,0 +1,140 @@
+#include "GLLoader.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace
+{
+    GLADloadproc loader = NULL;
+    std::mutex lookupMutex; //lookups from several contexts' threads, and the counters below
+    int resolved = 0;
+    double resolveMs = 0.0;
+
+    void* countedLookup(const char* name)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        void* proc = loader(name);
+        resolveMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        resolved++;
+        return proc;
+    }
+
+    // lazy stubs
+    // ------------------------------------
+    enum LazyIndex
+    {
+#define GL_FUNCTION(name) LAZY_##name,
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+        LAZY_FUNCTION_COUNT
+    };
+
+    struct LazyFunction
+    {
+        const char* name;
+        void* slot; //&glad_glXxx
+        void* stub; //what *slot holds until the first call
+    };
+
+    void* resolveLazy(int index);
+
+    //One stub per entry point: the signature comes from glad's pointer type, the entry from index.
+    template <typename Proc>
+    struct LazyStub;
+
+    template <typename R, typename... Args>
+    struct LazyStub<R (APIENTRY*)(Args...)>
+    {
+        typedef R (APIENTRY* Proc)(Args...);
+
+        template <int index>
+        static R APIENTRY call(Args... args)
+        {
+            return ((Proc)resolveLazy(index))(args...);
+        }
+    };
+
+    const LazyFunction lazyFunctions[LAZY_FUNCTION_COUNT] =
+    {
+#define GL_FUNCTION(name) { #name, &glad_##name, (void*)&LazyStub<decltype(glad_##name)>::call<LAZY_##name> },
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+    };
+
+    void* resolveLazy(int index)
+    {
+        const LazyFunction& function = lazyFunctions[index];
+        std::lock_guard<std::mutex> lock(lookupMutex);
+        void* proc;
+        memcpy(&proc, function.slot, sizeof(proc));
+        if (proc != function.stub)
+            return proc; //another thread was first
+        proc = countedLookup(function.name);
+        if (!proc)
+        {
+            //glad would leave the pointer NULL and crash on the call; at least say which one
+            std::cout << "ERROR::GL_LOADER::MISSING_FUNCTION " << function.name << std::endl;
+            abort();
+        }
+        memcpy(function.slot, &proc, sizeof(proc));
+        return proc;
+    }
+    // ------------------------------------
+}
+
+bool loadGLFunctions(GLADloadproc load, bool lazy)
+{
+    loader = load;
+    if (!lazy)
+        return gladLoadGLLoader(countedLookup) != 0; //one thread, no lock needed
+
+    for (int i = 0; i < LAZY_FUNCTION_COUNT; i++)
+        memcpy(lazyFunctions[i].slot, &lazyFunctions[i].stub, sizeof(void*));
+
+    //what gladLoadGLLoader() would have found, from the two calls every context needs anyway
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    GLVersion.major = major;
+    GLVersion.minor = minor;
+    int version = major * 10 + minor;
+    GLAD_GL_VERSION_1_0 = version >= 10;
+    GLAD_GL_VERSION_1_1 = version >= 11;
+    GLAD_GL_VERSION_1_2 = version >= 12;
+    GLAD_GL_VERSION_1_3 = version >= 13;
+    GLAD_GL_VERSION_1_4 = version >= 14;
+    GLAD_GL_VERSION_1_5 = version >= 15;
+    GLAD_GL_VERSION_2_0 = version >= 20;
+    GLAD_GL_VERSION_2_1 = version >= 21;
+    GLAD_GL_VERSION_3_0 = version >= 30;
+    GLAD_GL_VERSION_3_1 = version >= 31;
+    GLAD_GL_VERSION_3_2 = version >= 32;
+    GLAD_GL_VERSION_3_3 = version >= 33;
+    return major != 0;
+}
+
+void* lookupGLFunction(const char* name)
+{
+    std::lock_guard<std::mutex> lock(lookupMutex);
+    return countedLookup(name);
+}
+
+int glFunctionCount()
+{
+    return LAZY_FUNCTION_COUNT;
+}
+
+int glResolvedCount()
+{
+    std::lock_guard<std::mutex> lock(lookupMutex);
+    return resolved;
+}
+
+double glResolveMs()
+{
+    std::lock_guard<std::mutex> lock(lookupMutex);
+    return resolveMs;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glad/glad.h>
+
+//GL FUNCTION LOADING
+//***********************************************************
+/*
+  gladLoadGLLoader() looks up every entry point of GL 3.3 core through the platform's GetProcAddress as soon as the
+  context exists, close to 400 lookups of which this program calls maybe a quarter. Most drivers answer each one from a
+  hash table, but some walk long string tables or go through layers (overlays, capture tools, debug runtimes), and
+  then the lookups show up in the launch time.
+
+  The lazy mode (--lazy-gl) resolves nothing up front. Every one of glad's pointers is set to a small stub generated
+  for its signature (GLFunctions.h lists them); the first call through it looks the real function up, writes it into
+  glad's pointer and forwards the call, so from the second call on there is no difference to the eager load. Only the
+  entry points that are actually used are ever looked up.
+
+  The stubs are shared by every context (glad's pointers are global, the same assumption the eager load makes). Two
+  threads can hit the same stub at once, the lookup itself takes a lock; a thread that still reads the old pointer
+  just goes through the stub again and finds the function resolved.
+
+  Both modes count the lookups and the time spent in them, for the startup report (StartupTimer.h).
+*/
+
+//Fills glad's function pointers, through load now (lazy == false, same as gladLoadGLLoader) or on first use. Sets
+//GLVersion either way. Returns false if no GL context is current.
+bool loadGLFunctions(GLADloadproc load, bool lazy);
+
+//load as given to loadGLFunctions(), counted and timed like the lookups glad makes. For loadGLExtensions().
+void* lookupGLFunction(const char* name);
+
+//How many entry points glad knows, how many were looked up so far, and how long the lookups took in total.
+int glFunctionCount();
+int glResolvedCount();
+double glResolveMs();
@@ -0,0 +1,130 @@
+#include "GLObjects.h"
+#include "GLDebug.h"
+#include "GLExtensions.h"
+
+#include <iostream>
+
+const int GLObjects::CAPACITY;
+
+static thread_local GLObjects* currentObjects = NULL;
+
+GLObjects::GLObjects()
+    : unlabeled(0)
+{
+}
+
+void GLObjects::makeCurrent()
+{
+    currentObjects = this;
+}
+
+GLObjects& GLObjects::current()
+{
+    //same as GLStateCache: a thread without a registry gets its own, so callers never check for NULL
+    static thread_local GLObjects fallback;
+    return currentObjects ? *currentObjects : fallback;
+}
+
+bool GLObjects::add(Kind kind, GLuint name, const char* label)
+{
+    if (!name)
+        return false;
+    Record* record = records.acquire();
+    if (!record)
+    {
+        std::cout << "WARNING::GL_OBJECTS::POOL_FULL " << label << std::endl;
+        return false;
+    }
+    record->kind = kind;
+    record->name = name;
+    record->label = label;
+    record->labeled = false;
+    unlabeled++;
+    tryLabel(*record);
+    return true;
+}
+
+void GLObjects::remove(Kind kind, GLuint name)
+{
+    //only runs when objects are deleted, a linear walk over the pool is plenty
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (records.inUse(i) && records.at(i).kind == kind && records.at(i).name == name)
+        {
+            if (!records.at(i).labeled)
+                unlabeled--;
+            records.release(&records.at(i));
+            return;
+        }
+    }
+}
+
+void GLObjects::tryLabel(Record& record)
+{
+    if (!glext.debug)
+        return;
+    GLenum identifier;
+    bool exists;
+    switch (record.kind)
+    {
+    case KIND_BUFFER: identifier = GL_BUFFER; exists = glIsBuffer(record.name) != GL_FALSE; break;
+    case KIND_VERTEX_ARRAY: identifier = GL_VERTEX_ARRAY; exists = glIsVertexArray(record.name) != GL_FALSE; break;
+    case KIND_SHADER: identifier = GL_SHADER; exists = glIsShader(record.name) != GL_FALSE; break;
+    case KIND_PROGRAM: identifier = GL_PROGRAM; exists = glIsProgram(record.name) != GL_FALSE; break;
+    case KIND_TEXTURE: identifier = GL_TEXTURE; exists = glIsTexture(record.name) != GL_FALSE; break;
+    case KIND_FRAMEBUFFER: identifier = GL_FRAMEBUFFER; exists = glIsFramebuffer(record.name) != GL_FALSE; break;
+    default: return;
+    }
+    if (!exists)
+        return;
+    labelGLObject(identifier, record.name, record.label);
+    record.labeled = true;
+    unlabeled--;
+}
+
+void GLObjects::labelNew()
+{
+    if (unlabeled == 0 || !glext.debug)
+        return;
+    for (int i = 0; i < CAPACITY && unlabeled > 0; i++)
+    {
+        if (records.inUse(i) && !records.at(i).labeled)
+            tryLabel(records.at(i));
+    }
+}
+
+int GLObjects::liveCount(Kind kind) const
+{
+    int count = 0;
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (records.inUse(i) && records.at(i).kind == kind)
+            count++;
+    }
+    return count;
+}
+
+int GLObjects::reportLeaks() const
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        if (records.inUse(i))
+            std::cout << "WARNING::GL_OBJECTS::NOT_DELETED " << kindName(records.at(i).kind) << " " << records.at(i).name
+                << " (" << records.at(i).label << ")" << std::endl;
+    }
+    return records.liveCount();
+}
+
+const char* GLObjects::kindName(Kind kind)
+{
+    switch (kind)
+    {
+    case KIND_BUFFER: return "buffer";
+    case KIND_VERTEX_ARRAY: return "vertex_array";
+    case KIND_SHADER: return "shader";
+    case KIND_PROGRAM: return "program";
+    case KIND_TEXTURE: return "texture";
+    case KIND_FRAMEBUFFER: return "framebuffer";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Pool.h"
+
+//GL OBJECT REGISTRY
+//***********************************************************
+/*
+  Every long-lived buffer, vertex array, shader and program is recorded here when it is created and dropped again when
+  it is deleted. The records live in a fixed-size Pool, so creating and deleting objects at runtime never allocates, and
+  at shutdown anything still registered is a GL object somebody forgot to delete. The GLResource wrappers
+  (GLResource.h) register and unregister themselves.
+
+  Like GLStateCache there is one registry per context; GLObjects::current() returns the one made current on the calling
+  thread.
+
+  The labels double as debug labels (GLDebug.h) for capture tools. A name from glGen* only becomes an object when it is
+  first bound, and glObjectLabel refuses it until then, so records that couldn't be labeled yet are retried by
+  labelNew(), once per frame.
+*/
+
+class GLObjects
+{
+public:
+    enum Kind
+    {
+        KIND_BUFFER,
+        KIND_VERTEX_ARRAY,
+        KIND_SHADER,
+        KIND_PROGRAM,
+        KIND_TEXTURE,
+        KIND_FRAMEBUFFER,
+        KIND_COUNT
+    };
+
+    static const int CAPACITY = 256;
+
+    struct Record
+    {
+        Kind kind;
+        GLuint name;
+        const char* label; //string literal naming the owner, for the leak report
+        bool labeled;      //the GL object carries the label too
+    };
+
+    GLObjects();
+
+    void makeCurrent();
+    static GLObjects& current();
+
+    //add() returns false when the pool is full; the object still works, it just isn't tracked.
+    bool add(Kind kind, GLuint name, const char* label);
+    void remove(Kind kind, GLuint name);
+
+    //Gives the objects that weren't bound when they were registered their debug label, if they are objects by now.
+    //Cheap when everything is labeled already.
+    void labelNew();
+
+    int liveCount() const { return records.liveCount(); }
+    int liveCount(Kind kind) const;
+
+    //Prints one warning per object that is still registered. Returns how many there were.
+    int reportLeaks() const;
+
+    static const char* kindName(Kind kind);
+
+private:
+    void tryLabel(Record& record);
+
+    Pool<Record, CAPACITY> records;
+    int unlabeled; //records with labeled == false
+};
@@ -0,0 +1,82 @@
+#include "GLResource.h"
+#include "GLDeletionQueue.h"
+
+// GLHandle
+// ------------------------------------
+template <GLObjects::Kind KIND>
+bool GLHandle<KIND>::create(const char* label, GLenum shaderType)
+{
+    reset();
+    GLuint name = 0;
+    switch (KIND)
+    {
+    case GLObjects::KIND_BUFFER: glGenBuffers(1, &name); break;
+    case GLObjects::KIND_VERTEX_ARRAY: glGenVertexArrays(1, &name); break;
+    case GLObjects::KIND_SHADER: name = glCreateShader(shaderType); break;
+    case GLObjects::KIND_PROGRAM: name = glCreateProgram(); break;
+    case GLObjects::KIND_TEXTURE: glGenTextures(1, &name); break;
+    case GLObjects::KIND_FRAMEBUFFER: glGenFramebuffers(1, &name); break;
+    default: break;
+    }
+    adopt(name, label);
+    return object != 0;
+}
+
+template <GLObjects::Kind KIND>
+void GLHandle<KIND>::adopt(GLuint name, const char* label)
+{
+    reset();
+    object = name;
+    GLObjects::current().add(KIND, name, label);
+}
+
+template <GLObjects::Kind KIND>
+void GLHandle<KIND>::reset()
+{
+    //no GL here: the queue deletes it once the GPU is done, on the thread that owns the context
+    if (object)
+        GLDeletionQueue::current().enqueue(KIND, object);
+    object = 0;
+}
+
+//the only kinds there are; everything else links against these
+template class GLHandle<GLObjects::KIND_BUFFER>;
+template class GLHandle<GLObjects::KIND_VERTEX_ARRAY>;
+template class GLHandle<GLObjects::KIND_SHADER>;
+template class GLHandle<GLObjects::KIND_PROGRAM>;
+template class GLHandle<GLObjects::KIND_TEXTURE>;
+template class GLHandle<GLObjects::KIND_FRAMEBUFFER>;
+// ------------------------------------
+
+// GLFence
+// ------------------------------------
+void GLFence::insert()
+{
+    reset();
+    sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GLFence::reset()
+{
+    if (sync)
+        GLDeletionQueue::current().enqueue(sync);
+    sync = 0;
+}
+
+bool GLFence::signaled() const
+{
+    return !sync || glClientWaitSync(sync, 0, 0) != GL_TIMEOUT_EXPIRED;
+}
+
+bool GLFence::wait() const
+{
+    if (signaled())
+        return true;
+
+    //flush so the fence is guaranteed to reach the GPU, then wait in 1 ms steps
+    GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(sync, 0, 1000000);
+    return false;
+}
+// ------------------------------------
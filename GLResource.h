@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLObjects.h"
+
+//GL RESOURCE WRAPPERS
+//***********************************************************
+/*
+  A GLuint is just a number: copying it doesn't copy the object, and forgetting it (an early return, a failed init)
+  leaks the object for the lifetime of the context. These wrappers own exactly one object each:
+
+      GLBuffer, GLVertexArray, GLShader, GLProgram,
+      GLTexture, GLFramebuffer                         own a GLuint name
+      GLFence                                         owns a GLsync
+
+  They are move-only. Moving hands the object over and leaves the source empty, so there is always exactly one owner
+  and it is always clear who deletes what.
+
+  Deleting is deferred. The destructor (or reset()) doesn't call glDelete*; it hands the name to the context's
+  GLDeletionQueue, which deletes it once a fence says the GPU finished the frames that might still read it. That keeps
+  two rules of this code base: destructors never call GL (they may run without the context current), and dropping a
+  buffer the GPU is still drawing from never makes the driver wait for it or keep a hidden copy alive.
+
+  The wrappers never create objects by themselves either: create() does, explicitly, on the thread with the context.
+*/
+
+//Qualified by the kind of object it owns; the typedefs below are what the rest of the code uses.
+template <GLObjects::Kind KIND>
+class GLHandle
+{
+public:
+    GLHandle() : object(0) {}
+    ~GLHandle() { reset(); }
+
+    GLHandle(GLHandle&& other) noexcept : object(other.object) { other.object = 0; }
+    GLHandle& operator=(GLHandle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            object = other.object;
+            other.object = 0;
+        }
+        return *this;
+    }
+
+    //glGen*/glCreate* a new object (queueing the old one for deletion). label names the owner in the leak report.
+    //shaderType only matters for GLShader.
+    bool create(const char* label, GLenum shaderType = 0);
+
+    //Takes ownership of an object created elsewhere (a program restored from the shader cache, say).
+    void adopt(GLuint name, const char* label);
+
+    //Queues the object for deletion and leaves the handle empty.
+    void reset();
+
+    //Gives up ownership without deleting; the caller is responsible for the name now.
+    GLuint release()
+    {
+        GLuint name = object;
+        if (name)
+            GLObjects::current().remove(KIND, name);
+        object = 0;
+        return name;
+    }
+
+    GLuint get() const { return object; }
+    explicit operator bool() const { return object != 0; }
+
+private:
+    GLHandle(const GLHandle&);
+    GLHandle& operator=(const GLHandle&);
+
+    GLuint object;
+};
+
+typedef GLHandle<GLObjects::KIND_BUFFER> GLBuffer;
+typedef GLHandle<GLObjects::KIND_VERTEX_ARRAY> GLVertexArray;
+typedef GLHandle<GLObjects::KIND_SHADER> GLShader;
+typedef GLHandle<GLObjects::KIND_PROGRAM> GLProgram;
+typedef GLHandle<GLObjects::KIND_TEXTURE> GLTexture;
+typedef GLHandle<GLObjects::KIND_FRAMEBUFFER> GLFramebuffer;
+
+class GLFence
+{
+public:
+    GLFence() : sync(0) {}
+    ~GLFence() { reset(); }
+
+    GLFence(GLFence&& other) noexcept : sync(other.sync) { other.sync = 0; }
+    GLFence& operator=(GLFence&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            sync = other.sync;
+            other.sync = 0;
+        }
+        return *this;
+    }
+
+    //Puts a new fence behind every command issued so far.
+    void insert();
+    void reset();
+
+    //True once the GPU passed the fence (or there is none). Never blocks.
+    bool signaled() const;
+
+    //Blocks until the GPU passed the fence. Returns false if that took any waiting at all.
+    bool wait() const;
+
+    GLsync get() const { return sync; }
+    explicit operator bool() const { return sync != 0; }
+
+private:
+    GLFence(const GLFence&);
+    GLFence& operator=(const GLFence&);
+
+    GLsync sync;
+};
@@ -0,0 +1,244 @@
+#include "GLStateCache.h"
+
+#include <cstddef>
+
+//GL 4.3 targets missing from the 3.3 glad header
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_DISPATCH_INDIRECT_BUFFER
+#define GL_DISPATCH_INDIRECT_BUFFER 0x90EE
+#endif
+
+const GLuint GLStateCache::UNKNOWN;
+
+static const GLenum CAPABILITY_ENUMS[GLStateCache::CAP_COUNT] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST };
+
+static thread_local GLStateCache* currentCache = NULL;
+
+GLStateCache::GLStateCache()
+{
+    totals.issued = 0;
+    totals.skipped = 0;
+    frameStart = totals;
+    invalidate();
+}
+
+void GLStateCache::makeCurrent()
+{
+    currentCache = this;
+}
+
+GLStateCache& GLStateCache::current()
+{
+    //a thread that never called makeCurrent() gets a cache of its own, so callers never have to check for NULL
+    static thread_local GLStateCache fallback;
+    return currentCache ? *currentCache : fallback;
+}
+
+void GLStateCache::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    for (int i = 0; i < SLOT_COUNT; i++)
+        buffers[i] = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+    {
+        textures[i] = UNKNOWN;
+        textureTargets[i] = 0;
+    }
+    for (int i = 0; i < CAP_COUNT; i++)
+        capabilities[i] = -1;
+    blendSource = UNKNOWN;
+    blendDestination = UNKNOWN;
+    depthFunction = UNKNOWN;
+    depthWrite = -1;
+}
+
+bool GLStateCache::changed(bool same)
+{
+    if (same)
+    {
+        totals.skipped++;
+        return false;
+    }
+    totals.issued++;
+    return true;
+}
+
+int GLStateCache::bufferSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER: return SLOT_ARRAY;
+    case GL_ELEMENT_ARRAY_BUFFER: return SLOT_ELEMENT_ARRAY;
+    case GL_UNIFORM_BUFFER: return SLOT_UNIFORM;
+    case GL_PIXEL_PACK_BUFFER: return SLOT_PIXEL_PACK;
+    case GL_PIXEL_UNPACK_BUFFER: return SLOT_PIXEL_UNPACK;
+    case GL_COPY_READ_BUFFER: return SLOT_COPY_READ;
+    case GL_COPY_WRITE_BUFFER: return SLOT_COPY_WRITE;
+    case GL_DRAW_INDIRECT_BUFFER: return SLOT_DRAW_INDIRECT;
+    case GL_SHADER_STORAGE_BUFFER: return SLOT_SHADER_STORAGE;
+    case GL_DISPATCH_INDIRECT_BUFFER: return SLOT_DISPATCH_INDIRECT;
+    default: return SLOT_UNTRACKED;
+    }
+}
+
+void GLStateCache::useProgram(GLuint newProgram)
+{
+    if (!changed(program == newProgram))
+        return;
+    glUseProgram(newProgram);
+    program = newProgram;
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+    if (!changed(vertexArray == vao))
+        return;
+    glBindVertexArray(vao);
+    vertexArray = vao;
+    buffers[SLOT_ELEMENT_ARRAY] = UNKNOWN; //the element buffer binding is part of the VAO we just switched to
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = bufferSlot(target);
+    if (slot == SLOT_UNTRACKED)
+    {
+        totals.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (!changed(buffers[slot] == buffer))
+        return;
+    glBindBuffer(target, buffer);
+    buffers[slot] = buffer;
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    totals.issued++;
+    glBindBufferBase(target, index, buffer);
+    int slot = bufferSlot(target);
+    if (slot != SLOT_UNTRACKED)
+        buffers[slot] = buffer;
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    totals.issued++;
+    glBindBufferRange(target, index, buffer, offset, size);
+    int slot = bufferSlot(target);
+    if (slot != SLOT_UNTRACKED)
+        buffers[slot] = buffer;
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    if (unit >= (GLuint)MAX_TEXTURE_UNITS)
+    {
+        totals.issued += 2;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        activeUnit = unit;
+        return;
+    }
+    if (!changed(textures[unit] == texture && textureTargets[unit] == target))
+        return;
+    if (activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    glBindTexture(target, texture);
+    textures[unit] = texture;
+    textureTargets[unit] = target;
+}
+
+void GLStateCache::setEnabled(Capability capability, bool enabled)
+{
+    int state = enabled ? 1 : 0;
+    if (!changed(capabilities[capability] == state))
+        return;
+    if (enabled)
+        glEnable(CAPABILITY_ENUMS[capability]);
+    else
+        glDisable(CAPABILITY_ENUMS[capability]);
+    capabilities[capability] = state;
+}
+
+void GLStateCache::blendFunc(GLenum source, GLenum destination)
+{
+    if (!changed(blendSource == source && blendDestination == destination))
+        return;
+    glBlendFunc(source, destination);
+    blendSource = source;
+    blendDestination = destination;
+}
+
+void GLStateCache::depthFunc(GLenum func)
+{
+    if (!changed(depthFunction == func))
+        return;
+    glDepthFunc(func);
+    depthFunction = func;
+}
+
+void GLStateCache::depthMask(bool write)
+{
+    int state = write ? 1 : 0;
+    if (!changed(depthWrite == state))
+        return;
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+    depthWrite = state;
+}
+
+void GLStateCache::forgetBuffer(GLuint buffer)
+{
+    //glDeleteBuffers resets every binding of the buffer to 0
+    for (int i = 0; i < SLOT_COUNT; i++)
+        if (buffers[i] == buffer)
+            buffers[i] = 0;
+}
+
+void GLStateCache::forgetProgram(GLuint deleted)
+{
+    //a deleted program stays in use until another is bound, so the binding is simply unknown now
+    if (program == deleted)
+        program = UNKNOWN;
+}
+
+void GLStateCache::forgetVertexArray(GLuint vao)
+{
+    if (vertexArray == vao)
+    {
+        vertexArray = 0;
+        buffers[SLOT_ELEMENT_ARRAY] = UNKNOWN;
+    }
+}
+
+void GLStateCache::forgetTexture(GLuint texture)
+{
+    //like buffers, glDeleteTextures unbinds the texture from every unit
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+        if (textures[i] == texture)
+            textures[i] = 0;
+}
+
+GLStateCache::Counters GLStateCache::frameCounters() const
+{
+    Counters frame;
+    frame.issued = totals.issued - frameStart.issued;
+    frame.skipped = totals.skipped - frameStart.skipped;
+    return frame;
+}
+
+void GLStateCache::resetFrameCounters()
+{
+    frameStart = totals;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/glad.h>
+
+//GL STATE CACHE
+//***********************************************************
+/*
+  OpenGL is a state machine (see the notes at the top of Source.cpp), and every bind goes through the driver even when it
+  sets the state to what it already is. The driver has to validate each call, so redundant glUseProgram/glBindVertexArray
+  calls cost CPU time that grows with the number of objects we draw.
+
+  GLStateCache remembers what it last set and skips the GL call when nothing would change. It only knows about binds made
+  through it, so code that binds something behind its back (or deletes a bound object) must call invalidate().
+
+  Each GL context has its own state, so there is one cache per context. GLStateCache::current() returns the cache of the
+  context that is current on the calling thread, set with makeCurrent().
+
+  Some state is stored inside other objects: the GL_ELEMENT_ARRAY_BUFFER binding belongs to the bound VAO, so changing
+  the VAO forgets it.
+*/
+
+class GLStateCache
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 16;
+
+    //cached capabilities for enable()/disable()
+    enum Capability
+    {
+        CAP_BLEND,
+        CAP_DEPTH_TEST,
+        CAP_CULL_FACE,
+        CAP_SCISSOR_TEST,
+        CAP_COUNT
+    };
+
+    struct Counters
+    {
+        unsigned long long issued;  //calls that reached the driver
+        unsigned long long skipped; //calls avoided because the state was already set
+    };
+
+    GLStateCache();
+
+    //make this the cache used by GLStateCache::current() on this thread
+    void makeCurrent();
+    static GLStateCache& current();
+
+    //Forget everything. The next request for each piece of state always reaches GL.
+    void invalidate();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    //Indexed bindings (uniform/shader storage blocks) aren't cached, but they also change the generic binding of target,
+    //which these keep track of.
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    void setEnabled(Capability capability, bool enabled);
+    void enable(Capability capability) { setEnabled(capability, true); }
+    void disable(Capability capability) { setEnabled(capability, false); }
+    void blendFunc(GLenum source, GLenum destination);
+    void depthFunc(GLenum func);
+    void depthMask(bool write);
+
+    //tell the cache an object was deleted, so a new object reusing the name isn't mistaken for the bound one
+    void forgetBuffer(GLuint buffer);
+    void forgetProgram(GLuint program);
+    void forgetVertexArray(GLuint vao);
+    void forgetTexture(GLuint texture);
+
+    GLuint boundProgram() const { return program; }
+    GLuint boundVertexArray() const { return vertexArray; }
+
+    const Counters& counters() const { return totals; }
+    //counters since the last call to resetFrameCounters(), meant for per-frame reporting
+    Counters frameCounters() const;
+    void resetFrameCounters();
+
+private:
+    //buffer targets we track, see bufferSlot()
+    enum BufferSlot
+    {
+        SLOT_ARRAY,
+        SLOT_ELEMENT_ARRAY,
+        SLOT_UNIFORM,
+        SLOT_PIXEL_PACK,
+        SLOT_PIXEL_UNPACK,
+        SLOT_COPY_READ,
+        SLOT_COPY_WRITE,
+        SLOT_DRAW_INDIRECT,
+        SLOT_SHADER_STORAGE,
+        SLOT_DISPATCH_INDIRECT,
+        SLOT_COUNT,
+        SLOT_UNTRACKED = -1
+    };
+
+    static int bufferSlot(GLenum target);
+    bool changed(bool same);
+
+    //UNKNOWN marks state we don't know, so the next request always goes through
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    GLuint program;
+    GLuint vertexArray;
+    GLuint buffers[SLOT_COUNT];
+    GLuint activeUnit;
+    GLuint textures[MAX_TEXTURE_UNITS];
+    GLenum textureTargets[MAX_TEXTURE_UNITS];
+    int capabilities[CAP_COUNT]; //-1 unknown, 0 disabled, 1 enabled
+    GLenum blendSource;
+    GLenum blendDestination;
+    GLenum depthFunction;
+    int depthWrite;
+
+    Counters totals;
+    Counters frameStart;
+};
@@ -0,0 +1,176 @@
+#include "GpuCuller.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "IndirectDrawBatch.h"
+#include "InstancedBatch.h"
+#include "Shader.h"
+
+const int GpuCuller::MAX_COMMANDS;
+const int GpuCuller::GROUP_SIZE;
+
+//Culling compute shader. Instance and Command mirror InstanceData and DrawElementsIndirectCommand; std430 packs them
+//exactly like the C++ structs (32 and 20 bytes).
+//----------------------------------------
+static const char* cullComputeSource = "#version 430 core\n"
+"layout (local_size_x = 256) in;\n"
+"struct Instance { vec4 transform; vec4 color; };\n"
+"struct Command { uint count; uint instanceCount; uint firstIndex; int baseVertex; uint baseInstance; };\n"
+"layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };\n"
+"layout (std430, binding = 1) writeonly buffer Visible { Instance visible[]; };\n"
+"layout (std430, binding = 2) buffer Commands { Command commands[]; };\n"
+"uniform uint uInstanceOffset;\n" //instance 0 of the batch inside Instances
+"uniform uint uTotal;\n"          //instances to test, over all commands
+"uniform int uCommandCount;\n"
+"uniform uint uRangeEnd[64];\n"   //thread index where each command's instances end
+"uniform uint uSourceFirst[64];\n" //first instance each command draws
+"uniform vec4 uPlanes[4];\n"
+"uniform float uRadius;\n"
+"void main()\n"
+"{\n"
+"   uint i = gl_GlobalInvocationID.x;\n"
+"   if (i >= uTotal) return;\n"
+"   int c = 0;\n"
+"   while (c < uCommandCount - 1 && i >= uRangeEnd[c]) c++;\n"
+"   uint rangeBegin = c == 0 ? 0u : uRangeEnd[c - 1];\n"
+"   Instance instance = instances[uInstanceOffset + uSourceFirst[c] + (i - rangeBegin)];\n"
+"   vec3 center = vec3(instance.transform.xy, 0.0);\n"
+"   float radius = uRadius * instance.transform.z;\n"
+"   for (int p = 0; p < 4; p++)\n"
+"       if (dot(uPlanes[p].xyz, center) + uPlanes[p].w < -radius) return;\n"
+"   uint slot = atomicAdd(commands[c].instanceCount, 1u);\n"
+"   visible[commands[c].baseInstance + slot] = instance;\n"
+"}\n\0";
+//----------------------------------------
+
+GpuCuller::GpuCuller()
+    : visibleCapacity(0), drawnThisFrame(false), instanceOffsetLocation(-1),
+      totalLocation(-1), commandCountLocation(-1), rangeEndLocation(-1), sourceFirstLocation(-1), planesLocation(-1),
+      radiusLocation(-1)
+{
+}
+
+bool GpuCuller::init()
+{
+    if (!glext.computeShader || !glext.multiDrawIndirect)
+        return false;
+
+    GLuint compiled = createComputeProgram(cullComputeSource);
+    if (!compiled)
+        return false;
+    program.adopt(compiled, "gpu culling");
+    instanceOffsetLocation = glGetUniformLocation(compiled, "uInstanceOffset");
+    totalLocation = glGetUniformLocation(compiled, "uTotal");
+    commandCountLocation = glGetUniformLocation(compiled, "uCommandCount");
+    rangeEndLocation = glGetUniformLocation(compiled, "uRangeEnd");
+    sourceFirstLocation = glGetUniformLocation(compiled, "uSourceFirst");
+    planesLocation = glGetUniformLocation(compiled, "uPlanes");
+    radiusLocation = glGetUniformLocation(compiled, "uRadius");
+
+    //each frame's commands are bound as a shader storage range, so regions must respect the binding alignment
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    size_t regionSize = MAX_COMMANDS * sizeof(DrawElementsIndirectCommand);
+    regionSize = (regionSize + alignment - 1) / alignment * alignment;
+    if (!commandStream.init(GL_DRAW_INDIRECT_BUFFER, regionSize))
+    {
+        shutdown();
+        return false;
+    }
+
+    visibleBuffer.create("gpu culling visible instances");
+    return glGetError() == GL_NO_ERROR;
+}
+
+void GpuCuller::shutdown()
+{
+    commandStream.shutdown();
+    visibleBuffer.reset();
+    program.reset();
+    visibleCapacity = 0;
+}
+
+void GpuCuller::reserveVisible(size_t instances)
+{
+    if (instances <= visibleCapacity)
+        return;
+
+    //grow only, like the instance VBO; written and read by the GPU only
+    visibleCapacity = instances;
+    GLStateCache::current().bindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer.get());
+    glBufferData(GL_SHADER_STORAGE_BUFFER, visibleCapacity * sizeof(InstanceData), NULL, GL_DYNAMIC_COPY);
+}
+
+void GpuCuller::cullAndDraw(const DrawCommand* commands, int count, const Frustum& frustum, float radius,
+    GLuint drawProgram, InstancedBatch& instances)
+{
+    if (count <= 0)
+        return;
+    if (count > MAX_COMMANDS)
+        count = MAX_COMMANDS;
+    GLStateCache& glState = GLStateCache::current();
+
+    // 1. reset the commands; every mesh gets its own range of the visible buffer, as big as all its instances
+    // ------------------------------------
+    GLuint rangeEnd[MAX_COMMANDS];
+    GLuint sourceFirst[MAX_COMMANDS];
+    GLuint total = 0;
+    DrawElementsIndirectCommand* out = (DrawElementsIndirectCommand*)commandStream.beginWrite();
+    for (int i = 0; i < count; i++)
+    {
+        const DrawCommand& command = commands[i];
+        if (out)
+        {
+            out[i].count = (GLuint)command.count;
+            out[i].instanceCount = 0; //counted up by the shader
+            out[i].firstIndex = (GLuint)command.first;
+            out[i].baseVertex = command.baseVertex;
+            out[i].baseInstance = total;
+        }
+        sourceFirst[i] = (GLuint)command.firstInstance;
+        total += (GLuint)command.instanceCount;
+        rangeEnd[i] = total;
+    }
+    commandStream.endWrite();
+    if (!out)
+        return;
+    reserveVisible(total);
+    // ------------------------------------
+
+    // 2. cull
+    // ------------------------------------
+    glState.useProgram(program.get());
+    glUniform1ui(instanceOffsetLocation, (GLuint)(commands[0].instanceBase / sizeof(InstanceData)));
+    glUniform1ui(totalLocation, total);
+    glUniform1i(commandCountLocation, count);
+    glUniform1uiv(rangeEndLocation, count, rangeEnd);
+    glUniform1uiv(sourceFirstLocation, count, sourceFirst);
+    glUniform4fv(planesLocation, Frustum::PLANE_COUNT, &frustum.planes[0][0]);
+    glUniform1f(radiusLocation, radius);
+
+    glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, commands[0].instanceBuffer);
+    glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer.get());
+    glState.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, commandStream.buffer(), commandStream.regionOffset(),
+        count * sizeof(DrawElementsIndirectCommand));
+    glext.DispatchCompute((total + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+    //the draw below reads the commands as indirect parameters and the visible instances as vertex attributes
+    glext.MemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    // ------------------------------------
+
+    // 3. draw everything that survived
+    // ------------------------------------
+    glState.useProgram(drawProgram);
+    glState.bindVertexArray(commands[0].vao);
+    instances.bindInstances(visibleBuffer.get(), 0, 0);
+    glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream.buffer());
+    glext.MultiDrawElementsIndirect(commands[0].mode, commands[0].indexType, (const void*)commandStream.regionOffset(), count, 0);
+    drawnThisFrame = true;
+    // ------------------------------------
+}
+
+void GpuCuller::endFrame()
+{
+    if (drawnThisFrame)
+        commandStream.endFrame();
+    drawnThisFrame = false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+#include "CommandList.h"
+#include "Frustum.h"
+#include "GLResource.h"
+#include "StreamBuffer.h"
+
+class InstancedBatch;
+
+//GPU FRUSTUM CULLING
+//***********************************************************
+/*
+  Testing a million bounding spheres against the frustum is a tight loop on the CPU, and then the survivors still have
+  to be uploaded again. A compute shader does it on the GPU with one invocation per instance, right where the instance
+  data already lives:
+
+  1. The CPU writes one DrawElementsIndirectCommand per mesh with instanceCount = 0 into the indirect buffer.
+  2. The compute shader reads every instance from the instance buffer (bound as a shader storage buffer), tests its
+     bounding sphere and, if it is visible, atomically increments its mesh' instanceCount. The old value is the
+     instance's slot; the instance is copied to that slot in the mesh' range of the visible instance buffer.
+  3. glMemoryBarrier makes the writes visible to the indirect fetch and the vertex attribute fetch, and one
+     glMultiDrawElementsIndirect draws the visible instances of every mesh, reading their attributes from the visible
+     buffer. The CPU never learns how many instances survived and never waits for it.
+
+  Needs compute shaders and multi-draw indirect, so GL 4.3. The atomics are plain atomicAdd on the shader storage copy
+  of the commands instead of atomic counter buffers: counter offsets must be compile time constants, one per mesh.
+*/
+
+class GpuCuller
+{
+public:
+    static const int MAX_COMMANDS = 64; //meshes per cull; --meshes is clamped to this
+    static const int GROUP_SIZE = 256;  //invocations per work group, matches local_size_x in the shader
+
+    GpuCuller();
+
+    //Compiles the compute shader and creates the buffers. False (and disabled) without GL 4.3 features.
+    bool init();
+    void shutdown();
+    bool enabled() const { return (bool)program; }
+
+    //Culls the instances of every command against frustum and draws the visible ones with drawProgram and vao in one
+    //glMultiDrawElementsIndirect. All commands must be instanced, indexed with indexType, and read their instances from
+    //the same buffer and base. radius is the bounding sphere radius of the meshes at instance scale 1.
+    void cullAndDraw(const DrawCommand* commands, int count, const Frustum& frustum, float radius, GLuint drawProgram,
+        InstancedBatch& instances);
+
+    //Fences this frame's commands. Call after the last cullAndDraw() of the frame.
+    void endFrame();
+
+private:
+    void reserveVisible(size_t instances);
+
+    GLProgram program;
+    GLBuffer visibleBuffer;
+    size_t visibleCapacity; //in instances
+    StreamBuffer commandStream;
+    bool drawnThisFrame;
+
+    GLint instanceOffsetLocation;
+    GLint totalLocation;
+    GLint commandCountLocation;
+    GLint rangeEndLocation;
+    GLint sourceFirstLocation;
+    GLint planesLocation;
+    GLint radiusLocation;
+};
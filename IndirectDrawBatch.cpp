@@ -0,0 +1,95 @@
+#include "IndirectDrawBatch.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "InstancedBatch.h"
+
+#include <cstring>
+
+const int IndirectDrawBatch::MAX_COMMANDS;
+
+IndirectDrawBatch::IndirectDrawBatch()
+    : useMultiDraw(false), uploaded(false), calls(0)
+{
+    commands.reserve(MAX_COMMANDS);
+}
+
+bool IndirectDrawBatch::init(bool forceLoop)
+{
+    useMultiDraw = glext.multiDrawIndirect && !forceLoop;
+    if (!useMultiDraw)
+        return true;
+
+    if (!stream.init(GL_DRAW_INDIRECT_BUFFER, MAX_COMMANDS * sizeof(DrawElementsIndirectCommand)))
+    {
+        stream.shutdown();
+        useMultiDraw = false; //still works, just through the loop
+    }
+    return true;
+}
+
+void IndirectDrawBatch::shutdown()
+{
+    stream.shutdown();
+    commands.clear();
+}
+
+void IndirectDrawBatch::begin()
+{
+    commands.clear();
+    uploaded = false;
+    calls = 0;
+}
+
+int IndirectDrawBatch::add(const DrawElementsIndirectCommand& command)
+{
+    if ((int)commands.size() >= MAX_COMMANDS)
+        return -1;
+    commands.push_back(command);
+    return (int)commands.size() - 1;
+}
+
+void IndirectDrawBatch::upload()
+{
+    if (!useMultiDraw || commands.empty())
+        return;
+
+    void* region = stream.beginWrite();
+    if (region)
+        memcpy(region, &commands[0], commands.size() * sizeof(DrawElementsIndirectCommand));
+    stream.endWrite();
+    uploaded = region != NULL;
+}
+
+void IndirectDrawBatch::draw(GLenum mode, GLenum indexType, int first, int count, InstancedBatch& instances,
+    GLuint instanceBuffer, GLintptr instanceBase)
+{
+    if (count <= 0)
+        return;
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+    if (uploaded)
+    {
+        //one call for the whole slice; baseInstance replaces the attribute re-pointing
+        instances.bindInstances(instanceBuffer, instanceBase, 0);
+        GLStateCache::current().bindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.buffer());
+        const void* offset = (const void*)(stream.regionOffset() + first * sizeof(DrawElementsIndirectCommand));
+        glext.MultiDrawElementsIndirect(mode, indexType, offset, count, 0);
+        calls++;
+        return;
+    }
+
+    for (int i = first; i < first + count; i++)
+    {
+        const DrawElementsIndirectCommand& command = commands[i];
+        instances.bindInstances(instanceBuffer, instanceBase, command.baseInstance);
+        glDrawElementsInstancedBaseVertex(mode, command.count, indexType, (const void*)(command.firstIndex * indexSize),
+            command.instanceCount, command.baseVertex);
+        calls++;
+    }
+}
+
+void IndirectDrawBatch::endFrame()
+{
+    if (uploaded)
+        stream.endFrame();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+#include "StreamBuffer.h"
+
+class InstancedBatch;
+
+//MULTI-DRAW INDIRECT
+//***********************************************************
+/*
+  With indirect drawing the parameters of a draw call don't come from the function arguments but from a buffer bound to
+  GL_DRAW_INDIRECT_BUFFER, one DrawElementsIndirectCommand per draw. glMultiDrawElementsIndirect then runs a whole array
+  of them in one call, so submitting 1 or 1000 meshes costs the CPU the same single call, as long as they share a VAO
+  (see MeshArena), a program and an index type.
+
+  The commands of a frame are written into a StreamBuffer like the instance data: add() collects them, upload() copies
+  them all into this frame's region, draw() submits a contiguous slice of them, endFrame() fences the region.
+
+  Without GL 4.3 (or ARB_multi_draw_indirect + ARB_base_instance) the same commands are looped on the CPU with
+  glDrawElementsInstancedBaseVertex. That path can't pass baseInstance, so it re-points the instance attributes before
+  each command instead, like the rest of the 3.3 code does.
+*/
+
+//Layout fixed by the GL spec, 20 bytes.
+struct DrawElementsIndirectCommand
+{
+    GLuint count;         //indices to draw
+    GLuint instanceCount;
+    GLuint firstIndex;    //in indices, not bytes
+    GLint baseVertex;
+    GLuint baseInstance;  //added to the instance index when fetching per-instance attributes
+};
+
+class IndirectDrawBatch
+{
+public:
+    static const int MAX_COMMANDS = 4096; //per frame
+
+    IndirectDrawBatch();
+
+    //forceLoop uses the CPU loop even when multi-draw indirect is available, to compare the two.
+    bool init(bool forceLoop = false);
+    void shutdown();
+
+    //Starts a new frame's command list.
+    void begin();
+
+    //Appends a command and returns its index, or -1 when the frame is full.
+    int add(const DrawElementsIndirectCommand& command);
+    int size() const { return (int)commands.size(); }
+
+    //Copies every command added this frame into the indirect buffer. Call once, after the last add() and before draw().
+    void upload();
+
+    //Draws commands [first, first + count) with the bound program and VAO. instances re-points the per-instance
+    //attributes (at buffer + base) for the baseInstance of each command on the looped path.
+    void draw(GLenum mode, GLenum indexType, int first, int count, InstancedBatch& instances, GLuint instanceBuffer,
+        GLintptr instanceBase);
+
+    //Fences this frame's commands. Call after the last draw().
+    void endFrame();
+
+    bool multiDraw() const { return useMultiDraw; }
+
+    //GL draw calls issued since begin()
+    int drawCalls() const { return calls; }
+
+private:
+    std::vector<DrawElementsIndirectCommand> commands;
+    StreamBuffer stream;
+    bool useMultiDraw;
+    bool uploaded;
+    int calls;
+};
@@ -0,0 +1,151 @@
+#include "InstanceStore.h"
+#include "Frustum.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+const size_t InstanceStore::ALIGNMENT;
+
+InstanceStore::InstanceStore()
+    : count(0), capacity(0), allocation(NULL)
+{
+    for (int f = 0; f < FIELD_COUNT; f++)
+        fields[f] = NULL;
+}
+
+InstanceStore::~InstanceStore()
+{
+    release();
+}
+
+void InstanceStore::release()
+{
+    free(allocation);
+    allocation = NULL;
+    for (int f = 0; f < FIELD_COUNT; f++)
+        fields[f] = NULL;
+    capacity = 0;
+}
+
+void InstanceStore::resize(int newCount)
+{
+    count = newCount;
+    if (newCount <= capacity)
+        return;
+
+    //one block, every field array on its own cache line; the padding stays zero so the masked lanes read sane values
+    release();
+    int floatsPerLine = (int)(ALIGNMENT / sizeof(float));
+    capacity = (newCount + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+    size_t bytes = (size_t)capacity * sizeof(float) * FIELD_COUNT;
+    allocation = malloc(bytes + ALIGNMENT);
+    uintptr_t aligned = ((uintptr_t)allocation + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1);
+    memset((void*)aligned, 0, bytes);
+    for (int f = 0; f < FIELD_COUNT; f++)
+        fields[f] = (float*)aligned + (size_t)capacity * f;
+}
+
+void InstanceStore::set(int index, const InstanceData& data, float spinRate)
+{
+    fields[FIELD_X][index] = data.transform[0];
+    fields[FIELD_Y][index] = data.transform[1];
+    fields[FIELD_SCALE][index] = data.transform[2];
+    fields[FIELD_ROTATION][index] = data.transform[3];
+    fields[FIELD_SPIN][index] = spinRate;
+    fields[FIELD_RED][index] = data.color[0];
+    fields[FIELD_GREEN][index] = data.color[1];
+    fields[FIELD_BLUE][index] = data.color[2];
+    fields[FIELD_ALPHA][index] = data.color[3];
+}
+
+int InstanceStore::scaleBound(int begin, int end, float limit) const
+{
+    const float* scale = fields[FIELD_SCALE];
+    return (int)(std::upper_bound(scale + begin, scale + end, limit) - scale);
+}
+
+// ------------------------------------
+//Both kernels are the same loop; CULL adds the sphere test and packs the survivors instead of writing in place.
+// ------------------------------------
+
+template <bool CULL>
+static int writeInstances(float* const* fields, InstanceData* out, int begin, int end, float time,
+    const Frustum* frustum, float meshRadius)
+{
+    using namespace simd;
+    enum { X, Y, SCALE, ROTATION, SPIN, RED, GREEN, BLUE, ALPHA };
+
+    float4 t = splat(time);
+    float4 radius = splat(meshRadius);
+    int written = 0;
+    for (int i = begin & ~3; i < end; i += 4)
+    {
+        //lanes outside [begin, end) belong to another worker's range, or to nobody
+        int lanes = 0xF;
+        if (i < begin)
+            lanes &= 0xF << (begin - i);
+        if (i + 4 > end)
+            lanes &= 0xF >> (i + 4 - end);
+
+        // 1. transform update: the rotation advances by spin rate * time
+        // ------------------------------------
+        float4 x = load(fields[X] + i);
+        float4 y = load(fields[Y] + i);
+        float4 scale = load(fields[SCALE] + i);
+        float4 rotation = madd(load(fields[SPIN] + i), t, load(fields[ROTATION] + i));
+        // ------------------------------------
+
+        // 2. frustum test against every plane, four spheres at a time; z is 0 in this 2D scene
+        // ------------------------------------
+        if (CULL)
+        {
+            float4 negativeRadius = negate(mul(scale, radius));
+            for (int p = 0; p < Frustum::PLANE_COUNT; p++)
+            {
+                const float* plane = frustum->planes[p];
+                float4 distance = madd(splat(plane[0]), x, madd(splat(plane[1]), y, splat(plane[3])));
+                lanes &= maskBits(greaterEqual(distance, negativeRadius));
+            }
+            if (!lanes)
+                continue;
+        }
+        // ------------------------------------
+
+        // 3. back to one InstanceData per instance: a 4x4 transpose turns the field vectors into instance rows
+        // ------------------------------------
+        float4 red = load(fields[RED] + i);
+        float4 green = load(fields[GREEN] + i);
+        float4 blue = load(fields[BLUE] + i);
+        float4 alpha = load(fields[ALPHA] + i);
+        transpose(x, y, scale, rotation);
+        transpose(red, green, blue, alpha);
+        float4 transforms[4] = { x, y, scale, rotation };
+        float4 colors[4] = { red, green, blue, alpha };
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (!(lanes & (1 << lane)))
+                continue;
+            InstanceData& instance = CULL ? out[begin + written] : out[i + lane];
+            store(instance.transform, transforms[lane]);
+            store(instance.color, colors[lane]);
+            written++;
+        }
+        // ------------------------------------
+    }
+    return written;
+}
+
+void InstanceStore::writeTransformed(InstanceData* out, int begin, int end, float time) const
+{
+    writeInstances<false>(fields, out, begin, end, time, NULL, 0.0f);
+}
+
+int InstanceStore::writeVisible(InstanceData* out, int begin, int end, float time, const Frustum& frustum,
+    float meshRadius) const
+{
+    return writeInstances<true>(fields, out, begin, end, time, &frustum, meshRadius);
+}
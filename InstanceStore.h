@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+
+struct Frustum;
+
+//What the instance VBO holds per instance, see InstancedBatch.h for the attribute locations.
+struct InstanceData
+{
+    float transform[4]; //x offset, y offset, scale, rotation
+    float color[4];
+};
+
+//STRUCTURE OF ARRAYS
+//***********************************************************
+/*
+  InstanceData is an array of structures: x, y, scale, rotation, r, g, b, a of one instance, then the next one. That is
+  what the vertex fetch wants, but it is the wrong way round for the CPU. A SIMD register holds four floats, and
+  filling one with the x of four instances from an AoS array needs four loads from four different places.
+
+  The store keeps every field in its own array instead (x[], y[], scale[]...), so the same field of four neighbouring
+  instances sits next to each other and one load fetches it. The kernels update and cull four instances per
+  instruction (see Simd.h), and only transpose back to InstanceData at the very end, writing straight into the mapped
+  instance region.
+
+  Every array starts on a 64-byte boundary (a cache line, and enough for any SIMD width) and is padded to a whole cache
+  line. The kernels start at the group of four that holds begin and run past end up to the next group; the lanes
+  outside [begin, end) are masked off, so there is no scalar loop for the leftovers.
+*/
+
+class InstanceStore
+{
+public:
+    static const size_t ALIGNMENT = 64;
+
+    InstanceStore();
+    ~InstanceStore();
+
+    //Keeps the arrays when shrinking; growing reallocates and drops the old contents.
+    void resize(int count);
+    int size() const { return count; }
+
+    //spinRate is in radians per second, added to the rotation by the kernels below.
+    void set(int index, const InstanceData& data, float spinRate);
+
+    //First instance in [begin, end) with a scale above limit (end if there is none). Binary search: the instances
+    //must be stored in ascending scale order, which is how InstancedBatch lays them out.
+    int scaleBound(int begin, int end, float limit) const;
+
+    //Writes instances [begin, end) at time to out[begin, end).
+    void writeTransformed(InstanceData* out, int begin, int end, float time) const;
+
+    //Writes the instances of [begin, end) whose bounding sphere (radius = scale * meshRadius) touches frustum to
+    //out[begin...], packed without gaps. Returns how many were written.
+    int writeVisible(InstanceData* out, int begin, int end, float time, const Frustum& frustum, float meshRadius) const;
+
+private:
+    enum Field
+    {
+        FIELD_X,
+        FIELD_Y,
+        FIELD_SCALE,
+        FIELD_ROTATION,
+        FIELD_SPIN,
+        FIELD_RED,
+        FIELD_GREEN,
+        FIELD_BLUE,
+        FIELD_ALPHA,
+        FIELD_COUNT
+    };
+
+    InstanceStore(const InstanceStore&);
+    InstanceStore& operator=(const InstanceStore&);
+
+    void release();
+
+    int count;
+    int capacity;      //per array, a multiple of 16 (one cache line of floats)
+    void* allocation;  //one block for all arrays, as returned by malloc
+    float* fields[FIELD_COUNT];
+};
@@ -0,0 +1,181 @@
+#include "InstancedBatch.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+const GLuint InstancedBatch::TRANSFORM_LOCATION;
+const GLuint InstancedBatch::COLOR_LOCATION;
+const int InstancedBatch::MAX_INSTANCES;
+
+InstancedBatch::InstancedBatch()
+    : vao(0), instanceCount(0), capacity(0), animate(false), streamForceMapRange(false)
+{
+    layout.add(TRANSFORM_LOCATION, 4, VertexFormat::TYPE_FLOAT, 1); //divisor 1: advance once per instance, not once per vertex
+    layout.add(COLOR_LOCATION, 4, VertexFormat::TYPE_FLOAT, 1);
+}
+
+bool InstancedBatch::init(GLuint meshVAO)
+{
+    vao = meshVAO;
+    instanceVBO.create("instances");
+
+    GLStateCache::current().bindVertexArray(vao);
+    layout.enableAttributes();
+    pointAttributes(instanceVBO.get(), 0);
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::current().bindVertexArray(0);
+
+    setCount(1);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void InstancedBatch::pointAttributes(GLuint buffer, size_t baseOffset)
+{
+    //the VAO records which buffer each attribute reads from, so binding the instance buffer while the VAO is bound is
+    //enough to attach it; the mesh VBO stays attached to location 0
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, buffer);
+    layout.pointAttributes(baseOffset);
+}
+
+void InstancedBatch::shutdown()
+{
+    stream.shutdown();
+    instanceVBO.reset();
+    instanceCount = 0;
+    capacity = 0;
+}
+
+void InstancedBatch::setCount(int count)
+{
+    count = std::max(1, std::min(count, MAX_INSTANCES));
+    fillGrid(count);
+
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, instanceVBO.get());
+    if (count > capacity)
+    {
+        //grow: allocate fresh storage, the data follows below
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+        capacity = count;
+    }
+    //the store transposes its arrays straight into the mapped VBO, there is no AoS copy on the CPU side
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped)
+    {
+        store.writeTransformed((InstanceData*)mapped, 0, count, 0.0f);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    instanceCount = count;
+    if (animate)
+        resizeStream();
+}
+
+void InstancedBatch::setAnimated(bool enabled, bool forceMapRange)
+{
+    animate = enabled;
+    streamForceMapRange = forceMapRange;
+    if (animate)
+    {
+        resizeStream();
+    }
+    else
+    {
+        stream.shutdown();
+        GLStateCache::current().bindVertexArray(vao);
+        pointAttributes(instanceVBO.get(), 0);
+        GLStateCache::current().bindVertexArray(0);
+    }
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedBatch::resizeStream()
+{
+    //one region holds a full frame of instances
+    size_t needed = instanceCount * sizeof(InstanceData);
+    if (stream.buffer() == 0 || stream.regionSize() < needed)
+        stream.init(GL_ARRAY_BUFFER, needed, streamForceMapRange);
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void* InstancedBatch::beginFrame()
+{
+    if (!animate)
+        return NULL;
+    void* region = stream.beginWrite();
+    GLStateCache::current().bindBuffer(GL_ARRAY_BUFFER, 0);
+    return region;
+}
+
+void InstancedBatch::endWrite()
+{
+    if (animate)
+        stream.endWrite();
+}
+
+void InstancedBatch::endFrame()
+{
+    if (animate)
+        stream.endFrame();
+}
+
+void InstancedBatch::writeInstances(InstanceData* out, int begin, int end, double time) const
+{
+    //write straight into the mapped region: no staging copy and no glBufferSubData
+    store.writeTransformed(out, begin, end, (float)time);
+}
+
+int InstancedBatch::writeVisibleInstances(InstanceData* out, int begin, int end, double time, const Frustum& frustum,
+    float meshRadius) const
+{
+    return store.writeVisible(out, begin, end, (float)time, frustum, meshRadius);
+}
+
+GLuint InstancedBatch::instanceBuffer() const
+{
+    return animate ? stream.buffer() : instanceVBO.get();
+}
+
+GLintptr InstancedBatch::instanceBase() const
+{
+    return animate ? (GLintptr)stream.regionOffset() : 0;
+}
+
+void InstancedBatch::bindInstances(GLuint buffer, GLintptr base, GLint firstInstance)
+{
+    pointAttributes(buffer, (size_t)base + firstInstance * sizeof(InstanceData));
+}
+
+void InstancedBatch::fillGrid(int count)
+{
+    //square-ish grid covering clip space, one cell per instance
+    int columns = (int)std::ceil(std::sqrt((double)count));
+    int rows = (count + columns - 1) / columns;
+    float cellWidth = 2.0f / columns;
+    float cellHeight = 2.0f / rows;
+    float scale = std::min(cellWidth, cellHeight);
+
+    store.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        int column = i % columns;
+        int row = i / columns;
+        InstanceData instance;
+        instance.transform[0] = -1.0f + (column + 0.5f) * cellWidth;
+        instance.transform[1] = -1.0f + (row + 0.5f) * cellHeight;
+        instance.transform[2] = scale;
+        instance.transform[3] = (i % 16) * (6.2831853f / 16.0f);
+
+        //cheap spread of hues so neighbouring instances are easy to tell apart
+        float t = (float)i / (float)count;
+        instance.color[0] = 0.5f + 0.5f * std::cos(6.2831853f * (t + 0.00f));
+        instance.color[1] = 0.5f + 0.5f * std::cos(6.2831853f * (t + 0.33f));
+        instance.color[2] = 0.5f + 0.5f * std::cos(6.2831853f * (t + 0.67f));
+        instance.color[3] = 1.0f;
+
+        //animated instances spin at one of three speeds
+        store.set(i, instance, 1.0f + (i % 3));
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+#include "GLResource.h"
+#include "InstanceStore.h"
+#include "StreamBuffer.h"
+#include "VertexFormat.h"
+
+//INSTANCED RENDERING
+//***********************************************************
+/*
+  Instead of issuing one glDrawArrays per copy of the mesh, glDrawArraysInstanced draws the same vertices instanceCount
+  times in a single call. Per-copy data comes from a second VBO whose attributes have a divisor set with
+  glVertexAttribDivisor: a divisor of 1 means "advance this attribute once per instance instead of once per vertex".
+
+  The instance VBO is attached to the same VAO as the mesh, so binding that VAO brings both the per-vertex and the
+  per-instance layout along. The vertex shader reads the extra attributes at these locations:
+      location 1: vec4 transform (x offset, y offset, scale, rotation in radians)
+      location 2: vec4 color
+
+  Animated batches rewrite every instance each frame. Their data goes through a StreamBuffer instead of the static VBO,
+  and the attribute pointers are moved to the region written this frame right before the draw. The CPU copy the frames
+  are written from is an InstanceStore, see InstanceStore.h.
+*/
+
+class InstancedBatch
+{
+public:
+    static const GLuint TRANSFORM_LOCATION = 1;
+    static const GLuint COLOR_LOCATION = 2;
+    static const int MAX_INSTANCES = 10000000;
+
+    InstancedBatch();
+
+    //Creates the instance VBO and adds its attributes to vao. The VAO must already hold the per-vertex layout.
+    bool init(GLuint vao);
+    void shutdown();
+
+    //Changes how many copies are drawn. The copies are laid out on a grid that fills the window and the data is
+    //re-uploaded; the VBO only grows, so shrinking and growing back doesn't reallocate.
+    void setCount(int count);
+    int count() const { return instanceCount; }
+
+    //Animated instances spin in place and are re-streamed every frame. forceMapRange skips persistent mapping even
+    //when the context supports it, to compare the two paths.
+    void setAnimated(bool enabled, bool forceMapRange = false);
+    bool animated() const { return animate; }
+    const StreamBuffer& streamBuffer() const { return stream; }
+
+    //Per-frame streaming, render thread only. beginFrame() returns this frame's mapped instance region when animated (NULL
+    //otherwise); after every writeInstances() call is done, endWrite() then the draws, then endFrame() to fence it.
+    void* beginFrame();
+    void endWrite();
+    void endFrame();
+
+    //Fills out[begin, end) with the animated instances at time. Touches no GL state, so several worker threads can each
+    //fill their own range of the mapped region at the same time.
+    void writeInstances(InstanceData* out, int begin, int end, double time) const;
+
+    //Same, but only writes the instances inside frustum, packed from out[begin] on. Returns how many. meshRadius is
+    //the bounding sphere of the drawn mesh at instance scale 1.
+    int writeVisibleInstances(InstanceData* out, int begin, int end, double time, const Frustum& frustum,
+        float meshRadius) const;
+
+    //First instance in [begin, end) drawn larger than scale, for picking levels of detail. The grid keeps the
+    //instances sorted by scale (they all have the same one), and anything that lays them out differently has to too.
+    int scaleBound(int begin, int end, float scale) const { return store.scaleBound(begin, end, scale); }
+
+    //Where this frame's instance data lives: the stream region when animated, the static VBO otherwise.
+    GLuint instanceBuffer() const;
+    GLintptr instanceBase() const;
+
+    //Points the instance attributes of the bound VAO at instance firstInstance of buffer. Stands in for the baseInstance
+    //parameter of glDrawArraysInstancedBaseInstance, which needs GL 4.2.
+    void bindInstances(GLuint buffer, GLintptr base, GLint firstInstance);
+
+private:
+    void fillGrid(int count);
+    void resizeStream();
+    void pointAttributes(GLuint buffer, size_t baseOffset);
+
+    GLuint vao;
+    GLBuffer instanceVBO;
+    int instanceCount;
+    int capacity;
+    InstanceStore store; //CPU copy of the instance data, reused between uploads
+    bool animate;
+    bool streamForceMapRange;
+    StreamBuffer stream;
+    VertexFormat layout; //per-instance attributes, matches InstanceData
+};
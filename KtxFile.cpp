@@ -0,0 +1,159 @@
+#include "KtxFile.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "GLExtensions.h"
+
+const int KtxFileView::MAX_LEVELS;
+
+//the header is read in place, so its layout is part of the format
+static_assert(sizeof(KtxHeader) == 80, "KtxHeader layout changed");
+static_assert(sizeof(KtxLevel) == 24, "KtxLevel layout changed");
+
+static const unsigned char IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+//the level index follows the header directly
+static const size_t LEVEL_INDEX_OFFSET = sizeof(KtxHeader);
+
+//VkFormat numbers from vulkan_core.h. The sRGB variant always follows the linear one.
+static const TextureFormat formats[] = {
+    { 37, GL_RGBA8, TextureFormat::FAMILY_UNCOMPRESSED, 1, 1, 4, "RGBA8" },
+    { 43, GL_SRGB8_ALPHA8, TextureFormat::FAMILY_UNCOMPRESSED, 1, 1, 4, "RGBA8 sRGB" },
+    { 131, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, TextureFormat::FAMILY_S3TC, 4, 4, 8, "BC1 RGB" },
+    { 132, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, TextureFormat::FAMILY_S3TC_SRGB, 4, 4, 8, "BC1 RGB sRGB" },
+    { 133, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, TextureFormat::FAMILY_S3TC, 4, 4, 8, "BC1 RGBA" },
+    { 134, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, TextureFormat::FAMILY_S3TC_SRGB, 4, 4, 8, "BC1 RGBA sRGB" },
+    { 135, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, TextureFormat::FAMILY_S3TC, 4, 4, 16, "BC2" },
+    { 136, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, TextureFormat::FAMILY_S3TC_SRGB, 4, 4, 16, "BC2 sRGB" },
+    { 137, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, TextureFormat::FAMILY_S3TC, 4, 4, 16, "BC3" },
+    { 138, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, TextureFormat::FAMILY_S3TC_SRGB, 4, 4, 16, "BC3 sRGB" },
+    { 139, GL_COMPRESSED_RED_RGTC1, TextureFormat::FAMILY_RGTC, 4, 4, 8, "BC4" },
+    { 140, GL_COMPRESSED_SIGNED_RED_RGTC1, TextureFormat::FAMILY_RGTC, 4, 4, 8, "BC4 signed" },
+    { 141, GL_COMPRESSED_RG_RGTC2, TextureFormat::FAMILY_RGTC, 4, 4, 16, "BC5" },
+    { 142, GL_COMPRESSED_SIGNED_RG_RGTC2, TextureFormat::FAMILY_RGTC, 4, 4, 16, "BC5 signed" },
+    { 143, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, TextureFormat::FAMILY_BPTC, 4, 4, 16, "BC6H" },
+    { 144, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, TextureFormat::FAMILY_BPTC, 4, 4, 16, "BC6H signed" },
+    { 145, GL_COMPRESSED_RGBA_BPTC_UNORM, TextureFormat::FAMILY_BPTC, 4, 4, 16, "BC7" },
+    { 146, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, TextureFormat::FAMILY_BPTC, 4, 4, 16, "BC7 sRGB" },
+    { 147, GL_COMPRESSED_RGB8_ETC2, TextureFormat::FAMILY_ETC2, 4, 4, 8, "ETC2 RGB" },
+    { 148, GL_COMPRESSED_SRGB8_ETC2, TextureFormat::FAMILY_ETC2, 4, 4, 8, "ETC2 RGB sRGB" },
+    { 149, GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, TextureFormat::FAMILY_ETC2, 4, 4, 8, "ETC2 RGB A1" },
+    { 150, GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, TextureFormat::FAMILY_ETC2, 4, 4, 8, "ETC2 RGB A1 sRGB" },
+    { 151, GL_COMPRESSED_RGBA8_ETC2_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 16, "ETC2 RGBA" },
+    { 152, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 16, "ETC2 RGBA sRGB" },
+    { 153, GL_COMPRESSED_R11_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 8, "EAC R11" },
+    { 154, GL_COMPRESSED_SIGNED_R11_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 8, "EAC R11 signed" },
+    { 155, GL_COMPRESSED_RG11_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 16, "EAC RG11" },
+    { 156, GL_COMPRESSED_SIGNED_RG11_EAC, TextureFormat::FAMILY_ETC2, 4, 4, 16, "EAC RG11 signed" },
+    //GL numbers the ASTC formats in the same block size order as Vulkan, linear and sRGB in two separate runs
+    { 157, GL_COMPRESSED_RGBA_ASTC_4x4_KHR, TextureFormat::FAMILY_ASTC, 4, 4, 16, "ASTC 4x4" },
+    { 158, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR, TextureFormat::FAMILY_ASTC, 4, 4, 16, "ASTC 4x4 sRGB" },
+    { 159, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 1, TextureFormat::FAMILY_ASTC, 5, 4, 16, "ASTC 5x4" },
+    { 160, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 1, TextureFormat::FAMILY_ASTC, 5, 4, 16, "ASTC 5x4 sRGB" },
+    { 161, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 2, TextureFormat::FAMILY_ASTC, 5, 5, 16, "ASTC 5x5" },
+    { 162, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 2, TextureFormat::FAMILY_ASTC, 5, 5, 16, "ASTC 5x5 sRGB" },
+    { 163, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 3, TextureFormat::FAMILY_ASTC, 6, 5, 16, "ASTC 6x5" },
+    { 164, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 3, TextureFormat::FAMILY_ASTC, 6, 5, 16, "ASTC 6x5 sRGB" },
+    { 165, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 4, TextureFormat::FAMILY_ASTC, 6, 6, 16, "ASTC 6x6" },
+    { 166, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 4, TextureFormat::FAMILY_ASTC, 6, 6, 16, "ASTC 6x6 sRGB" },
+    { 167, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 5, TextureFormat::FAMILY_ASTC, 8, 5, 16, "ASTC 8x5" },
+    { 168, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 5, TextureFormat::FAMILY_ASTC, 8, 5, 16, "ASTC 8x5 sRGB" },
+    { 169, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 6, TextureFormat::FAMILY_ASTC, 8, 6, 16, "ASTC 8x6" },
+    { 170, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 6, TextureFormat::FAMILY_ASTC, 8, 6, 16, "ASTC 8x6 sRGB" },
+    { 171, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 7, TextureFormat::FAMILY_ASTC, 8, 8, 16, "ASTC 8x8" },
+    { 172, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 7, TextureFormat::FAMILY_ASTC, 8, 8, 16, "ASTC 8x8 sRGB" },
+    { 173, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 8, TextureFormat::FAMILY_ASTC, 10, 5, 16, "ASTC 10x5" },
+    { 174, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 8, TextureFormat::FAMILY_ASTC, 10, 5, 16, "ASTC 10x5 sRGB" },
+    { 175, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 9, TextureFormat::FAMILY_ASTC, 10, 6, 16, "ASTC 10x6" },
+    { 176, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 9, TextureFormat::FAMILY_ASTC, 10, 6, 16, "ASTC 10x6 sRGB" },
+    { 177, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 10, TextureFormat::FAMILY_ASTC, 10, 8, 16, "ASTC 10x8" },
+    { 178, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 10, TextureFormat::FAMILY_ASTC, 10, 8, 16, "ASTC 10x8 sRGB" },
+    { 179, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 11, TextureFormat::FAMILY_ASTC, 10, 10, 16, "ASTC 10x10" },
+    { 180, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 11, TextureFormat::FAMILY_ASTC, 10, 10, 16, "ASTC 10x10 sRGB" },
+    { 181, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 12, TextureFormat::FAMILY_ASTC, 12, 10, 16, "ASTC 12x10" },
+    { 182, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 12, TextureFormat::FAMILY_ASTC, 12, 10, 16, "ASTC 12x10 sRGB" },
+    { 183, GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 13, TextureFormat::FAMILY_ASTC, 12, 12, 16, "ASTC 12x12" },
+    { 184, GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 13, TextureFormat::FAMILY_ASTC, 12, 12, 16, "ASTC 12x12 sRGB" }
+};
+
+const TextureFormat* TextureFormat::find(uint32_t vkFormat)
+{
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        if (formats[i].vkFormat == vkFormat)
+            return &formats[i];
+    }
+    return NULL;
+}
+
+KtxFileView::KtxFileView()
+    : bytes(NULL), levelIndex(NULL), textureFormat(NULL), pixelWidth(0), pixelHeight(0), levels(0)
+{
+}
+
+bool KtxFileView::identify(const char* data, size_t size)
+{
+    return size >= sizeof(IDENTIFIER) && memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+}
+
+bool KtxFileView::parse(const char* data, size_t size)
+{
+    if (!identify(data, size) || size < LEVEL_INDEX_OFFSET)
+    {
+        std::cout << "ERROR::KTX::NOT_A_KTX2_FILE" << std::endl;
+        return false;
+    }
+    const KtxHeader* h = (const KtxHeader*)data;
+    if (h->supercompressionScheme != 0)
+    {
+        std::cout << "ERROR::KTX::SUPERCOMPRESSED scheme " << h->supercompressionScheme << std::endl;
+        return false;
+    }
+    if (h->pixelWidth == 0 || h->pixelHeight == 0 || h->pixelDepth > 1 || h->layerCount > 1 || h->faceCount != 1)
+    {
+        std::cout << "ERROR::KTX::NOT_A_2D_TEXTURE " << h->pixelWidth << "x" << h->pixelHeight << "x" << h->pixelDepth
+            << ", " << h->layerCount << " layers, " << h->faceCount << " faces" << std::endl;
+        return false;
+    }
+    const TextureFormat* format = TextureFormat::find(h->vkFormat);
+    if (!format)
+    {
+        std::cout << "ERROR::KTX::UNKNOWN_FORMAT vkFormat " << h->vkFormat << std::endl;
+        return false;
+    }
+
+    //levelCount 0 asks the loader to generate the mips, which compressed data can't; it is just the one level then
+    int count = h->levelCount > 0 ? (int)h->levelCount : 1;
+    int fullChain = 1;
+    while ((h->pixelWidth >> fullChain) > 0 || (h->pixelHeight >> fullChain) > 0)
+        fullChain++;
+    if (count > fullChain || count > MAX_LEVELS || (size - LEVEL_INDEX_OFFSET) / sizeof(KtxLevel) < (size_t)count)
+    {
+        std::cout << "ERROR::KTX::CORRUPT_HEADER " << h->levelCount << " levels" << std::endl;
+        return false;
+    }
+
+    const KtxLevel* index = (const KtxLevel*)(data + LEVEL_INDEX_OFFSET);
+    for (int level = 0; level < count; level++)
+    {
+        uint32_t w = h->pixelWidth >> level;
+        uint32_t ht = h->pixelHeight >> level;
+        size_t expected = format->levelBytes(w > 0 ? (int)w : 1, ht > 0 ? (int)ht : 1);
+        if (index[level].byteOffset > size || index[level].byteLength > size - index[level].byteOffset ||
+            index[level].byteLength != expected)
+        {
+            std::cout << "ERROR::KTX::LEVEL_OUT_OF_RANGE " << level << " (" << index[level].byteLength << " bytes, "
+                << format->name << " needs " << expected << ")" << std::endl;
+            return false;
+        }
+    }
+
+    bytes = data;
+    levelIndex = index;
+    pixelWidth = (int)h->pixelWidth;
+    pixelHeight = (int)h->pixelHeight;
+    textureFormat = format;
+    levels = count;
+    return true;
+}
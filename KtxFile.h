@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+//KTX2 TEXTURE FILES
+//***********************************************************
+/*
+  A PNG or JPEG has to be decoded into plain RGBA before GL can take it: four bytes per texel in video memory and over
+  the bus, and the decode itself on every start. GPUs sample block-compressed formats directly instead, a fixed number
+  of bytes per 4x4 (or larger, for ASTC) block of texels:
+      BC1 / ETC2 RGB             8 bytes per 4x4 block, 4 bits per texel, opaque color
+      BC3 / BC7 / ETC2 RGBA      16 bytes per 4x4 block, 8 bits per texel, with alpha
+      BC4 / BC5 / EAC            one or two channels (masks, normal maps)
+      ASTC 4x4 ... 12x12         16 bytes per block of any of those sizes, 8 down to 0.89 bits per texel
+  Desktop GPUs decode BC, phones decode ETC2 and ASTC, so which one a file holds depends on where it is meant to run.
+
+  KTX2 (Khronos) is the container: a header with the Vulkan format number and the size, then every mip level already
+  compressed, each at an offset the level index gives. Like a .mesh file (MeshFile.h) it is read in place from a
+  mapping: the level bytes go to the GPU exactly as they are in the file.
+
+  Layout, little-endian, offsets from the start of the file:
+      KtxHeader             identifier "«KTX 20»\r\n\x1A\n", vkFormat, size, layer/face/level counts,
+                            supercompression, where the other sections are
+      KtxLevel[levelCount]  offset and length of every mip level, level 0 (the full size) first
+      data format descriptor, key/value data, and the level data, usually the smallest level first
+  Only what a 2D texture needs is accepted: one layer, one face, no depth, and no supercompression (Basis Universal
+  files would have to be transcoded on the CPU first, zstd ones inflated, which is a different loader).
+*/
+
+//A GL internal format as a KTX2 file names it, and how big its blocks are. Uncompressed formats have 1x1 blocks.
+struct TextureFormat
+{
+    enum Family
+    {
+        FAMILY_UNCOMPRESSED,
+        FAMILY_S3TC,      //BC1-3
+        FAMILY_S3TC_SRGB,
+        FAMILY_RGTC,      //BC4, BC5
+        FAMILY_BPTC,      //BC6H, BC7
+        FAMILY_ETC2,      //ETC2 and EAC
+        FAMILY_ASTC
+    };
+
+    uint32_t vkFormat;
+    GLenum internalFormat;
+    Family family;
+    int blockWidth;
+    int blockHeight;
+    int blockBytes;
+    const char* name;
+
+    bool compressed() const { return family != FAMILY_UNCOMPRESSED; }
+
+    //bytes of a level of width x height texels, partial blocks at the edges count as whole ones
+    size_t levelBytes(int width, int height) const
+    {
+        size_t blocksX = (size_t)(width + blockWidth - 1) / blockWidth;
+        size_t blocksY = (size_t)(height + blockHeight - 1) / blockHeight;
+        return blocksX * blocksY * blockBytes;
+    }
+
+    //The format with vkFormat, or NULL if this program doesn't know it.
+    static const TextureFormat* find(uint32_t vkFormat);
+};
+
+//The identifier is part of it, so the 64-bit offsets below fall on 8-byte boundaries the way the file has them.
+struct KtxHeader
+{
+    unsigned char identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct KtxLevel
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+//Reads a .ktx2 file in place, like MeshFileView: the bytes passed to parse() have to stay mapped while the level data
+//is read. The size, format and level count are copied out, so they outlive the mapping.
+class KtxFileView
+{
+public:
+    static const int MAX_LEVELS = 16; //a 32768 texel wide texture
+
+    KtxFileView();
+
+    //Whether data starts with the KTX2 identifier.
+    static bool identify(const char* data, size_t size);
+
+    //Checks the header, the format and that every level lies inside the file with the size its format gives it.
+    //Returns false (and prints why) if anything is off or the file isn't a plain 2D texture.
+    bool parse(const char* data, size_t size);
+
+    const TextureFormat& format() const { return *textureFormat; }
+    int width() const { return pixelWidth; }
+    int height() const { return pixelHeight; }
+    int levelCount() const { return levels; }
+    int levelWidth(int level) const { int w = width() >> level; return w > 0 ? w : 1; }
+    int levelHeight(int level) const { int h = height() >> level; return h > 0 ? h : 1; }
+    const char* levelData(int level) const { return bytes + levelIndex[level].byteOffset; }
+    size_t levelBytes(int level) const { return (size_t)levelIndex[level].byteLength; }
+
+private:
+    const char* bytes;
+    const KtxLevel* levelIndex;
+    const TextureFormat* textureFormat;
+    int pixelWidth;
+    int pixelHeight;
+    int levels;
+};
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+    : bytes(NULL), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+{
+}
+
+bool MappedFile::open(const char* path)
+{
+    close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        close();
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0)
+        return true; //CreateFileMapping refuses empty files
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    bytes = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!bytes)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    bytes = NULL;
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+#else
+MappedFile::MappedFile()
+    : bytes(NULL), length(0), descriptor(-1)
+{
+}
+
+bool MappedFile::open(const char* path)
+{
+    close();
+    descriptor = ::open(path, O_RDONLY);
+    if (descriptor < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+    {
+        close();
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0)
+        return true; //mmap refuses a length of 0
+
+    void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    //read front to back once, so the kernel can read ahead
+    madvise(address, length, MADV_SEQUENTIAL);
+    bytes = (const char*)address;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes)
+        munmap((void*)bytes, length);
+    if (descriptor >= 0)
+        ::close(descriptor);
+    bytes = NULL;
+    descriptor = -1;
+    length = 0;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+//MEMORY-MAPPED FILES
+//***********************************************************
+/*
+  Reading a file with fread copies it twice: from the disk into the OS page cache, then from the page cache into our
+  buffer. Mapping it makes the page cache itself show up in our address space: open() is cheap, nothing is read until a
+  page is touched, and the pages are shared with the cache instead of copied. For a loader that walks through a mesh
+  file once that saves the copy and the buffer.
+
+  The mapping is read-only. POSIX mmap everywhere except Windows, which has CreateFileMapping/MapViewOfFile instead.
+*/
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    //Maps the whole file. Returns false if it can't be opened or mapped; an empty file maps to size 0 and no data.
+    bool open(const char* path);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    void* file;    //HANDLE, kept out of this header so it doesn't pull in windows.h
+    void* mapping;
+#else
+    int descriptor;
+#endif
+};
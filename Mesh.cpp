@@ -0,0 +1,265 @@
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+MeshData makeTriangleMesh()
+{
+    // set up vertices for our triangle
+    // ------------------------------------------------------------------
+    static const float vertices[] = {
+        -0.5f, -0.5f, 0.0f, // left
+         0.5f, -0.5f, 0.0f, // right
+         0.0f,  0.5f, 0.0f  // top
+    };
+    static const GLuint indices[] = { 0, 1, 2 };
+    // ------------------------------------------------------------------
+
+    MeshData mesh;
+    mesh.positions.assign(vertices, vertices + 9);
+    mesh.indices.assign(indices, indices + 3);
+    return mesh;
+}
+
+MeshData makeGridMesh(int cells)
+{
+    if (cells < 1)
+        cells = 1;
+    int side = cells + 1;
+
+    MeshData mesh;
+    mesh.positions.reserve((size_t)side * side * 3);
+    for (int y = 0; y < side; y++)
+    {
+        for (int x = 0; x < side; x++)
+        {
+            mesh.positions.push_back(-0.5f + (float)x / cells);
+            mesh.positions.push_back(-0.5f + (float)y / cells);
+            mesh.positions.push_back(0.0f);
+        }
+    }
+
+    mesh.indices.reserve((size_t)cells * cells * 6);
+    for (int y = 0; y < cells; y++)
+    {
+        for (int x = 0; x < cells; x++)
+        {
+            GLuint bottomLeft = y * side + x;
+            GLuint bottomRight = bottomLeft + 1;
+            GLuint topLeft = bottomLeft + side;
+            GLuint topRight = topLeft + 1;
+
+            mesh.indices.push_back(bottomLeft);
+            mesh.indices.push_back(bottomRight);
+            mesh.indices.push_back(topRight);
+
+            mesh.indices.push_back(bottomLeft);
+            mesh.indices.push_back(topRight);
+            mesh.indices.push_back(topLeft);
+        }
+    }
+    return mesh;
+}
+
+MeshData makeDiscMesh(int segments)
+{
+    if (segments < 3)
+        segments = 3;
+
+    MeshData mesh;
+    mesh.positions.push_back(0.0f);
+    mesh.positions.push_back(0.0f);
+    mesh.positions.push_back(0.0f);
+    for (int i = 0; i < segments; i++)
+    {
+        float angle = 6.2831853f * i / segments;
+        mesh.positions.push_back(0.5f * std::cos(angle));
+        mesh.positions.push_back(0.5f * std::sin(angle));
+        mesh.positions.push_back(0.0f);
+    }
+
+    for (int i = 0; i < segments; i++)
+    {
+        mesh.indices.push_back(0);
+        mesh.indices.push_back(1 + i);
+        mesh.indices.push_back(1 + (i + 1) % segments);
+    }
+    return mesh;
+}
+
+// OBJ parsing
+// ------------------------------------
+//The text is not terminated, so none of the C library parsers (which read until they find something else) can be
+//used on it; these stop at end.
+static void skipSpaces(const char*& p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+}
+
+static void skipLine(const char*& p, const char* end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    if (p < end)
+        p++;
+}
+
+static bool parseInteger(const char*& p, const char* end, long& value)
+{
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+'))
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    if (negative)
+        value = -value;
+    return true;
+}
+
+static bool parseFloat(const char*& p, const char* end, float& value)
+{
+    bool negative = p < end && *p == '-';
+    if (negative || (p < end && *p == '+'))
+        p++;
+    double number = 0.0;
+    bool digits = false;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        number = number * 10.0 + (*p++ - '0');
+        digits = true;
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            number += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if (!digits)
+        return false;
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        long exponent;
+        if (!parseInteger(p, end, exponent))
+            return false;
+        number *= std::pow(10.0, (double)exponent);
+    }
+    value = (float)(negative ? -number : number);
+    return true;
+}
+
+bool parseObjMesh(const char* text, size_t size, MeshData& mesh)
+{
+    mesh.positions.clear();
+    mesh.indices.clear();
+
+    const char* p = text;
+    const char* end = text + size;
+    std::vector<GLuint> face;
+    while (p < end)
+    {
+        skipSpaces(p, end);
+        if (end - p > 1 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            p++;
+            for (int i = 0; i < 3; i++)
+            {
+                float value = 0.0f;
+                skipSpaces(p, end);
+                if (!parseFloat(p, end, value))
+                    return false;
+                mesh.positions.push_back(value);
+            }
+        }
+        else if (end - p > 1 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            p++;
+            face.clear();
+            long vertices = (long)mesh.vertexCount();
+            for (;;)
+            {
+                skipSpaces(p, end);
+                long index;
+                if (!parseInteger(p, end, index))
+                    break;
+                //"v", "v/vt", "v//vn" or "v/vt/vn": only the position matters here
+                while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                    p++;
+                //1-based, negative counts back from the last vertex so far
+                index = index < 0 ? vertices + index : index - 1;
+                if (index < 0 || index >= vertices)
+                    return false;
+                face.push_back((GLuint)index);
+            }
+            for (size_t i = 2; i < face.size(); i++)
+            {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i - 1]);
+                mesh.indices.push_back(face[i]);
+            }
+        }
+        skipLine(p, end);
+    }
+    return mesh.triangleCount() > 0;
+}
+
+void fitMesh(MeshData& mesh)
+{
+    if (mesh.positions.empty())
+        return;
+
+    float low[3], high[3];
+    for (int c = 0; c < 3; c++)
+        low[c] = high[c] = mesh.positions[c];
+    for (size_t i = 0; i < mesh.positions.size(); i++)
+    {
+        low[i % 3] = std::min(low[i % 3], mesh.positions[i]);
+        high[i % 3] = std::max(high[i % 3], mesh.positions[i]);
+    }
+
+    float extent = std::max(high[0] - low[0], high[1] - low[1]);
+    float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+    for (size_t i = 0; i < mesh.positions.size(); i++)
+    {
+        int c = (int)(i % 3);
+        mesh.positions[i] = (mesh.positions[i] - (low[c] + high[c]) * 0.5f) * scale;
+    }
+}
+// ------------------------------------
+
+GLenum indexTypeFor(int vertexCount)
+{
+    return vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+void packIndices(const std::vector<GLuint>& indices, GLenum type, std::vector<unsigned char>& bytes)
+{
+    if (indices.empty())
+    {
+        bytes.clear();
+        return;
+    }
+
+    if (type == GL_UNSIGNED_SHORT)
+    {
+        bytes.resize(indices.size() * sizeof(GLushort));
+        GLushort* out = (GLushort*)&bytes[0];
+        for (size_t i = 0; i < indices.size(); i++)
+            out[i] = (GLushort)indices[i];
+        return;
+    }
+
+    bytes.resize(indices.size() * sizeof(GLuint));
+    memcpy(&bytes[0], &indices[0], bytes.size());
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+//INDEXED MESHES
+//***********************************************************
+/*
+  A mesh that is drawn with glDrawArrays needs every vertex once per triangle that uses it. On a grid almost every
+  vertex is shared by 6 triangles, so the vertex data is about 6 times bigger than it has to be and the vertex shader
+  runs about 6 times per vertex.
+
+  Indexed drawing stores each vertex once and describes the triangles with a list of indices into the vertex array.
+  The indices go into an Element Buffer Object (EBO, target GL_ELEMENT_ARRAY_BUFFER) and are drawn with
+  glDrawElements. Binding the EBO while a VAO is bound stores it in the VAO, just like the attribute pointers, so
+  binding the VAO later brings the indices along.
+
+  Because a shared vertex now has one index, the GPU can also keep the result of the vertex shader for recently used
+  indices (the post-transform vertex cache) and skip running it again. How well that works depends purely on the order
+  of the triangles, see MeshOptimizer.h.
+*/
+
+struct MeshData
+{
+    std::vector<float> positions; //x, y, z per vertex
+    std::vector<GLuint> indices;  //3 per triangle, counter-clockwise
+
+    int vertexCount() const { return (int)(positions.size() / 3); }
+    int triangleCount() const { return (int)(indices.size() / 3); }
+};
+
+//The tutorial triangle, now indexed.
+MeshData makeTriangleMesh();
+
+//A flat square of cells x cells quads (2 triangles each) covering the same [-0.5, 0.5] area as the triangle, in row
+//order like most exporters write it.
+MeshData makeGridMesh(int cells);
+
+//A regular polygon with segments sides around a center vertex, radius 0.5.
+MeshData makeDiscMesh(int segments);
+
+//Parses the positions ("v") and faces ("f", polygons split into fans) of a Wavefront OBJ file of size bytes. text
+//doesn't have to end in a '\0', so a memory-mapped file can be passed directly. Everything else in the file is
+//ignored. Returns false if there is no triangle or a face points at a vertex that doesn't exist.
+bool parseObjMesh(const char* text, size_t size, MeshData& mesh);
+
+//Moves and scales mesh uniformly so it's centered on the origin and its larger side spans [-0.5, 0.5] like the
+//built-in meshes; instances are laid out for that size.
+void fitMesh(MeshData& mesh);
+
+//Smallest index type that can address vertexCount vertices: GL_UNSIGNED_SHORT up to 65536 vertices, GL_UNSIGNED_INT
+//otherwise. Half-size indices halve the index fetch bandwidth.
+GLenum indexTypeFor(int vertexCount);
+
+//Converts indices to type (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT) as raw bytes for glBufferData.
+void packIndices(const std::vector<GLuint>& indices, GLenum type, std::vector<unsigned char>& bytes);
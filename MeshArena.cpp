@@ -0,0 +1,190 @@
+#include "MeshArena.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+MeshArena::MeshArena()
+    : elementType(GL_UNSIGNED_INT), vertexCapacity(0), indexCapacity(0), vertexCount(0), indexCount(0)
+{
+}
+
+bool MeshArena::init(const VertexFormat& format, GLenum indexType, int vertices, int indices)
+{
+    GLStateCache& glState = GLStateCache::current();
+    vertexFormat = format;
+    elementType = indexType;
+    vertexCapacity = vertices;
+    indexCapacity = indices;
+    vertexCount = 0;
+    indexCount = 0;
+    meshes.clear();
+
+    //Vertex buffer object (VBO), sized for vertexCapacity vertices and filled by addMesh()
+    // ------------------------------------
+    vertexBuffer.create("mesh arena vertices"); //glGenBuffers creates the ID that is stored in vertexBuffer
+    glState.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer.get()); //binded to GL_ARRAY_BUFFER so that anything working the GL_ARRAY_BUFFER is now working with it
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * vertexFormat.stride(), NULL, GL_STATIC_DRAW); //memory is allocated on the GPU; NULL data leaves it empty for now
+    // ------------------------------------
+
+    //Vertex Array Objects
+    // ------------------------------------
+    vertexArray.create("mesh arena"); //same as before, create an ID for an object (the VAO here)
+    glState.bindVertexArray(vertexArray.get()); //Binds the VAO
+    // ------------------------------------
+
+    //glVertexAttribPointer
+    // ------------------------------------
+    ////1st parameter: index/location of vertex attribute. 2nd: size of the vertex attribute. 3rd: type of the data. 4th: bool for normalized data. 5th: stride, AKA space between consectutive vertex attributes.
+    //The format fills all of them in from its description, e.g. (0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0) for plain floats
+    vertexFormat.pointAttributes();
+    vertexFormat.enableAttributes(); //enables vertex attribute, they are disabled by default
+    // ------------------------------------
+
+    //Element buffer object (EBO)
+    // ------------------------------------
+    //Bound while the VAO is bound, so the VAO remembers it. Don't unbind it before the VAO: that would unbind it from the VAO too.
+    indexBuffer.create("mesh arena indices");
+    glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * indexSize(), NULL, GL_STATIC_DRAW);
+    // ------------------------------------
+
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0); //Unbinds the VBO
+    glState.bindVertexArray(0); //We unbind the VAO to not make any more changes to it. Optional, but good practice.
+    return glGetError() == GL_NO_ERROR;
+}
+
+void MeshArena::shutdown()
+{
+    //deleted once the GPU is done with the frames that drew from them
+    vertexArray.reset();
+    vertexBuffer.reset();
+    indexBuffer.reset();
+    meshes.clear();
+}
+
+void MeshArena::grow(GLBuffer& buffer, GLenum target, size_t usedBytes, size_t newBytes, const char* label)
+{
+    //copy on the GPU: GL_COPY_READ/WRITE_BUFFER exist so copies don't disturb the other bindings
+    GLStateCache& glState = GLStateCache::current();
+    GLBuffer bigger;
+    bigger.create(label);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, bigger.get());
+    glBufferData(GL_COPY_WRITE_BUFFER, newBytes, NULL, GL_STATIC_DRAW);
+    glState.bindBuffer(GL_COPY_READ_BUFFER, buffer.get());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+
+    //the old buffer is queued for deletion, the copy above may still be reading it
+    buffer = std::move(bigger);
+
+    //the VAO still references the old buffer: point it at the new one
+    glState.bindVertexArray(vertexArray.get());
+    glState.bindBuffer(target, buffer.get());
+    if (target == GL_ARRAY_BUFFER)
+        vertexFormat.pointAttributes();
+    glState.bindVertexArray(0);
+}
+
+bool MeshArena::reserve(int newVertices, int newIndices)
+{
+    if (elementType == GL_UNSIGNED_SHORT && newVertices > 65536)
+    {
+        std::cout << "ERROR::MESH_ARENA::TOO_MANY_VERTICES_FOR_16_BIT_INDICES " << newVertices << std::endl;
+        return false;
+    }
+
+    if (vertexCount + newVertices > vertexCapacity)
+    {
+        int capacity = vertexCapacity * 2;
+        while (capacity < vertexCount + newVertices)
+            capacity *= 2;
+        grow(vertexBuffer, GL_ARRAY_BUFFER, vertexCount * vertexFormat.stride(), capacity * vertexFormat.stride(),
+            "mesh arena vertices");
+        vertexCapacity = capacity;
+    }
+    if (indexCount + newIndices > indexCapacity)
+    {
+        int capacity = indexCapacity * 2;
+        while (capacity < indexCount + newIndices)
+            capacity *= 2;
+        grow(indexBuffer, GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize(), capacity * indexSize(), "mesh arena indices");
+        indexCapacity = capacity;
+    }
+    return true;
+}
+
+MeshRange MeshArena::take(int newVertices, int newIndices, const MeshLod* lods, int lodCount)
+{
+    MeshRange range;
+    range.baseVertex = vertexCount;
+    range.lodCount = std::max(1, std::min(lodCount, MAX_MESH_LODS));
+    for (int l = 0; l < range.lodCount; l++)
+    {
+        MeshLod full = { 0, (GLuint)newIndices, 0.0f };
+        range.lods[l] = lodCount > 0 ? lods[l] : full;
+        range.lods[l].firstIndex += indexCount;
+    }
+    range.firstIndex = range.lods[0].firstIndex;
+    range.indexCount = range.lods[0].indexCount;
+    vertexCount += newVertices;
+    indexCount += newIndices;
+    return range;
+}
+
+int MeshArena::addMesh(const MeshData& mesh, const std::vector<MeshLod>& lods)
+{
+    std::vector<unsigned char> vertices;
+    vertexFormat.encodePositions(mesh.positions, vertices);
+    std::vector<unsigned char> indices;
+    packIndices(mesh.indices, elementType, indices);
+
+    if (!upload(&vertices[0], &indices[0], mesh.vertexCount(), (int)mesh.indices.size()))
+        return -1;
+    meshes.push_back(take(mesh.vertexCount(), (int)mesh.indices.size(), lods.empty() ? NULL : &lods[0],
+        (int)lods.size()));
+    return (int)meshes.size() - 1;
+}
+
+bool MeshArena::replaceMesh(int id, const void* vertexData, const void* indexData, int vertices, int indices,
+    const MeshLod* lods, int lodCount)
+{
+    if (id < 0 || id >= meshCount() || !upload(vertexData, indexData, vertices, indices))
+        return false;
+    meshes[id] = take(vertices, indices, lods, lodCount);
+    return true;
+}
+
+bool MeshArena::upload(const void* vertexData, const void* indexData, int vertices, int indices)
+{
+    GLStateCache& glState = GLStateCache::current();
+    if (!reserve(vertices, indices))
+        return false;
+
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer.get());
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertexCount * vertexFormat.stride(), vertices * vertexFormat.stride(),
+        vertexData);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer.get());
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * indexSize(), indices * indexSize(), indexData);
+    return true;
+}
+
+bool MeshArena::replaceMesh(int id, GLuint vertexSource, GLuint indexSource, int vertices, int indices,
+    const MeshLod* lods, int lodCount)
+{
+    if (id < 0 || id >= meshCount() || !reserve(vertices, indices))
+        return false;
+
+    //a copy between two buffers stays on the GPU, however big the mesh is
+    GLStateCache& glState = GLStateCache::current();
+    glState.bindBuffer(GL_COPY_READ_BUFFER, vertexSource);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer.get());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, vertexCount * vertexFormat.stride(),
+        vertices * vertexFormat.stride());
+    glState.bindBuffer(GL_COPY_READ_BUFFER, indexSource);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer.get());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, indexCount * indexSize(), indices * indexSize());
+
+    meshes[id] = take(vertices, indices, lods, lodCount);
+    return true;
+}
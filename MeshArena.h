@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+#include "GLResource.h"
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "VertexFormat.h"
+
+//MESH ARENAS
+//***********************************************************
+/*
+  Giving every mesh its own VBO, EBO and VAO means a bind per mesh between draws, and no way of drawing several meshes
+  with one call. An arena packs many meshes that share a vertex format into one big vertex buffer and one big index
+  buffer, behind a single VAO.
+
+  Each mesh remembers where it landed (MeshRange). Its indices stay relative to its own first vertex and the draw
+  passes that vertex as baseVertex (glDrawElementsBaseVertex, core since 3.2), so a mesh' indices never have to be
+  rewritten when it moves into the arena, and 16-bit indices keep working as long as every single mesh is small enough.
+
+  The buffers grow by doubling; growing copies the old contents over on the GPU with glCopyBufferSubData.
+
+  A mesh can bring levels of detail (MeshSimplifier.h). They are extra index ranges behind its full index list that
+  reuse its vertices, so drawing a level is the same draw with a different first index and count.
+*/
+
+struct MeshRange
+{
+    GLint baseVertex;  //first vertex of the mesh inside the arena's vertex buffer
+    GLuint firstIndex; //first index of the mesh (LOD 0) inside the arena's index buffer
+    GLsizei indexCount;
+    int lodCount;      //at least 1; lods[0] is the range above
+    MeshLod lods[MAX_MESH_LODS]; //with first indices inside the arena's index buffer
+};
+
+class MeshArena
+{
+public:
+    MeshArena();
+
+    //Creates the buffers and the VAO. indexType is the type every mesh' indices are stored as.
+    bool init(const VertexFormat& format, GLenum indexType, int vertexCapacity = 4096, int indexCapacity = 16384);
+    void shutdown();
+
+    //Uploads mesh into the arena and returns its id. Every attribute of the format with location 0 gets the
+    //positions; the mesh must provide at most 65536 vertices when the index type is GL_UNSIGNED_SHORT. lods describes
+    //the levels of detail in mesh.indices as buildLods() does; without them all of mesh.indices is LOD 0.
+    int addMesh(const MeshData& mesh, const std::vector<MeshLod>& lods = std::vector<MeshLod>());
+
+    //Points mesh id at new geometry, appended like addMesh() but already encoded in format() and indices of
+    //indexType(), e.g. straight out of a mesh file. The old data stays in the buffers unused (the arena only ever
+    //grows), but the id, and so every draw and instance range that refers to it, stays the same.
+    bool replaceMesh(int id, const void* vertexData, const void* indexData, int vertices, int indices,
+        const MeshLod* lods = NULL, int lodCount = 0);
+    //Same, copied on the GPU from buffers that already hold vertices in format() and indices of indexType(), e.g. ones
+    //a loader thread filled on a shared context. The sources can be deleted once the copy was issued.
+    bool replaceMesh(int id, GLuint vertexSource, GLuint indexSource, int vertices, int indices,
+        const MeshLod* lods = NULL, int lodCount = 0);
+
+    const MeshRange& mesh(int id) const { return meshes[id]; }
+    int meshCount() const { return (int)meshes.size(); }
+    int triangleCount(int id) const { return meshes[id].indexCount / 3; }
+
+    GLuint vao() const { return vertexArray.get(); }
+    GLenum indexType() const { return elementType; }
+    size_t indexSize() const { return elementType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+    const VertexFormat& format() const { return vertexFormat; }
+
+private:
+    bool reserve(int newVertices, int newIndices); //grows the buffers so that many more fit
+    MeshRange take(int newVertices, int newIndices, const MeshLod* lods, int lodCount); //claims the space reserve() made
+    bool upload(const void* vertexData, const void* indexData, int vertices, int indices); //reserves and writes
+    void grow(GLBuffer& buffer, GLenum target, size_t usedBytes, size_t newBytes, const char* label);
+
+    VertexFormat vertexFormat;
+    GLenum elementType;
+    GLVertexArray vertexArray;
+    GLBuffer vertexBuffer;
+    GLBuffer indexBuffer;
+    int vertexCapacity;
+    int indexCapacity;
+    int vertexCount;
+    int indexCount;
+    std::vector<MeshRange> meshes;
+};
@@ -0,0 +1,133 @@
+//MESH CONVERTER
+//***********************************************************
+/*
+  Turns Wavefront OBJ files into .mesh files (MeshFile.h) once, offline, so the program doesn't parse and optimize them
+  on every start. It does exactly what the loader does with an OBJ file (fit into [-0.5, 0.5], reorder for the vertex
+  cache, renumber the vertices) and then also simplifies it into levels of detail (MeshSimplifier.h), cuts the full
+  mesh into meshlets and writes it all out.
+
+  The vertex format has to be the one the program runs with (--vertex-format, float by default): the loader uploads the
+  vertex blob as it is and refuses any other layout.
+
+      MeshConverter [--vertex-format <type>] [--index-type <16|32>] [--no-mesh-optimize] [--no-lod]
+                    <input.obj> <output.mesh>
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../MappedFile.h"
+#include "../Mesh.h"
+#include "../MeshFile.h"
+#include "../MeshOptimizer.h"
+#include "../MeshSimplifier.h"
+#include "../VertexFormat.h"
+
+static void printUsage()
+{
+    std::cout << "Usage: MeshConverter [options] <input.obj> <output.mesh>" << std::endl
+        << "  --vertex-format <type>  float, half, short, byte or packed; match the program's (default float)" << std::endl
+        << "  --index-type <16|32>    index size (default: 16-bit when the mesh has at most 65536 vertices)" << std::endl
+        << "  --no-mesh-optimize      keep the triangle and vertex order of the file" << std::endl
+        << "  --no-lod                only store the full mesh, no simplified levels of detail" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    VertexFormat::Type positionType = VertexFormat::TYPE_FLOAT;
+    int indexBits = 0; //0 = smallest that fits
+    bool optimize = true;
+    bool lod = true;
+    const char* input = NULL;
+    const char* output = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--vertex-format") == 0 && hasValue)
+        {
+            if (!VertexFormat::parseType(argv[++i], positionType))
+            {
+                std::cout << "ERROR::CONVERTER::BAD_VERTEX_FORMAT " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "--index-type") == 0 && hasValue)
+            indexBits = atoi(argv[++i]);
+        else if (strcmp(arg, "--no-mesh-optimize") == 0)
+            optimize = false;
+        else if (strcmp(arg, "--no-lod") == 0)
+            lod = false;
+        else if (arg[0] != '-' && !input)
+            input = arg;
+        else if (arg[0] != '-' && !output)
+            output = arg;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!input || !output || (indexBits != 0 && indexBits != 16 && indexBits != 32))
+    {
+        printUsage();
+        return 1;
+    }
+
+    MeshData mesh;
+    {
+        MappedFile file;
+        if (!file.open(input))
+        {
+            std::cout << "ERROR::CONVERTER::CANNOT_OPEN " << input << std::endl;
+            return 1;
+        }
+        if (!parseObjMesh(file.data(), file.size(), mesh))
+        {
+            std::cout << "ERROR::CONVERTER::NOT_A_MESH " << input << std::endl;
+            return 1;
+        }
+    }
+
+    fitMesh(mesh);
+    float acmrBefore = averageCacheMissRatio(mesh);
+    if (optimize)
+    {
+        optimizeVertexCache(mesh);
+        optimizeVertexFetch(mesh);
+    }
+
+    float acmrAfter = averageCacheMissRatio(mesh);
+    std::vector<MeshLod> lods;
+    if (lod)
+        buildLods(mesh, lods);
+
+    GLenum indexType = indexTypeFor(mesh.vertexCount());
+    if (indexBits == 32)
+        indexType = GL_UNSIGNED_INT;
+    else if (indexBits == 16 && indexType != GL_UNSIGNED_SHORT)
+    {
+        std::cout << "ERROR::CONVERTER::TOO_MANY_VERTICES_FOR_16_BIT_INDICES " << mesh.vertexCount() << std::endl;
+        return 1;
+    }
+
+    VertexFormat format;
+    format.add(0, 3, positionType);
+    std::vector<Meshlet> meshlets;
+    GLuint fullIndices = lods.empty() ? (GLuint)mesh.indices.size() : lods[0].indexCount;
+    buildMeshlets(mesh, 0, fullIndices, meshlets);
+    if (!writeMeshFile(output, format, indexType, mesh, lods, meshlets))
+        return 1;
+
+    std::cout << output << ": " << fullIndices / 3 << " triangles, " << mesh.vertexCount() << " vertices ("
+        << VertexFormat::typeName(positionType) << ", " << format.stride() << " bytes each), "
+        << (indexType == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices, " << meshlets.size() << " meshlets, ACMR "
+        << acmrBefore << " -> " << acmrAfter << std::endl;
+    for (size_t l = 1; l < lods.size(); l++)
+        std::cout << "  LOD " << l << ": " << lods[l].indexCount / 3 << " triangles, error " << lods[l].error
+            << std::endl;
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+const uint32_t MeshFileView::VERSION;
+const size_t MeshFileView::ALIGNMENT;
+
+//the tables are read in place, so their layout is part of the format
+static_assert(sizeof(MeshFileHeader) == 96, "MeshFileHeader layout changed");
+static_assert(sizeof(MeshFileAttribute) == 20, "MeshFileAttribute layout changed");
+static_assert(sizeof(MeshLod) == 12, "MeshLod layout changed");
+static_assert(sizeof(Meshlet) == 24, "Meshlet layout changed");
+
+static const char MAGIC[4] = { 'O', 'G', 'T', 'M' };
+
+static uint64_t alignUp(uint64_t offset)
+{
+    return (offset + MeshFileView::ALIGNMENT - 1) & ~(uint64_t)(MeshFileView::ALIGNMENT - 1);
+}
+
+MeshFileView::MeshFileView()
+    : bytes(NULL), header(NULL), lods(NULL), meshlets(NULL)
+{
+}
+
+bool MeshFileView::identify(const char* data, size_t size)
+{
+    return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+//whether count records of recordSize starting at offset fit into a file of size bytes, without overflowing
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t recordSize, size_t size)
+{
+    if (offset % MeshFileView::ALIGNMENT != 0 || offset > size)
+        return false;
+    return count <= (size - offset) / recordSize;
+}
+
+template <typename Index>
+static bool indicesInRange(const Index* indices, uint32_t count, uint32_t vertexCount)
+{
+    Index highest = 0;
+    for (uint32_t i = 0; i < count; i++)
+        highest = std::max(highest, indices[i]);
+    return count == 0 || highest < vertexCount;
+}
+
+bool MeshFileView::parse(const char* data, size_t size)
+{
+    header = NULL;
+    if (!identify(data, size) || size < sizeof(MeshFileHeader))
+    {
+        std::cout << "ERROR::MESH_FILE::NOT_A_MESH_FILE" << std::endl;
+        return false;
+    }
+    const MeshFileHeader* h = (const MeshFileHeader*)data;
+    if (h->version != VERSION || h->headerSize < sizeof(MeshFileHeader))
+    {
+        std::cout << "ERROR::MESH_FILE::UNSUPPORTED_VERSION " << h->version << std::endl;
+        return false;
+    }
+
+    size_t indexBytes = h->indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    bool valid = (h->indexType == GL_UNSIGNED_SHORT || h->indexType == GL_UNSIGNED_INT) && h->fileSize == size &&
+        h->vertexStride > 0 && h->indexCount % 3 == 0 && h->lodCount > 0 &&
+        sectionFits(h->attributeOffset, h->attributeCount, sizeof(MeshFileAttribute), size) &&
+        sectionFits(h->vertexOffset, h->vertexCount, h->vertexStride, size) &&
+        sectionFits(h->indexOffset, h->indexCount, indexBytes, size) &&
+        sectionFits(h->lodOffset, h->lodCount, sizeof(MeshLod), size) &&
+        sectionFits(h->meshletOffset, h->meshletCount, sizeof(Meshlet), size);
+    if (!valid)
+    {
+        std::cout << "ERROR::MESH_FILE::CORRUPT_HEADER" << std::endl;
+        return false;
+    }
+
+    //the vertex format, rebuilt through add() so it comes out exactly as the arena builds its own
+    format = VertexFormat();
+    const MeshFileAttribute* attributes = (const MeshFileAttribute*)(data + h->attributeOffset);
+    for (uint32_t i = 0; i < h->attributeCount; i++)
+    {
+        const MeshFileAttribute& a = attributes[i];
+        if (a.type > VertexFormat::TYPE_SNORM_2_10_10_10 || a.components < 1 || a.components > 4)
+        {
+            std::cout << "ERROR::MESH_FILE::UNKNOWN_ATTRIBUTE_TYPE " << a.type << std::endl;
+            return false;
+        }
+        int index = format.add(a.location, (int)a.components, (VertexFormat::Type)a.type, a.divisor);
+        if (format.attribute(index).offset != a.offset)
+        {
+            std::cout << "ERROR::MESH_FILE::UNEXPECTED_ATTRIBUTE_OFFSET " << a.offset << std::endl;
+            return false;
+        }
+    }
+    if (format.stride() != h->vertexStride)
+    {
+        std::cout << "ERROR::MESH_FILE::UNEXPECTED_VERTEX_STRIDE " << h->vertexStride << std::endl;
+        return false;
+    }
+
+    const MeshLod* levels = (const MeshLod*)(data + h->lodOffset);
+    for (uint32_t i = 0; i < h->lodCount; i++)
+    {
+        if (levels[i].firstIndex > h->indexCount || levels[i].indexCount > h->indexCount - levels[i].firstIndex)
+        {
+            std::cout << "ERROR::MESH_FILE::LOD_OUT_OF_RANGE " << i << std::endl;
+            return false;
+        }
+    }
+    const Meshlet* clusters = (const Meshlet*)(data + h->meshletOffset);
+    for (uint32_t i = 0; i < h->meshletCount; i++)
+    {
+        if (clusters[i].firstIndex > h->indexCount || clusters[i].indexCount > h->indexCount - clusters[i].firstIndex)
+        {
+            std::cout << "ERROR::MESH_FILE::MESHLET_OUT_OF_RANGE " << i << std::endl;
+            return false;
+        }
+    }
+
+    //the one pass over the data: an index past the last vertex would make the GPU read outside the buffer
+    const char* indexData = data + h->indexOffset;
+    bool inRange = h->indexType == GL_UNSIGNED_SHORT ?
+        indicesInRange((const GLushort*)indexData, h->indexCount, h->vertexCount) :
+        indicesInRange((const GLuint*)indexData, h->indexCount, h->vertexCount);
+    if (!inRange)
+    {
+        std::cout << "ERROR::MESH_FILE::INDEX_OUT_OF_RANGE" << std::endl;
+        return false;
+    }
+
+    bytes = data;
+    header = h;
+    lods = levels;
+    meshlets = clusters;
+    return true;
+}
+
+//writes bytes at offset, padding the file with zeros up to it
+static bool writeSection(FILE* file, uint64_t& position, uint64_t offset, const void* data, size_t size)
+{
+    static const char zeros[MeshFileView::ALIGNMENT] = {};
+    while (position < offset)
+    {
+        size_t padding = (size_t)std::min<uint64_t>(offset - position, sizeof(zeros));
+        if (fwrite(zeros, 1, padding, file) != padding)
+            return false;
+        position += padding;
+    }
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+        return false;
+    position += size;
+    return true;
+}
+
+bool writeMeshFile(const char* path, const VertexFormat& format, GLenum indexType, const MeshData& mesh,
+    const std::vector<MeshLod>& lods, const std::vector<Meshlet>& meshlets)
+{
+    std::vector<unsigned char> vertices;
+    format.encodePositions(mesh.positions, vertices);
+    std::vector<unsigned char> indices;
+    packIndices(mesh.indices, indexType, indices);
+
+    std::vector<MeshLod> levels(lods);
+    if (levels.empty())
+    {
+        MeshLod full = { 0, (GLuint)mesh.indices.size(), 0.0f };
+        levels.push_back(full);
+    }
+
+    std::vector<MeshFileAttribute> attributes(format.attributeCount());
+    for (int i = 0; i < format.attributeCount(); i++)
+    {
+        const VertexFormat::Attribute& a = format.attribute(i);
+        attributes[i].location = a.location;
+        attributes[i].components = (uint32_t)a.components;
+        attributes[i].type = (uint32_t)a.type;
+        attributes[i].divisor = a.divisor;
+        attributes[i].offset = (uint32_t)a.offset;
+    }
+
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MeshFileView::VERSION;
+    header.headerSize = sizeof(MeshFileHeader);
+    header.vertexCount = (uint32_t)mesh.vertexCount();
+    header.vertexStride = (uint32_t)format.stride();
+    header.attributeCount = (uint32_t)attributes.size();
+    header.indexType = indexType;
+    header.indexCount = (uint32_t)mesh.indices.size();
+    header.lodCount = (uint32_t)levels.size();
+    header.meshletCount = (uint32_t)meshlets.size();
+    for (int v = 0; v < mesh.vertexCount(); v++)
+    {
+        const float* p = &mesh.positions[v * 3];
+        header.radius = std::max(header.radius, std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+    }
+    header.attributeOffset = alignUp(sizeof(MeshFileHeader));
+    header.vertexOffset = alignUp(header.attributeOffset + attributes.size() * sizeof(MeshFileAttribute));
+    header.indexOffset = alignUp(header.vertexOffset + vertices.size());
+    header.lodOffset = alignUp(header.indexOffset + indices.size());
+    header.meshletOffset = alignUp(header.lodOffset + levels.size() * sizeof(MeshLod));
+    header.fileSize = header.meshletOffset + meshlets.size() * sizeof(Meshlet);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    uint64_t position = 0;
+    bool ok = writeSection(file, position, 0, &header, sizeof(header)) &&
+        writeSection(file, position, header.attributeOffset, attributes.data(),
+            attributes.size() * sizeof(MeshFileAttribute)) &&
+        writeSection(file, position, header.vertexOffset, vertices.data(), vertices.size()) &&
+        writeSection(file, position, header.indexOffset, indices.data(), indices.size()) &&
+        writeSection(file, position, header.lodOffset, levels.data(), levels.size() * sizeof(MeshLod)) &&
+        writeSection(file, position, header.meshletOffset, meshlets.data(), meshlets.size() * sizeof(Meshlet));
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+        std::cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << std::endl;
+    return ok;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexFormat.h"
+
+//BINARY MESH FILES
+//***********************************************************
+/*
+  A text format like OBJ has to be parsed number by number, then fitted, optimized and encoded before a single byte
+  can go to the GPU, and all of that runs again on every start. A .mesh file stores the result of that work: the
+  vertices already encoded in a vertex format and the indices already in their final type and order. Loading one is
+  mapping the file (MappedFile.h), checking the header and passing pointers into the mapping straight to
+  glBufferData; no copies on the CPU, and nothing that depends on the size of the mesh except the index range check.
+
+  Layout, all little-endian like every platform this program runs on, every offset from the start of the file:
+      MeshFileHeader                      magic "OGTM", version, counts and where everything else is
+      MeshFileAttribute[attributeCount]   the vertex format: location, components, VertexFormat::Type, offset
+      vertex blob                         vertexCount * vertexStride bytes, ready for GL_ARRAY_BUFFER
+      index blob                          indexCount indices of indexType (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+      MeshLod[lodCount]                   index ranges of the levels of detail, LOD 0 is the full mesh
+      Meshlet[meshletCount]               index ranges of LOD 0 of at most 64 vertices, with bounding spheres
+  Every section starts on a 64-byte boundary, so the tables can be read in place and the blobs start on a cache line.
+  A reader refuses any other major version; the tables are written in the order above so a version can add sections
+  at the end without moving the old ones.
+
+  The converter (MeshConverter/, the second project of the solution) writes them from OBJ files.
+*/
+
+struct MeshFileHeader
+{
+    char magic[4];           //"OGTM"
+    uint32_t version;        //MeshFileView::VERSION
+    uint32_t headerSize;     //sizeof(MeshFileHeader) of the writer
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    uint32_t attributeCount;
+    uint32_t indexType;      //GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t indexCount;     //of all levels of detail together
+    uint32_t lodCount;
+    uint32_t meshletCount;
+    float radius;            //bounding sphere around the origin
+    uint32_t reserved;
+    uint64_t attributeOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t fileSize;
+};
+
+struct MeshFileAttribute
+{
+    uint32_t location;
+    uint32_t components;
+    uint32_t type; //VertexFormat::Type
+    uint32_t divisor;
+    uint32_t offset;
+};
+
+//Reads a .mesh file in place: every pointer points into the bytes passed to parse(), which have to stay alive (mapped)
+//as long as they are used.
+class MeshFileView
+{
+public:
+    static const uint32_t VERSION = 1;
+    static const size_t ALIGNMENT = 64;
+
+    MeshFileView();
+
+    //Whether data starts like a mesh file at all, to tell it apart from other formats.
+    static bool identify(const char* data, size_t size);
+
+    //Checks the header, that every section lies inside the file, and that every index points at a vertex. Returns
+    //false (and prints why) if anything is off.
+    bool parse(const char* data, size_t size);
+
+    int vertexCount() const { return (int)header->vertexCount; }
+    int indexCount() const { return (int)header->indexCount; }
+    GLenum indexType() const { return header->indexType; }
+    size_t indexSize() const { return header->indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+    float radius() const { return header->radius; }
+    const void* vertexData() const { return bytes + header->vertexOffset; }
+    size_t vertexBytes() const { return (size_t)header->vertexCount * header->vertexStride; }
+    const void* indexData() const { return bytes + header->indexOffset; }
+
+    //The format the vertices are stored in, to compare with the arena's.
+    const VertexFormat& vertexFormat() const { return format; }
+
+    int lodCount() const { return (int)header->lodCount; }
+    const MeshLod& lod(int level) const { return lods[level]; }
+    int meshletCount() const { return (int)header->meshletCount; }
+    const Meshlet& meshlet(int index) const { return meshlets[index]; }
+
+private:
+    const char* bytes;
+    const MeshFileHeader* header;
+    const MeshLod* lods;
+    const Meshlet* meshlets;
+    VertexFormat format;
+};
+
+//Writes mesh as a .mesh file: its positions encoded in format, and its indices (every level of lods, LOD 0 being the
+//full mesh; empty means mesh.indices is LOD 0) as indexType. Returns false if the file can't be written.
+bool writeMeshFile(const char* path, const VertexFormat& format, GLenum indexType, const MeshData& mesh,
+    const std::vector<MeshLod>& lods, const std::vector<Meshlet>& meshlets);
@@ -0,0 +1,209 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+void optimizeVertexCache(MeshData& mesh, int cacheSize)
+{
+    int vertexCount = mesh.vertexCount();
+    int triangleCount = mesh.triangleCount();
+    if (triangleCount == 0)
+        return;
+    const std::vector<GLuint>& indices = mesh.indices;
+
+    //vertex -> triangles adjacency, stored compactly: the triangles of vertex v are
+    //adjacency[firstTriangle[v] .. firstTriangle[v + 1])
+    std::vector<int> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < indices.size(); i++)
+        liveTriangles[indices[i]]++;
+
+    std::vector<int> firstTriangle(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; v++)
+        firstTriangle[v + 1] = firstTriangle[v] + liveTriangles[v];
+
+    std::vector<int> adjacency(indices.size());
+    std::vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++)
+        adjacency[fill[indices[i]]++] = (int)(i / 3);
+
+    std::vector<int> cacheTime(vertexCount, 0); //when each vertex last entered the cache
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<int> deadEnds; //recently used vertices, to restart from when a fan runs dry
+    std::vector<int> candidates;
+    std::vector<GLuint> output;
+    output.reserve(indices.size());
+
+    int time = cacheSize + 1;
+    int cursor = 0; //next vertex to try in input order once the dead-end stack is empty too
+    int fanCenter = 0;
+
+    while (fanCenter >= 0)
+    {
+        //emit every remaining triangle around the fan center
+        candidates.clear();
+        for (int a = firstTriangle[fanCenter]; a < firstTriangle[fanCenter + 1]; a++)
+        {
+            int triangle = adjacency[a];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+
+            for (int corner = 0; corner < 3; corner++)
+            {
+                GLuint v = indices[triangle * 3 + corner];
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++; //vertex wasn't in the cache, loading it pushes the others back
+            }
+        }
+
+        //next fan center: the candidate that is still cached and has the most use left in it
+        fanCenter = -1;
+        int bestPriority = -1;
+        for (size_t c = 0; c < candidates.size(); c++)
+        {
+            int v = candidates[c];
+            if (liveTriangles[v] <= 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanCenter = v;
+            }
+        }
+
+        if (fanCenter == -1)
+        {
+            //dead end: most recently used vertex that still has triangles, then any vertex in input order
+            while (!deadEnds.empty() && fanCenter == -1)
+            {
+                int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[v] > 0)
+                    fanCenter = v;
+            }
+            while (fanCenter == -1 && cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0)
+                    fanCenter = cursor;
+                cursor++;
+            }
+        }
+    }
+
+    mesh.indices.swap(output);
+}
+
+int optimizeVertexFetch(MeshData& mesh)
+{
+    const int UNUSED = -1;
+    std::vector<int> remap(mesh.vertexCount(), UNUSED);
+    std::vector<float> positions;
+    positions.reserve(mesh.positions.size());
+
+    int next = 0;
+    for (size_t i = 0; i < mesh.indices.size(); i++)
+    {
+        GLuint v = mesh.indices[i];
+        if (remap[v] == UNUSED)
+        {
+            remap[v] = next++;
+            positions.insert(positions.end(), mesh.positions.begin() + v * 3, mesh.positions.begin() + v * 3 + 3);
+        }
+        mesh.indices[i] = remap[v];
+    }
+
+    mesh.positions.swap(positions);
+    return next;
+}
+
+float averageCacheMissRatio(const MeshData& mesh, int cacheSize)
+{
+    if (mesh.triangleCount() == 0)
+        return 0.0f;
+
+    //FIFO: a vertex is cached if it entered the cache fewer than cacheSize misses ago
+    std::vector<int> enteredAt(mesh.vertexCount(), -cacheSize - 1);
+    int misses = 0;
+    for (size_t i = 0; i < mesh.indices.size(); i++)
+    {
+        GLuint v = mesh.indices[i];
+        if (misses - enteredAt[v] > cacheSize)
+            enteredAt[v] = misses++;
+    }
+    return (float)misses / (float)mesh.triangleCount();
+}
+
+static void boundMeshlet(const MeshData& mesh, Meshlet& meshlet)
+{
+    //center of the bounding box, then the farthest corner from it; not the tightest sphere, but close and O(n)
+    float low[3] = { 0.0f, 0.0f, 0.0f };
+    float high[3] = { 0.0f, 0.0f, 0.0f };
+    for (GLuint i = 0; i < meshlet.indexCount; i++)
+    {
+        const float* p = &mesh.positions[mesh.indices[meshlet.firstIndex + i] * 3];
+        for (int c = 0; c < 3; c++)
+        {
+            low[c] = i == 0 ? p[c] : std::min(low[c], p[c]);
+            high[c] = i == 0 ? p[c] : std::max(high[c], p[c]);
+        }
+    }
+    for (int c = 0; c < 3; c++)
+        meshlet.center[c] = (low[c] + high[c]) * 0.5f;
+
+    float radiusSquared = 0.0f;
+    for (GLuint i = 0; i < meshlet.indexCount; i++)
+    {
+        const float* p = &mesh.positions[mesh.indices[meshlet.firstIndex + i] * 3];
+        float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+        radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+}
+
+void buildMeshlets(const MeshData& mesh, GLuint firstIndex, GLuint indexCount, std::vector<Meshlet>& meshlets,
+    int maxVertices, int maxTriangles)
+{
+    //which meshlet last counted each vertex, so a vertex is only counted once per meshlet
+    std::vector<int> seenBy(mesh.vertexCount(), -1);
+    int current = (int)meshlets.size();
+    int vertices = 0;
+
+    Meshlet meshlet = { firstIndex, 0, { 0.0f, 0.0f, 0.0f }, 0.0f };
+    for (GLuint t = firstIndex; t + 3 <= firstIndex + indexCount; t += 3)
+    {
+        int added = 0;
+        for (int corner = 0; corner < 3; corner++)
+            added += seenBy[mesh.indices[t + corner]] != current;
+
+        if (meshlet.indexCount > 0 && (vertices + added > maxVertices || (int)meshlet.indexCount / 3 >= maxTriangles))
+        {
+            boundMeshlet(mesh, meshlet);
+            meshlets.push_back(meshlet);
+            meshlet.firstIndex = t;
+            meshlet.indexCount = 0;
+            current++;
+            GLuint a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+            vertices = 1 + (b != a) + (c != a && c != b); //all new to this meshlet
+        }
+        else
+            vertices += added;
+
+        for (int corner = 0; corner < 3; corner++)
+            seenBy[mesh.indices[t + corner]] = current;
+        meshlet.indexCount += 3;
+    }
+    if (meshlet.indexCount > 0)
+    {
+        boundMeshlet(mesh, meshlet);
+        meshlets.push_back(meshlet);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Mesh.h"
+
+//VERTEX CACHE OPTIMIZATION
+//***********************************************************
+/*
+  The GPU keeps the outputs of the last few vertex shader runs in a small post-transform cache, looked up by index. A
+  triangle whose indices are still in that cache costs no vertex shading at all. The cache is tiny (roughly 16-32
+  entries, and on modern hardware it isn't even a true FIFO), so what matters is emitting triangles that share vertices
+  close together.
+
+  The quality is measured as ACMR (average cache miss ratio): vertex shader runs per triangle. 3.0 is the worst case
+  (a vertex shader run for every corner), about 0.5 is the best a regular grid can reach.
+
+  optimizeVertexCache() reorders the triangles with Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for
+  Vertex Locality and Reduced Overdraw", 2007). It fans out around one vertex at a time and picks the next fan center
+  among the vertices just emitted that will still be in the cache, falling back to recently used vertices when it runs
+  into a dead end. It runs in linear time, so it is cheap enough to do when a mesh is loaded.
+
+  optimizeVertexFetch() then renumbers the vertices in the order the new index list first uses them. Vertex fetches
+  become mostly sequential, so each cache line of vertex data is loaded once, and unused vertices are dropped.
+
+  buildMeshlets() cuts the optimized triangle order into meshlets: runs of consecutive triangles that touch at most 64
+  vertices and 124 triangles, each with a bounding sphere. Since the triangles are already grouped around shared
+  vertices, the runs come out compact. A meshlet is just an index range, so it can be culled and drawn on its own from
+  the same index buffer; the mesh file stores them for that.
+*/
+
+struct Meshlet
+{
+    GLuint firstIndex;
+    GLuint indexCount;
+    float center[3];
+    float radius;
+};
+
+//Reorders the triangles in mesh.indices for a post-transform cache of cacheSize entries.
+void optimizeVertexCache(MeshData& mesh, int cacheSize = 16);
+
+//Reorders mesh.positions into first-use order and rewrites the indices to match. Returns the new vertex count.
+int optimizeVertexFetch(MeshData& mesh);
+
+//Simulated vertex shader runs per triangle for a FIFO cache of cacheSize entries.
+float averageCacheMissRatio(const MeshData& mesh, int cacheSize = 16);
+
+//Splits indices [firstIndex, firstIndex + indexCount) of mesh into meshlets of at most maxVertices distinct vertices and
+//maxTriangles triangles, in order, and appends them to meshlets.
+void buildMeshlets(const MeshData& mesh, GLuint firstIndex, GLuint indexCount, std::vector<Meshlet>& meshlets,
+    int maxVertices = 64, int maxTriangles = 124);
@@ -0,0 +1,341 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+//open edges weigh more than faces: a border that moves is easier to spot than a surface that sinks a bit
+static const double BORDER_WEIGHT = 10.0;
+
+//symmetric 4x4 matrix, the upper triangle row by row, and the total weight of its planes
+struct Quadric
+{
+    double a[10];
+    double weight;
+
+    void clear()
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] = 0.0;
+        weight = 0.0;
+    }
+
+    //adds planeWeight * (n, d)(n, d)^T for the plane dot(n, p) + d = 0
+    void addPlane(double nx, double ny, double nz, double d, double planeWeight)
+    {
+        double w = planeWeight;
+        a[0] += w * nx * nx; a[1] += w * nx * ny; a[2] += w * nx * nz; a[3] += w * nx * d;
+        a[4] += w * ny * ny; a[5] += w * ny * nz; a[6] += w * ny * d;
+        a[7] += w * nz * nz; a[8] += w * nz * d;
+        a[9] += w * d * d;
+        weight += planeWeight;
+    }
+
+    void add(const Quadric& other)
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] += other.a[i];
+        weight += other.weight;
+    }
+
+    //mean squared distance of (x, y, z) to the planes, weighted; the mean keeps it in squared mesh units however many
+    //planes the vertex collected
+    double evaluate(double x, double y, double z) const
+    {
+        double sum = a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x +
+            a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y +
+            a[7] * z * z + 2.0 * a[8] * z + a[9];
+        return weight > 0.0 ? std::max(0.0, sum) / weight : 0.0;
+    }
+};
+
+struct Collapse
+{
+    double cost;
+    GLuint from;
+    GLuint to;
+
+    bool operator<(const Collapse& other) const { return cost < other.cost; }
+};
+
+static void triangleNormal(const float* p0, const float* p1, const float* p2, double n[3])
+{
+    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static uint64_t edgeKey(GLuint a, GLuint b)
+{
+    return ((uint64_t)a << 32) | b;
+}
+
+static void buildQuadrics(const std::vector<float>& positions, const std::vector<GLuint>& indices,
+    std::vector<Quadric>& quadrics)
+{
+    quadrics.resize(positions.size() / 3);
+    for (size_t v = 0; v < quadrics.size(); v++)
+        quadrics[v].clear();
+
+    //every directed edge, sorted, to find the ones whose twin is missing: those are the open edges
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t t = 0; t + 3 <= indices.size(); t += 3)
+        for (int corner = 0; corner < 3; corner++)
+            edges.push_back(edgeKey(indices[t + corner], indices[t + (corner + 1) % 3]));
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t t = 0; t + 3 <= indices.size(); t += 3)
+    {
+        const float* p[3];
+        for (int corner = 0; corner < 3; corner++)
+            p[corner] = &positions[indices[t + corner] * 3];
+        double n[3];
+        triangleNormal(p[0], p[1], p[2], n);
+        double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0.0)
+            continue;
+        n[0] /= length; n[1] /= length; n[2] /= length;
+        double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+        for (int corner = 0; corner < 3; corner++)
+            quadrics[indices[t + corner]].addPlane(n[0], n[1], n[2], d, 1.0);
+
+        for (int corner = 0; corner < 3; corner++)
+        {
+            GLuint a = indices[t + corner];
+            GLuint b = indices[t + (corner + 1) % 3];
+            if (std::binary_search(edges.begin(), edges.end(), edgeKey(b, a)))
+                continue;
+
+            //the plane through the open edge that stands upright on the triangle
+            const float* pa = &positions[a * 3];
+            const float* pb = &positions[b * 3];
+            double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+            double m[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+            double mLength = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+            if (mLength == 0.0)
+                continue;
+            m[0] /= mLength; m[1] /= mLength; m[2] /= mLength;
+            double md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+            quadrics[a].addPlane(m[0], m[1], m[2], md, BORDER_WEIGHT);
+            quadrics[b].addPlane(m[0], m[1], m[2], md, BORDER_WEIGHT);
+        }
+    }
+}
+
+//whether moving from onto to turns any triangle around from (that doesn't also hold to) over
+static bool flips(const std::vector<float>& positions, const std::vector<GLuint>& indices,
+    const std::vector<int>& firstTriangle, const std::vector<int>& adjacency, GLuint from, GLuint to)
+{
+    for (int a = firstTriangle[from]; a < firstTriangle[from + 1]; a++)
+    {
+        size_t t = (size_t)adjacency[a] * 3;
+        GLuint corners[3] = { indices[t], indices[t + 1], indices[t + 2] };
+        if (corners[0] == to || corners[1] == to || corners[2] == to)
+            continue; //collapses away
+
+        double before[3];
+        triangleNormal(&positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3], before);
+        for (int c = 0; c < 3; c++)
+            if (corners[c] == from)
+                corners[c] = to;
+        double after[3];
+        triangleNormal(&positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3], after);
+        if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+            return true;
+    }
+    return false;
+}
+
+//One run that passes through several targets (largest first) and keeps a copy of the triangles at each one, so a chain
+//of levels costs as much as its coarsest level alone. Returns how many targets it reached.
+static int simplify(const std::vector<float>& positions, const std::vector<GLuint>& indices, const size_t* targets,
+    int targetCount, float maxError, std::vector<GLuint>* outputs, float* errors)
+{
+    std::vector<GLuint> out(indices);
+    int vertexCount = (int)(positions.size() / 3);
+    std::vector<Quadric> quadrics;
+    buildQuadrics(positions, indices, quadrics);
+
+    double maxCost = (double)maxError * maxError;
+    double reached = 0.0;
+    std::vector<GLuint> remap(vertexCount);
+    std::vector<int> firstTriangle;
+    std::vector<int> adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<char> locked;
+
+    //in passes: rank every edge, collapse the cheapest ones that don't touch each other, rebuild, repeat
+    int reachedTargets = 0;
+    while (reachedTargets < targetCount)
+    {
+        if (out.size() <= targets[reachedTargets])
+        {
+            outputs[reachedTargets] = out;
+            errors[reachedTargets] = (float)std::sqrt(reached);
+            reachedTargets++;
+            continue;
+        }
+        size_t targetIndexCount = targets[reachedTargets];
+        size_t triangleCount = out.size() / 3;
+
+        //triangles around each vertex
+        firstTriangle.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < out.size(); i++)
+            firstTriangle[out[i] + 1]++;
+        for (int v = 0; v < vertexCount; v++)
+            firstTriangle[v + 1] += firstTriangle[v];
+        adjacency.resize(out.size());
+        std::vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < out.size(); i++)
+            adjacency[fill[out[i]]++] = (int)(i / 3);
+
+        //every edge once, collapsed in its cheaper direction
+        edges.clear();
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+            {
+                GLuint a = out[t * 3 + corner];
+                GLuint b = out[t * 3 + (corner + 1) % 3];
+                edges.push_back(edgeKey(std::min(a, b), std::max(a, b)));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (size_t e = 0; e < edges.size(); e++)
+        {
+            GLuint a = (GLuint)(edges[e] >> 32);
+            GLuint b = (GLuint)(edges[e] & 0xFFFFFFFFu);
+            Quadric sum = quadrics[a];
+            sum.add(quadrics[b]);
+            const float* pa = &positions[a * 3];
+            const float* pb = &positions[b * 3];
+            double toB = sum.evaluate(pb[0], pb[1], pb[2]);
+            double toA = sum.evaluate(pa[0], pa[1], pa[2]);
+            Collapse collapse = toB <= toA ? Collapse{ toB, a, b } : Collapse{ toA, b, a };
+            if (collapse.cost <= maxCost)
+                collapses.push_back(collapse);
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        //a collapse changes the triangles around both ends, so their vertices sit out the rest of the pass
+        for (int v = 0; v < vertexCount; v++)
+            remap[v] = (GLuint)v;
+        locked.assign(vertexCount, 0);
+        size_t trianglesToRemove = (out.size() - targetIndexCount + 2) / 3;
+        size_t removed = 0;
+        int collapsed = 0;
+        for (size_t c = 0; c < collapses.size() && removed < trianglesToRemove; c++)
+        {
+            const Collapse& collapse = collapses[c];
+            if (locked[collapse.from] || locked[collapse.to])
+                continue;
+            if (flips(positions, out, firstTriangle, adjacency, collapse.from, collapse.to))
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            reached = std::max(reached, collapse.cost);
+            collapsed++;
+
+            GLuint ends[2] = { collapse.from, collapse.to };
+            for (int end = 0; end < 2; end++)
+            {
+                for (int a = firstTriangle[ends[end]]; a < firstTriangle[ends[end] + 1]; a++)
+                {
+                    size_t t = (size_t)adjacency[a] * 3;
+                    bool shared = false;
+                    for (int corner = 0; corner < 3; corner++)
+                    {
+                        locked[out[t + corner]] = 1;
+                        shared = shared || (end == 0 && out[t + corner] == collapse.to);
+                    }
+                    removed += shared;
+                }
+            }
+        }
+        if (collapsed == 0)
+            break;
+
+        //drop the triangles that lost a corner
+        size_t kept = 0;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            GLuint a = remap[out[t * 3]];
+            GLuint b = remap[out[t * 3 + 1]];
+            GLuint c = remap[out[t * 3 + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            out[kept++] = a;
+            out[kept++] = b;
+            out[kept++] = c;
+        }
+        out.resize(kept);
+    }
+    //the last target takes whatever it got down to
+    if (reachedTargets < targetCount)
+    {
+        outputs[reachedTargets] = out;
+        errors[reachedTargets] = (float)std::sqrt(reached);
+        reachedTargets++;
+    }
+    return reachedTargets;
+}
+
+float simplifyMesh(const std::vector<float>& positions, const std::vector<GLuint>& indices, size_t targetIndexCount,
+    float maxError, std::vector<GLuint>& out)
+{
+    float error = 0.0f;
+    simplify(positions, indices, &targetIndexCount, 1, maxError, &out, &error);
+    return error;
+}
+
+void buildLods(MeshData& mesh, std::vector<MeshLod>& lods, int maxLods)
+{
+    lods.clear();
+    MeshLod full = { 0, (GLuint)mesh.indices.size(), 0.0f };
+    lods.push_back(full);
+    if (maxLods > MAX_MESH_LODS)
+        maxLods = MAX_MESH_LODS;
+
+    //every level is cut from the full mesh in one run, so its error is measured against the original surface
+    size_t targets[MAX_MESH_LODS];
+    std::vector<GLuint> levels[MAX_MESH_LODS];
+    float errors[MAX_MESH_LODS];
+    int levelCount = maxLods - 1;
+    size_t target = mesh.indices.size();
+    for (int l = 0; l < levelCount; l++)
+    {
+        target = std::max<size_t>(3, target / 4 / 3 * 3);
+        targets[l] = target;
+    }
+    std::vector<GLuint> base(mesh.indices);
+    levelCount = simplify(mesh.positions, base, targets, levelCount, FLT_MAX, levels, errors);
+
+    MeshData level;
+    size_t previous = base.size();
+    for (int l = 0; l < levelCount; l++)
+    {
+        if (levels[l].empty() || levels[l].size() * 10 > previous * 8)
+            break; //less than 20% fewer triangles isn't worth a level
+
+        //the cache optimizer only looks at the vertex count, so lend it the positions instead of copying them
+        level.indices.swap(levels[l]);
+        level.positions.swap(mesh.positions);
+        optimizeVertexCache(level);
+        level.positions.swap(mesh.positions);
+
+        MeshLod lod = { (GLuint)mesh.indices.size(), (GLuint)level.indices.size(), std::max(errors[l], lods.back().error) };
+        lods.push_back(lod);
+        mesh.indices.insert(mesh.indices.end(), level.indices.begin(), level.indices.end());
+        previous = level.indices.size();
+    }
+}
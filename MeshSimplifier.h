@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+#include "Mesh.h"
+
+//MESH SIMPLIFICATION
+//***********************************************************
+/*
+  An instance that covers a few pixels on screen still runs the vertex shader for every vertex of its mesh and sets up
+  every triangle, even though most of them end up smaller than a pixel. A level of detail (LOD) is a version of the
+  mesh with fewer triangles that looks the same from far enough away; the renderer picks one per instance (Renderer::selectLods).
+
+  The levels are made by edge collapse with quadric error metrics (Garland and Heckbert, "Surface Simplification Using
+  Quadric Error Metrics", 1997). Every triangle defines a plane; each vertex sums the quadrics of the planes around it,
+  a 4x4 matrix Q for which v^T Q v is the sum of squared distances from a point v to all of those planes. Collapsing
+  the edge u -> v moves u onto v, and (Qu + Qv)(v) says how far that takes the surface from where it was. The
+  cheapest collapses go first, and the quadrics add up as vertices merge, so the error keeps tracking the original
+  surface rather than the last step.
+
+  u always moves onto an existing vertex (a half-edge collapse). That way every level only needs a new index list: all
+  of them share the vertices of the full mesh, and adding a level to the mesh arena is just more indices.
+
+  Open edges get an extra plane through the edge, perpendicular to its triangle, so borders (and our flat meshes are
+  nothing but border and plane) keep their outline. A collapse that would flip a triangle over is skipped.
+*/
+
+struct MeshLod
+{
+    GLuint firstIndex; //into the index list of all levels; the indices of every level use the same vertices
+    GLuint indexCount;
+    float error;       //how far the level may stray from the full mesh, in mesh units (0 for LOD 0)
+};
+
+static const int MAX_MESH_LODS = 4;
+
+//Collapses edges of the triangles in indices until at most targetIndexCount indices are left or the next collapse
+//would cost more than maxError (in mesh units). Writes the result to out and returns the error it reached.
+float simplifyMesh(const std::vector<float>& positions, const std::vector<GLuint>& indices, size_t targetIndexCount,
+    float maxError, std::vector<GLuint>& out);
+
+//Appends up to maxLods - 1 simplified levels of mesh.indices to mesh.indices, each with about a quarter of the
+//triangles of the one before and reordered for the vertex cache, and describes all levels in lods (LOD 0 is the
+//incoming mesh). Stops early once a level barely shrinks. Run it after optimizeVertexFetch(): the levels keep the
+//vertex numbering.
+void buildLods(MeshData& mesh, std::vector<MeshLod>& lods, int maxLods = MAX_MESH_LODS);
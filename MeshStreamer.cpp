@@ -0,0 +1,296 @@
+#include "MeshStreamer.h"
+#include "GLDebug.h"
+#include "GLResource.h"
+#include "MappedFile.h"
+#include "MeshArena.h"
+#include "MeshFile.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+const int MeshStreamer::MAX_FILES;
+
+MeshStreamer::MeshStreamer()
+    : context(NULL), elementType(GL_UNSIGNED_INT), optimizeMeshes(true), buildLevels(false), printProgress(false),
+      startTime(0.0), stopping(false), failures(0), hasWaiting(false), published(0)
+{
+}
+
+MeshStreamer::~MeshStreamer()
+{
+    //stop() already ran with the context current; this only makes sure the thread isn't left running
+    stopping.store(true);
+    if (thread.joinable())
+        thread.join();
+}
+
+void MeshStreamer::start(GLFWwindow* uploadContext, const std::vector<const char*>& files, const VertexFormat& format,
+    GLenum indexType, bool optimize, bool lods, bool verbose)
+{
+    if (thread.joinable() || files.empty())
+        return;
+    paths.assign(files.begin(), files.begin() + std::min((int)files.size(), MAX_FILES));
+    context = uploadContext;
+    vertexFormat = format;
+    elementType = indexType;
+    optimizeMeshes = optimize;
+    buildLevels = lods;
+    printProgress = verbose;
+    startTime = glfwGetTime();
+    stopping.store(false);
+    thread = std::thread(&MeshStreamer::loaderMain, this);
+}
+
+void MeshStreamer::stop()
+{
+    if (!thread.joinable())
+        return;
+    stopping.store(true);
+    thread.join();
+
+    //whatever the loader finished but nobody picked up
+    if (hasWaiting)
+        discard(waiting);
+    hasWaiting = false;
+    Loaded item;
+    while (results.pop(item))
+        discard(item);
+}
+
+void MeshStreamer::discard(Loaded& item)
+{
+    if (item.fence)
+        glDeleteSync(item.fence);
+    //the loader handed the names over; taking them into this context's registry queues them for deletion
+    GLBuffer vertices, indices;
+    if (item.vertexBuffer)
+        vertices.adopt(item.vertexBuffer, "streamed mesh vertices");
+    if (item.indexBuffer)
+        indices.adopt(item.indexBuffer, "streamed mesh indices");
+    delete item.bytes;
+    item.bytes = NULL;
+}
+
+int MeshStreamer::poll(MeshArena& arena, float& radius)
+{
+    int replaced = 0;
+    for (;;)
+    {
+        if (!hasWaiting)
+        {
+            if (!results.pop(waiting))
+                break;
+            hasWaiting = true;
+        }
+
+        bool ok;
+        if (waiting.fence)
+        {
+            //in order: the later uploads are behind this one on the GPU anyway
+            if (glClientWaitSync(waiting.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                break;
+            ok = arena.replaceMesh(waiting.mesh, waiting.vertexBuffer, waiting.indexBuffer, waiting.vertices,
+                waiting.indices, waiting.lods, waiting.lodCount);
+        }
+        else
+        {
+            const unsigned char* vertices = &(*waiting.bytes)[0];
+            ok = arena.replaceMesh(waiting.mesh, vertices, vertices + waiting.vertices * vertexFormat.stride(),
+                waiting.vertices, waiting.indices, waiting.lods, waiting.lodCount);
+        }
+
+        if (ok)
+        {
+            radius = std::max(radius, waiting.radius);
+            replaced++;
+            published++;
+            if (printProgress)
+                std::cout << "Streamed " << paths[waiting.mesh] << ": " << arena.triangleCount(waiting.mesh)
+                    << " triangles, " << arena.mesh(waiting.mesh).lodCount << " LODs, loaded in "
+                    << waiting.seconds * 1000.0 << " ms, drawn " << (glfwGetTime() - startTime) * 1000.0
+                    << " ms after the start" << (context ? "" : " (uploaded on the render thread)") << std::endl;
+        }
+        else
+            failures.fetch_add(1);
+        discard(waiting); //the copy is queued, the deletion queue waits for it
+        hasWaiting = false;
+    }
+    return replaced;
+}
+
+bool MeshStreamer::load(int index, Loaded& item)
+{
+    double begin = glfwGetTime();
+    const char* path = paths[index];
+    item.mesh = index;
+    item.vertexBuffer = 0;
+    item.indexBuffer = 0;
+    item.fence = 0;
+    item.bytes = NULL;
+    item.lodCount = 0;
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cout << "ERROR::MESH_STREAMER::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+
+    //a .mesh file is already in its final form and goes from the mapping to the GPU; anything else is parsed as OBJ
+    std::vector<unsigned char> vertexBytes, indexBytes;
+    const void* vertexData;
+    const void* indexData;
+    size_t vertexSize, indexSize;
+    if (MeshFileView::identify(file.data(), file.size()))
+    {
+        MeshFileView view;
+        if (!view.parse(file.data(), file.size()))
+        {
+            std::cout << "ERROR::MESH_STREAMER::INVALID_MESH_FILE " << path << std::endl;
+            return false;
+        }
+        if (!view.vertexFormat().matches(vertexFormat))
+        {
+            std::cout << "ERROR::MESH_STREAMER::VERTEX_FORMAT_MISMATCH " << path
+                << " (convert it with the --vertex-format the program runs with)" << std::endl;
+            return false;
+        }
+        //every level goes up, the LOD table says where each one starts
+        item.vertices = view.vertexCount();
+        item.indices = view.indexCount();
+        item.radius = view.radius();
+        item.lodCount = std::min(view.lodCount(), buildLevels ? MAX_MESH_LODS : 1);
+        for (int l = 0; l < item.lodCount; l++)
+            item.lods[l] = view.lod(l);
+        vertexData = view.vertexData();
+        vertexSize = view.vertexBytes();
+        indexData = view.indexData();
+        indexSize = view.indexCount() * view.indexSize();
+        if (view.indexType() == GL_UNSIGNED_INT && elementType == GL_UNSIGNED_SHORT)
+        {
+            std::cout << "ERROR::MESH_STREAMER::32_BIT_INDICES " << path << std::endl;
+            return false;
+        }
+        if (view.indexType() != elementType)
+        {
+            //16-bit indices for an arena with 32-bit ones: the only case that needs a copy
+            const GLushort* narrow = (const GLushort*)indexData;
+            std::vector<GLuint> widened(narrow, narrow + view.indexCount());
+            packIndices(widened, elementType, indexBytes);
+            indexData = &indexBytes[0];
+            indexSize = indexBytes.size();
+        }
+    }
+    else
+    {
+        MeshData mesh;
+        if (!parseObjMesh(file.data(), file.size(), mesh))
+        {
+            std::cout << "ERROR::MESH_STREAMER::NOT_A_MESH " << path << std::endl;
+            return false;
+        }
+        file.close();
+        if (elementType == GL_UNSIGNED_SHORT && mesh.vertexCount() > 65536)
+        {
+            std::cout << "ERROR::MESH_STREAMER::TOO_MANY_VERTICES " << path << std::endl;
+            return false;
+        }
+
+        fitMesh(mesh);
+        if (optimizeMeshes)
+        {
+            optimizeVertexCache(mesh);
+            optimizeVertexFetch(mesh);
+        }
+        std::vector<MeshLod> lods;
+        if (buildLevels)
+            buildLods(mesh, lods);
+        item.lodCount = (int)lods.size();
+        for (int l = 0; l < item.lodCount; l++)
+            item.lods[l] = lods[l];
+
+        item.vertices = mesh.vertexCount();
+        item.indices = (int)mesh.indices.size();
+        item.radius = 0.0f;
+        for (int v = 0; v < mesh.vertexCount(); v++)
+        {
+            const float* p = &mesh.positions[v * 3];
+            item.radius = std::max(item.radius, std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+        }
+        vertexFormat.encodePositions(mesh.positions, vertexBytes);
+        packIndices(mesh.indices, elementType, indexBytes);
+        vertexData = &vertexBytes[0];
+        vertexSize = vertexBytes.size();
+        indexData = &indexBytes[0];
+        indexSize = indexBytes.size();
+    }
+
+    if (!context)
+    {
+        //one block for the render thread to upload: the vertices, then the indices
+        item.bytes = new std::vector<unsigned char>(vertexSize + indexSize);
+        memcpy(&(*item.bytes)[0], vertexData, vertexSize);
+        memcpy(&(*item.bytes)[vertexSize], indexData, indexSize);
+        item.seconds = glfwGetTime() - begin;
+        return true;
+    }
+
+    //plain buffers: the render thread only ever copies out of them
+    GLBuffer vertices, indices;
+    if (!vertices.create("streamed mesh vertices") || !indices.create("streamed mesh indices"))
+        return false;
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, vertices.get());
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexSize, vertexData, GL_STATIC_COPY);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, indices.get());
+    glBufferData(GL_COPY_WRITE_BUFFER, indexSize, indexData, GL_STATIC_COPY);
+    glState.bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    //without the flush the fence might sit in this context's command queue forever, and the render thread with it
+    item.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    item.vertexBuffer = vertices.release();
+    item.indexBuffer = indices.release();
+    item.seconds = glfwGetTime() - begin;
+    return true;
+}
+
+void MeshStreamer::loaderMain()
+{
+    if (context)
+    {
+        glfwMakeContextCurrent(context);
+        glState.makeCurrent();
+        glObjects.makeCurrent();
+        deletionQueue.makeCurrent();
+        if (glDebugOutputEnabled())
+            enableGLDebugOutput("upload", true);
+    }
+
+    for (int i = 0; i < (int)paths.size() && !stopping.load(); i++)
+    {
+        Loaded item;
+        if (!load(i, item))
+        {
+            failures.fetch_add(1);
+            continue;
+        }
+        //the queue has room for every file, so this only spins if the render thread stopped polling
+        bool pushed;
+        while (!(pushed = results.push(item)) && !stopping.load())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (!pushed)
+            discard(item);
+    }
+
+    if (context)
+    {
+        deletionQueue.flush(); //buffers of a failed upload
+        glObjects.reportLeaks();
+        glfwMakeContextCurrent(NULL);
+    }
+}
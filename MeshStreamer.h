@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "GLDeletionQueue.h"
+#include "GLObjects.h"
+#include "GLStateCache.h"
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "SpscQueue.h"
+#include "VertexFormat.h"
+
+class MeshArena;
+
+//MESH STREAMING
+//***********************************************************
+/*
+  Loading a mesh file on the render thread stalls a frame for as long as reading, parsing, optimizing and uploading take,
+  and loading everything before the first frame makes startup wait for the biggest file. The streamer does all of it
+  on a loader thread while the render loop keeps drawing the built-in placeholder meshes.
+
+  The loader memory-maps each file (MappedFile.h). A .mesh file (MeshFile.h) already holds the vertices and indices in
+  their final form and is uploaded straight out of the mapping; an OBJ file is parsed, optimized and encoded into the
+  arena's vertex format and index type first. Then it uploads it itself: GLFW can create a second context that shares its objects with the window's
+  (the last argument of glfwCreateWindow), and a context can be current on a thread of its own. Buffers created there
+  are visible to the render thread's context too. Vertex arrays are not shared, which is fine: the render thread only
+  copies the buffers into its MeshArena with glCopyBufferSubData (GPU to GPU) and deletes them.
+
+  Objects changed on one context are only guaranteed to be complete on the other once the commands that changed them
+  have finished, so every upload ends with a fence (flushed, or the GPU may never see it). The render thread picks a
+  mesh up in poll() only once its fence has signaled and never waits for one. Without a shared context (creating it
+  failed) the loader still does everything but the upload, and poll() uploads the finished data on the render thread.
+*/
+
+class MeshStreamer
+{
+public:
+    static const int MAX_FILES = 64;
+
+    MeshStreamer();
+    ~MeshStreamer();
+
+    //Render thread. files[i] replaces arena mesh id i once it's loaded. Uploads on uploadContext, which must share with
+    //the render context and not be current anywhere, or on the render thread when it is NULL. lods generates levels
+    //of detail for OBJ files (and keeps the ones .mesh files bring).
+    void start(GLFWwindow* uploadContext, const std::vector<const char*>& files, const VertexFormat& format,
+        GLenum indexType, bool optimize, bool lods, bool verbose);
+
+    //Render thread, once per frame: swaps in every mesh that is ready and grows radius to its bounding sphere. Returns
+    //how many meshes were replaced. Never blocks.
+    int poll(MeshArena& arena, float& radius);
+
+    //Render thread. Stops after the file being loaded and deletes what wasn't published.
+    void stop();
+
+    //Files not published (or failed) yet.
+    bool busy() const { return thread.joinable() && (int)(published + failures.load()) < (int)paths.size(); }
+    int publishedCount() const { return published; }
+    int failedCount() const { return failures.load(); }
+
+private:
+    MeshStreamer(const MeshStreamer&);
+    MeshStreamer& operator=(const MeshStreamer&);
+
+    //one finished file, loader -> render thread
+    struct Loaded
+    {
+        int mesh;                          //arena id it replaces
+        GLuint vertexBuffer;               //filled on the upload context, 0 without one
+        GLuint indexBuffer;
+        GLsync fence;                      //behind the upload
+        std::vector<unsigned char>* bytes; //without an upload context: the encoded vertices, then the indices
+        int vertices;
+        int indices;                       //of all levels together
+        MeshLod lods[MAX_MESH_LODS];
+        int lodCount;                      //0: all indices are LOD 0
+        float radius;
+        double seconds;                    //from starting to read the file to the end of the upload
+    };
+
+    void loaderMain();
+    bool load(int index, Loaded& item);
+    void discard(Loaded& item);
+
+    std::vector<const char*> paths;
+    GLFWwindow* context;
+    VertexFormat vertexFormat;
+    GLenum elementType;
+    bool optimizeMeshes;
+    bool buildLevels;
+    bool printProgress;
+    double startTime;
+
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<int> failures;
+    SpscQueue<Loaded, MAX_FILES * 2> results;
+    Loaded waiting; //popped, fence not signaled yet
+    bool hasWaiting;
+    int published;
+
+    //the loader thread's own per-context state, see GLStateCache.h / GLObjects.h
+    GLStateCache glState;
+    GLObjects glObjects;
+    GLDeletionQueue deletionQueue;
+};
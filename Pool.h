@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+
+//FIXED-SIZE POOL
+//***********************************************************
+/*
+  Storage for up to CAPACITY objects of one type, reserved up front inside the pool itself. acquire() pops a free slot
+  off a free list and release() pushes it back, both in constant time and without touching the heap, so objects can
+  come and go all frame long without the allocator (and its lock) ever being involved.
+
+  Slots keep their address for as long as they are acquired. The pool doesn't construct or destruct anything: T must
+  be a plain struct that the caller fills in after acquire().
+*/
+
+template <typename T, int CAPACITY>
+class Pool
+{
+public:
+    Pool()
+        : freeHead(0), live(0)
+    {
+        for (int i = 0; i < CAPACITY; i++)
+        {
+            nextFree[i] = i + 1 < CAPACITY ? i + 1 : -1;
+            used[i] = false;
+        }
+    }
+
+    //NULL when every slot is taken.
+    T* acquire()
+    {
+        if (freeHead < 0)
+            return NULL;
+        int slot = freeHead;
+        freeHead = nextFree[slot];
+        used[slot] = true;
+        live++;
+        return &items[slot];
+    }
+
+    void release(T* item)
+    {
+        int slot = (int)(item - items);
+        if (slot < 0 || slot >= CAPACITY || !used[slot])
+            return;
+        used[slot] = false;
+        nextFree[slot] = freeHead;
+        freeHead = slot;
+        live--;
+    }
+
+    int liveCount() const { return live; }
+    static int capacity() { return CAPACITY; }
+
+    //For walking the live objects: slot i holds one when inUse(i).
+    bool inUse(int slot) const { return used[slot]; }
+    T& at(int slot) { return items[slot]; }
+    const T& at(int slot) const { return items[slot]; }
+
+private:
+    T items[CAPACITY];
+    int nextFree[CAPACITY];
+    bool used[CAPACITY];
+    int freeHead;
+    int live;
+};
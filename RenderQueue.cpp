@@ -0,0 +1,138 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+#include "CommandList.h"
+#include "FrameArena.h"
+
+//below this many entries an insertion sort is faster than eight histograms
+static const size_t INSERTION_SORT_LIMIT = 64;
+
+static const uint64_t FIELD_MASK = (1u << 10) - 1;
+static const uint32_t DEPTH_MAX = (1u << 24) - 1;
+
+uint64_t makeSortKey(RenderPass pass, GLuint program, int material, GLuint vao, float depth)
+{
+    depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    uint32_t quantized = (uint32_t)(depth * (float)DEPTH_MAX);
+    if (pass != PASS_OPAQUE)
+        quantized = DEPTH_MAX - quantized; //blended draws have to go back to front to come out right
+    return ((uint64_t)pass << 62) | ((program & FIELD_MASK) << 52) | (((uint64_t)material & FIELD_MASK) << 42) |
+        ((vao & FIELD_MASK) << 32) | ((uint64_t)quantized << 8);
+}
+
+void radixSort(SortEntry* entries, SortEntry* scratch, size_t count)
+{
+    if (count < INSERTION_SORT_LIMIT)
+    {
+        for (size_t i = 1; i < count; i++)
+        {
+            SortEntry entry = entries[i];
+            size_t j = i;
+            for (; j > 0 && entries[j - 1].key > entry.key; j--)
+                entries[j] = entries[j - 1];
+            entries[j] = entry;
+        }
+        return;
+    }
+
+    //all eight histograms in one pass over the keys
+    size_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t key = entries[i].key;
+        for (int digit = 0; digit < 8; digit++)
+            histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+    }
+
+    SortEntry* from = entries;
+    SortEntry* to = scratch;
+    for (int digit = 0; digit < 8; digit++)
+    {
+        size_t* histogram = histograms[digit];
+        //every key has the same byte here, the pass wouldn't move anything
+        if (histogram[(from[0].key >> (digit * 8)) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++)
+        {
+            size_t size = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += size;
+        }
+        for (size_t i = 0; i < count; i++)
+            to[histogram[(from[i].key >> (digit * 8)) & 0xFF]++] = from[i];
+        SortEntry* swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != entries)
+        memcpy(entries, from, count * sizeof(SortEntry));
+}
+
+//counts what changes between previous (NULL for the first draw) and command
+static void countChange(const DrawCommand* previous, const DrawCommand& command, StateChanges& changes)
+{
+    if (!previous || previous->program != command.program)
+        changes.programs++;
+    if (!previous || previous->vao != command.vao)
+        changes.vertexArrays++;
+    if (!previous || previous->material != command.material)
+        changes.materials++;
+}
+
+RenderQueue::RenderQueue()
+{
+    memset(&sorted, 0, sizeof(sorted));
+    memset(&recorded, 0, sizeof(recorded));
+}
+
+size_t RenderQueue::merge(const std::vector<const CommandList*>& lists, FrameArena& arena, const DrawCommand** commands)
+{
+    memset(&sorted, 0, sizeof(sorted));
+    memset(&recorded, 0, sizeof(recorded));
+
+    const DrawCommand* previous = NULL;
+    for (size_t l = 0; l < lists.size(); l++)
+    {
+        const CommandList& list = *lists[l];
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            countChange(previous, list[i], recorded);
+            previous = &list[i];
+        }
+    }
+
+    //one cursor per list; there are only as many lists as workers, so the smallest head is simply searched for
+    size_t* cursors = arena.allocateArray<size_t>(lists.size());
+    for (size_t l = 0; l < lists.size(); l++)
+        cursors[l] = 0;
+    size_t count = 0;
+    previous = NULL;
+    for (;;)
+    {
+        size_t best = lists.size();
+        uint64_t bestKey = 0;
+        for (size_t l = 0; l < lists.size(); l++)
+        {
+            if (cursors[l] == lists[l]->size())
+                continue;
+            uint64_t key = lists[l]->sortedKey(cursors[l]);
+            if (best == lists.size() || key < bestKey) //strictly less: ties stay with the lower worker
+            {
+                best = l;
+                bestKey = key;
+            }
+        }
+        if (best == lists.size())
+            break;
+
+        const DrawCommand& command = lists[best]->sorted(cursors[best]++);
+        countChange(previous, command, sorted);
+        commands[count++] = &command;
+        previous = &command;
+    }
+    return count;
+}
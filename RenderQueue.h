@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CommandList;
+class FrameArena;
+struct DrawCommand;
+
+//RENDER QUEUE
+//***********************************************************
+/*
+  The order draws are submitted in decides how often the GL state between them changes: two draws with the same
+  program next to each other share one glUseProgram, the same two with another program in between need three. The
+  recorded order is whatever the workers happened to produce, so every DrawCommand carries a 64-bit sort key that puts
+  the expensive changes in the high bits:
+
+      63..62  pass          opaque, transparent, overlay: always in this order
+      61..52  program       the most expensive switch, so draws sharing one are sorted together first
+      51..42  material      which DrawUniforms (and, later, textures)
+      41..32  vertex array
+      31..8   depth         24 bits, front to back in the opaque pass (less overdraw), back to front otherwise
+       7..0   unused
+
+  The program and vertex array fields hold the low 10 bits of the GL name. Two objects that share them only sort
+  next to each other; replay still compares the real names, so that costs a state change, never a wrong draw.
+
+  Sorting is a least significant digit radix sort: eight passes over one byte of the key each, every pass a stable
+  counting sort. That is linear in the number of draws, and the passes over a byte every key shares (the unused bits,
+  the depth of a flat scene) are skipped after one histogram. Short lists (most of them) use an insertion sort instead,
+  which beats the histograms there.
+
+  It runs in parallel: every worker sorts its own CommandList before handing it back (CommandWorkers.h), and the
+  render thread only merges the sorted lists, ties going to the lower worker. That yields exactly what one stable sort
+  of all lists in worker order would, so instance ranges split across workers still end up next to each other and
+  merge back into one draw.
+*/
+
+enum RenderPass
+{
+    PASS_OPAQUE,
+    PASS_TRANSPARENT,
+    PASS_OVERLAY
+};
+
+//depth 0 is the near plane and 1 the far one; values outside are clamped
+uint64_t makeSortKey(RenderPass pass, GLuint program, int material, GLuint vao, float depth);
+
+struct SortEntry
+{
+    uint64_t key;
+    uint32_t index; //of the command in its list
+    uint32_t unused;
+};
+
+//Sorts count entries by key, keeping the order of equal keys. scratch needs room for count entries too.
+void radixSort(SortEntry* entries, SortEntry* scratch, size_t count);
+
+//How often the state changed from one draw to the next, the first draw's binds included.
+struct StateChanges
+{
+    int programs;
+    int vertexArrays;
+    int materials;
+
+    int total() const { return programs + vertexArrays + materials; }
+};
+
+class RenderQueue
+{
+public:
+    RenderQueue();
+
+    //Merges the sorted lists into commands, which needs room for every command of every list; returns how many there
+    //were. Render thread; the merge cursors come from arena.
+    size_t merge(const std::vector<const CommandList*>& lists, FrameArena& arena, const DrawCommand** commands);
+
+    //Of the last merge(), in sorted order and in the order the commands were recorded in.
+    const StateChanges& sortedChanges() const { return sorted; }
+    const StateChanges& recordedChanges() const { return recorded; }
+
+private:
+    StateChanges sorted;
+    StateChanges recorded;
+};
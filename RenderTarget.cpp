@@ -0,0 +1,128 @@
+#include "RenderTarget.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+const int RenderTarget::ALLOCATION_STEP;
+const double RenderTarget::RESIZE_DEBOUNCE = 0.2;
+const float RenderTarget::MIN_SCALE = 0.25f;
+
+static int roundUpToStep(int size)
+{
+    return (std::max(1, size) + RenderTarget::ALLOCATION_STEP - 1) / RenderTarget::ALLOCATION_STEP *
+        RenderTarget::ALLOCATION_STEP;
+}
+
+RenderTarget::RenderTarget()
+    : capacityWidth(0), capacityHeight(0), windowWidth(1), windowHeight(1), renderWidth(1), renderHeight(1),
+      renderScale(1.0f), resizeTime(0.0), allocations(0)
+{
+}
+
+bool RenderTarget::init(int width, int height)
+{
+    windowWidth = std::max(1, width);
+    windowHeight = std::max(1, height);
+    if (!framebuffer.create("render target framebuffer") || !allocate(windowWidth, windowHeight))
+    {
+        shutdown();
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::shutdown()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    color.reset();
+    framebuffer.reset();
+    capacityWidth = capacityHeight = 0;
+}
+
+bool RenderTarget::allocate(int width, int height)
+{
+    int newWidth = roundUpToStep(width);
+    int newHeight = roundUpToStep(height);
+
+    //a new texture rather than glTexImage2D on the old one: frames in flight may still read the old one
+    GLTexture texture;
+    if (!texture.create("render target color"))
+        return false;
+    GLStateCache::current().bindTexture(0, GL_TEXTURE_2D, texture.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, newWidth, newHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.get(), 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::RENDER_TARGET::INCOMPLETE 0x" << std::hex << status << std::dec << " at " << newWidth << "x"
+            << newHeight << std::endl;
+        return false;
+    }
+
+    color = std::move(texture);
+    capacityWidth = newWidth;
+    capacityHeight = newHeight;
+    allocations++;
+    updateRenderSize();
+    return true;
+}
+
+void RenderTarget::resize(int width, int height, double time)
+{
+    windowWidth = std::max(1, width);
+    windowHeight = std::max(1, height);
+    resizeTime = time;
+    updateRenderSize(); //stretched from what fits into the old texture until the debounce is over
+}
+
+void RenderTarget::setScale(float scale)
+{
+    renderScale = std::min(1.0f, std::max(MIN_SCALE, scale));
+    updateRenderSize();
+}
+
+void RenderTarget::updateRenderSize()
+{
+    renderWidth = std::max(1, std::min(capacityWidth, (int)std::ceil(windowWidth * renderScale)));
+    renderHeight = std::max(1, std::min(capacityHeight, (int)std::ceil(windowHeight * renderScale)));
+}
+
+double RenderTarget::resizeDueTime() const
+{
+    return resizeTime > 0.0 ? resizeTime + RESIZE_DEBOUNCE : 0.0;
+}
+
+void RenderTarget::begin(double time)
+{
+    if (resizeTime > 0.0 && time >= resizeTime + RESIZE_DEBOUNCE)
+    {
+        resizeTime = 0.0;
+        //grow when the window doesn't fit anymore, shrink only when less than half of the texture would be used
+        bool grow = windowWidth > capacityWidth || windowHeight > capacityHeight;
+        bool shrink = roundUpToStep(windowWidth) * roundUpToStep(windowHeight) * 2 < capacityWidth * capacityHeight;
+        if ((grow || shrink) && !allocate(windowWidth, windowHeight))
+            std::cout << "WARNING::RENDER_TARGET::RESIZE_FAILED keeping " << capacityWidth << "x" << capacityHeight
+                << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glViewport(0, 0, renderWidth, renderHeight);
+}
+
+void RenderTarget::resolve()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.get());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    //linear even at 1:1, where it samples the texel centers and changes nothing: switching the filter with the scale
+    //can make the driver build another blit shader in the middle of the frame
+    glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLResource.h"
+
+//OFFSCREEN RENDER TARGET
+//***********************************************************
+/*
+  Normally everything is drawn straight into the default framebuffer at the window's resolution. On a 4K or retina
+  display that is a lot of pixels for every clear and every triangle, and a fill-rate bound frame gets slower with each
+  one. A render target is a framebuffer object we draw into instead: a color texture attached to GL_COLOR_ATTACHMENT0.
+  It can be smaller than the window, and at the end of the frame glBlitFramebuffer stretches it over the default
+  framebuffer with bilinear filtering. Fewer pixels shaded, one full-window copy to pay for it.
+
+  The texture is allocated at the full window size (rounded up to ALLOCATION_STEP), so changing the render scale only
+  changes the viewport and which part of the texture is blitted, never an allocation. Resizing the window does
+  reallocate, but not on every size event: while the user drags the window edge, the old texture is simply stretched
+  to the new window size, and the texture is only replaced once the size stayed the same for RESIZE_DEBOUNCE seconds
+  (and the window actually outgrew it, or shrank well below it). The old texture goes through the deletion queue like
+  every other GL object, so frames still in flight keep reading it.
+*/
+
+class RenderTarget
+{
+public:
+    static const int ALLOCATION_STEP = 64;    //texture sizes are rounded up to this, in pixels
+    static const double RESIZE_DEBOUNCE;      //seconds a new window size has to hold before the texture is replaced
+    static const float MIN_SCALE;
+
+    RenderTarget();
+
+    //Allocates the texture for a window of width x height. Needs the context current. Returns false if the driver
+    //can't render to it (the caller then draws to the window directly).
+    bool init(int width, int height);
+    void shutdown();
+
+    //The window's framebuffer has a new size. time is glfwGetTime(), for the debounce.
+    void resize(int width, int height, double time);
+
+    //Fraction of the window size rendered, clamped to [MIN_SCALE, 1].
+    void setScale(float scale);
+    float scale() const { return renderScale; }
+
+    //Start of the frame: replaces the texture if a resize settled, binds the framebuffer and sets the viewport to the
+    //render size.
+    void begin(double time);
+
+    //End of the frame: blits the render size into the whole window and leaves the default framebuffer bound.
+    void resolve();
+
+    //glfwGetTime() when begin() will reallocate for the last resize, 0 when no resize is waiting.
+    double resizeDueTime() const;
+
+    int width() const { return renderWidth; }
+    int height() const { return renderHeight; }
+    int reallocations() const { return allocations; }
+
+private:
+    RenderTarget(const RenderTarget&);
+    RenderTarget& operator=(const RenderTarget&);
+
+    bool allocate(int width, int height);
+    void updateRenderSize();
+
+    GLFramebuffer framebuffer;
+    GLTexture color;
+    int capacityWidth;  //size of the texture
+    int capacityHeight;
+    int windowWidth;    //size of the default framebuffer, what resolve() blits to
+    int windowHeight;
+    int renderWidth;    //window size times the scale, at most the capacity
+    int renderHeight;
+    float renderScale;
+    double resizeTime;  //when the window got its current size, 0 once the texture was checked against it
+    int allocations;
+};
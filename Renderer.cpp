@@ -0,0 +1,1242 @@
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "FrameProfiler.h"
+#include "Frustum.h"
+#include "GLDebug.h"
+#include "GLExtensions.h"
+#include "GLLoader.h"
+#include "GLStateCache.h"
+#include "IndirectDrawBatch.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
+#include "ShaderCache.h"
+#include "StartupTimer.h"
+#include "UniformBlocks.h"
+#include "VertexFormat.h"
+
+//below this many instances a single worker records everything; splitting tiny ranges costs more than it saves
+static const int MIN_INSTANCES_PER_WORKER = 4096;
+
+//--idle: while nothing changes the render thread still wakes this often to pick up saved shader files
+static const double IDLE_TIMEOUT = 0.25;
+
+//pan key speed in world units per second at zoom 1, half the visible width
+static const float PAN_SPEED = 1.0f;
+
+//--dynamic-res never goes below this, blurrier than that isn't worth the frame rate
+static const float DYNAMIC_MIN_SCALE = 0.5f;
+
+//frames that may still allocate (first uploads, shaders finishing, buffers growing) before the loop should be steady
+static const unsigned long long WARMUP_FRAMES = 10;
+
+//Vertex and fragment shader code
+//----------------------------------------
+//The sources are read from <--shader-dir>/<name>.vert and .frag and reloaded when they are saved (see ShaderWatcher.h).
+//The copies below are only used when a file isn't there; keep them the same as the files.
+static const char* vertexShaderSource =
+"layout (location = 0) in vec3 aPos;\n"
+"void main()\n"
+"{\n"
+"   gl_Position = vec4(aPos.xy * uScale + uOffset, aPos.z, 1.0);\n"
+"}\0";
+
+static const char* fragmentShaderSource =
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+"   FragColor = uColor;\n"
+"}\n\0";
+
+static const char* instancedVertexShaderSource =
+"layout (location = 0) in vec3 aPos;\n"
+"layout (location = 1) in vec4 aTransform;\n" //xy = offset, z = scale, w = rotation
+"layout (location = 2) in vec4 aColor;\n"
+"out vec4 vColor;\n"
+"out vec2 vUV;\n"
+"void main()\n"
+"{\n"
+"   float c = cos(aTransform.w);\n"
+"   float s = sin(aTransform.w);\n"
+"   vec2 p = mat2(c, s, -s, c) * aPos.xy * aTransform.z + aTransform.xy;\n"
+"   p = p * uScale + uOffset;\n"
+"   gl_Position = vec4((p - uPan) * uZoom, aPos.z, 1.0);\n"
+"   vColor = aColor * uColor;\n"
+"   vUV = aPos.xy + 0.5;\n" //no texture coordinates in the meshes, projected from the front
+"}\0";
+
+static const char* instancedFragmentShaderSource =
+"in vec4 vColor;\n"
+"in vec2 vUV;\n"
+"uniform sampler2DArray uTexture;\n" //unit 0, see TextureManager.h
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+"   vec2 texel = vUV * vec2(textureSize(uTexture, 0).xy);\n"
+"   vec2 dx = dFdx(texel);\n"
+"   vec2 dy = dFdy(texel);\n"
+"   float lod = max(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), uTextureMinLod);\n" //only the uploaded levels
+"   FragColor = vColor;\n"
+"   if (uTextureLayer >= 0)\n"
+"      FragColor *= textureLod(uTexture, vec3(vUV, float(uTextureLayer)), lod);\n"
+"}\n\0";
+
+//Goes in front of every file: the uniform blocks only exist here so they can't drift from UniformBlocks.h. #line 1
+//makes the compiler's line numbers match the file again.
+static const char* shaderPreamble = "#version 330 core\n"
+FRAME_UNIFORMS_GLSL
+DRAW_UNIFORMS_GLSL
+"#line 1\n";
+
+struct ShaderFiles
+{
+    const char* name; //also the file name, without the extension
+    const char* vertexSource;
+    const char* fragmentSource;
+};
+
+//in ShaderId order
+static const ShaderFiles shaderFiles[SHADER_COUNT] = {
+    { "basic", vertexShaderSource, fragmentShaderSource },
+    { "instanced", instancedVertexShaderSource, instancedFragmentShaderSource }
+};
+//----------------------------------------
+
+//What DrawCommand::material picks. The instanced material keeps the identity transform: the culling in Frustum.h
+//tests the instances where the instance data puts them.
+enum Material
+{
+    MATERIAL_BASIC,
+    MATERIAL_INSTANCED
+};
+
+static const DrawUniforms materials[] = {
+    { { 1.0f, 0.5f, 0.2f, 1.0f }, { 0.0f, 0.0f }, 1.0f }, //the tutorial's orange
+    { { 1.0f, 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f }, 1.0f }  //instance colors as they are
+};
+
+Renderer::Renderer(GLFWwindow* renderWindow, const AppOptions& appOptions, GLFWwindow* uploadContext)
+    : window(renderWindow), options(appOptions), quit(false), done(false), result(0), titleChanged(false),
+      shaderBatch(NULL), frameInputTime(0.0), dirty(true), skippedFrames(0), offscreen(false), resolutionSamples(0),
+      benchmark(NULL), shaderStart(0.0), uploadWindow(uploadContext), instanced(false),
+      cpuCull(false), meshRadius(0.0f), shownTexture(0), merged(NULL), mergedCount(0), indirectSlots(NULL), drawBlocks(NULL),
+      basicProgram(0), instancedProgram(0), frameInstanceCount(0), frameInstanceBuffer(0), frameInstanceBase(0),
+      frameDrawCalls(0), frameInstancesSubmitted(0), frameTrianglesSubmitted(0), panX(0.0f), panY(0.0f), zoom(appOptions.zoom), panDirectionX(0),
+      panDirectionY(0), panTime(0.0), viewportWidth(1), viewportHeight(1), boundInstanceBuffer(0),
+      boundInstanceBase(0), boundFirstInstance(0)
+{
+    title[0] = '\0';
+    sleeping.store(false);
+
+    //main thread only, so not on the render thread
+    glfwGetFramebufferSize(window, &viewportWidth, &viewportHeight);
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (videoMode)
+        pacer.setRefreshRate(videoMode->refreshRate);
+}
+
+Renderer::~Renderer()
+{
+    stop();
+}
+
+bool Renderer::addWindow(GLFWwindow* extraWindow)
+{
+    int width, height;
+    glfwGetFramebufferSize(extraWindow, &width, &height);
+    return presenter.addWindow(extraWindow, width, height);
+}
+
+void Renderer::resizeWindow(GLFWwindow* extraWindow, int width, int height)
+{
+    presenter.resize(extraWindow, width, height);
+}
+
+void Renderer::start()
+{
+    //a context can only be current on one thread at a time
+    glfwMakeContextCurrent(NULL);
+    thread = std::thread(&Renderer::threadMain, this);
+}
+
+void Renderer::stop()
+{
+    quit.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+    if (thread.joinable())
+        thread.join();
+}
+
+void Renderer::postEvent(RenderEvent::Type type, int a, int b)
+{
+    if (!tryPostEvent(type, a, b))
+        std::cout << "WARNING::RENDERER::EVENT_QUEUE_FULL" << std::endl;
+}
+
+bool Renderer::tryPostEvent(RenderEvent::Type type, int a, int b)
+{
+    RenderEvent event = { type, a, b, glfwGetTime() };
+    if (!events.push(event))
+        return false;
+
+    //the render thread sets sleeping before it looks at the queue a last time, so either it sees this event or we see
+    //it sleeping and wake it (the fences keep the queue store and the flag load from passing each other)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load())
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+    return true;
+}
+
+bool Renderer::takeTitle(char* buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(titleMutex);
+    if (!titleChanged)
+        return false;
+    snprintf(buffer, size, "%s", title);
+    titleChanged = false;
+    return true;
+}
+
+void Renderer::publishTitle(const char* text)
+{
+    {
+        std::lock_guard<std::mutex> lock(titleMutex);
+        snprintf(title, sizeof(title), "%s", text);
+        titleChanged = true;
+    }
+    glfwPostEmptyEvent(); //the event thread sleeps in glfwWaitEvents until something happens
+}
+
+void Renderer::threadMain()
+{
+    glfwMakeContextCurrent(window); //the context lives on this thread from now on
+    startupTimer.mark("render thread start");
+
+    if (setup())
+        renderLoop();
+    else
+        result = -1;
+    cleanup();
+
+    glfwMakeContextCurrent(NULL);
+    done.store(true, std::memory_order_release);
+    glfwPostEmptyEvent(); //wake the event thread so it sees we are done
+}
+
+// ------------------------------------
+//Everything that used to sit between glfwMakeContextCurrent and the render loop in main(). It runs here because GL
+//objects can only be created on the thread that has the context current.
+// ------------------------------------
+
+bool Renderer::setup()
+{
+    // glad: load all OpenGL function pointers
+    //----------------------------------------
+    //all of them now, or each one on its first call with --lazy-gl (see GLLoader.h)
+    if (!loadGLFunctions((GLADloadproc)glfwGetProcAddress, options.lazyGL))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    startupTimer.mark("GL functions");
+    loadGLExtensions(lookupGLFunction); //anything newer than 3.3 that the driver offers
+    startupTimer.mark("GL extensions");
+    if (options.glDebug)
+    {
+        if (!glext.debug)
+            std::cout << "WARNING::GL_DEBUG::NO_KHR_DEBUG no debug output" << std::endl;
+        else if (!glext.debugContext)
+            std::cout << "WARNING::GL_DEBUG::NO_DEBUG_CONTEXT the driver may report less" << std::endl;
+        enableGLDebugOutput("render", true);
+    }
+
+    //Every bind below goes through the state cache so it can skip the ones that wouldn't change anything
+    glState.makeCurrent();
+    glObjects.makeCurrent();
+    deletionQueue.makeCurrent();
+    frameArena.init();
+    //----------------------------------------
+
+
+    // shaders
+    // ------------------------------------
+    //Linked programs are cached on disk as driver binaries, so later launches skip glCompileShader/glLinkProgram
+    shaderStart = glfwGetTime();
+    if (options.useShaderCache)
+        shaderCache.init("shader_cache");
+    ShaderCache* cache = shaderCache.enabled() ? &shaderCache : NULL;
+
+    //Everything is submitted at once and finished in the background while the render loop already runs; until a
+    //program is ready its draws are skipped and the frame is just cleared.
+    shaderBatch = new ShaderBatch(cache);
+    for (int i = 0; i < SHADER_COUNT; i++)
+    {
+        ShaderSlot& slot = shaderSlots[i];
+        std::string path = std::string(options.shaderDirectory) + "/" + shaderFiles[i].name;
+        slot.vertexFile = shaderWatcher.watch(path + ".vert");
+        slot.fragmentFile = shaderWatcher.watch(path + ".frag");
+        if (slot.vertexFile < 0)
+            std::cout << "WARNING::SHADER::FILE_NOT_FOUND " << path << ".vert, using the built-in source" << std::endl;
+        if (slot.fragmentFile < 0)
+            std::cout << "WARNING::SHADER::FILE_NOT_FOUND " << path << ".frag, using the built-in source" << std::endl;
+        std::string vertexSource = shaderSource(slot.vertexFile, shaderFiles[i].vertexSource);
+        std::string fragmentSource = shaderSource(slot.fragmentFile, shaderFiles[i].fragmentSource);
+        slot.id = shaderBatch->add(shaderFiles[i].name, vertexSource.c_str(), fragmentSource.c_str());
+    }
+    shaderBatch->submit();
+
+    //saving one of the files recompiles its program in the background, see reloadShaders()
+    if (options.hotReload && !options.benchmark)
+        shaderWatcher.start();
+    if (!options.benchmark) //benchmark output stays pure CSV
+        std::cout << "Shaders submitted in " << (glfwGetTime() - shaderStart) * 1000.0 << " ms" << std::endl;
+    startupTimer.mark("shader submission");
+    // ------------------------------------
+
+
+    // load the meshes
+    // ------------------------------------------------------------------
+    //The tutorial triangle by default, or a tessellated grid that actually shares vertices (--grid). --meshes adds
+    //polygons with more and more sides, so the scene has different meshes to batch. --mesh files replace them once
+    //they are loaded, see the streamer below.
+    std::vector<MeshData> meshes;
+    meshes.push_back(options.gridCells > 0 ? makeGridMesh(options.gridCells) : makeTriangleMesh());
+    for (int i = 1; i < options.meshCount; i++)
+        meshes.push_back(makeDiscMesh(4 + 2 * i));
+
+    int largestMesh = 0;
+    std::vector<std::vector<MeshLod> > meshLods(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        if (options.optimizeMesh)
+        {
+            float acmrBefore = averageCacheMissRatio(meshes[i]);
+            optimizeVertexCache(meshes[i]);
+            optimizeVertexFetch(meshes[i]);
+            if (!options.benchmark && i == 0 && options.gridCells > 0)
+                std::cout << "Mesh: " << meshes[i].triangleCount() << " triangles, " << meshes[i].vertexCount() << " vertices, ACMR "
+                    << acmrBefore << " -> " << averageCacheMissRatio(meshes[i]) << std::endl;
+        }
+        //--lod: the simplified levels go behind the full mesh's indices, see MeshSimplifier.h
+        if (options.lod)
+        {
+            buildLods(meshes[i], meshLods[i]);
+            if (!options.benchmark && i == 0 && meshLods[i].size() > 1)
+            {
+                std::cout << "LODs:";
+                for (size_t l = 0; l < meshLods[i].size(); l++)
+                    std::cout << " " << meshLods[i][l].indexCount / 3 << (l + 1 < meshLods[i].size() ? " ->" : "");
+                std::cout << " triangles" << std::endl;
+            }
+        }
+        largestMesh = std::max(largestMesh, meshes[i].vertexCount());
+        for (int v = 0; v < meshes[i].vertexCount(); v++)
+        {
+            const float* p = &meshes[i].positions[v * 3];
+            meshRadius = std::max(meshRadius, std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+        }
+    }
+
+    //Positions are stored in the compact type picked with --vertex-format and expanded back to floats by the vertex fetch
+    VertexFormat meshFormat;
+    meshFormat.add(0, 3, options.positionType);
+    if (!options.benchmark && options.positionType != VertexFormat::TYPE_FLOAT)
+        std::cout << "Vertex format: " << VertexFormat::typeName(options.positionType) << " positions, "
+            << meshFormat.stride() << " bytes per vertex" << std::endl;
+    startupTimer.mark("mesh building");
+    // ------------------------------------------------------------------
+
+    //Every mesh goes into one shared VBO/EBO pair behind a single VAO, see MeshArena.h
+    // ------------------------------------
+    //a streamed file can have any number of vertices, so it needs 32-bit indices
+    arena.init(meshFormat, options.meshFiles.empty() ? indexTypeFor(largestMesh) : GL_UNSIGNED_INT);
+    for (size_t i = 0; i < meshes.size(); i++)
+        arena.addMesh(meshes[i], meshLods[i]);
+    startupTimer.mark("mesh upload");
+    // ------------------------------------
+
+    // mesh streaming
+    // ------------------------------------
+    //the loader thread reads, optimizes and uploads the files on its own context while the placeholders are drawn
+    if (!options.meshFiles.empty())
+    {
+        if (!uploadWindow)
+            std::cout << "WARNING::MESH_STREAMER::NO_SHARED_CONTEXT uploading on the render thread" << std::endl;
+        streamer.start(uploadWindow, options.meshFiles, arena.format(), arena.indexType(), options.optimizeMesh,
+            options.lod, !options.benchmark);
+    }
+    // ------------------------------------
+
+    //Instanced mode
+    // ------------------------------------
+    //Adds a per-instance VBO to the same VAO. UP/DOWN change the count at runtime.
+    instanced = options.instanceCount > 0 || options.animate || options.benchmark;
+    if (instanced)
+    {
+        //frustum culling in a compute shader, feeding its own indirect commands. Without compute shaders the workers
+        //cull on the CPU instead (--cpu-cull asks for that directly).
+        if (options.gpuCull)
+        {
+            if (culler.init())
+            {
+                if (!options.benchmark)
+                    std::cout << "Culling instances on the GPU" << std::endl;
+            }
+            else
+            {
+                culler.shutdown();
+                std::cout << "WARNING::CULLING::COMPUTE_UNAVAILABLE falling back to CPU culling" << std::endl;
+            }
+        }
+        cpuCull = !culler.enabled() && (options.cpuCull || options.gpuCull);
+        if (cpuCull && !options.benchmark)
+            std::cout << "Culling instances on the CPU" << std::endl;
+
+        //CPU culling writes only the visible instances, so the instance data has to be streamed every frame
+        batch.init(arena.vao());
+        batch.setCount(options.instanceCount);
+        batch.setAnimated(options.animate || cpuCull, options.forceMapRange);
+        if (batch.animated() && !options.benchmark)
+            std::cout << "Streaming instance data (" << StreamBuffer::modeName(batch.streamBuffer().mode()) << ")" << std::endl;
+
+        //all meshes of the frame in one glMultiDrawElementsIndirect where available
+        indirect.init(options.forceLoopDraws);
+        if (!options.benchmark)
+            std::cout << "Submitting draws " << (indirect.multiDraw() ? "with glMultiDrawElementsIndirect" : "in a CPU loop") << std::endl;
+    }
+    // ------------------------------------
+
+    // textures
+    // ------------------------------------
+    //allocated here, their levels are streamed in from the first frame on, see TextureManager.h
+    if (!options.textureFiles.empty())
+    {
+        if (textures.init(options.textureFiles, options.forceMapRange, !options.benchmark) && !instanced)
+            std::cout << "WARNING::TEXTURE::NOT_INSTANCED textures only show on instanced draws (--instances)" << std::endl;
+    }
+    // ------------------------------------
+
+    // frame profiler
+    // ------------------------------------
+    //Times every phase of the loop below on the CPU and GPU. The rolling stats are shown in the window title twice a second.
+    if (!profiler.init())
+        std::cout << "WARNING::PROFILER::GPU_QUERIES_UNAVAILABLE" << std::endl;
+    if (options.csvPath && !profiler.openCsv(options.csvPath))
+        std::cout << "WARNING::PROFILER::CANNOT_OPEN_CSV " << options.csvPath << std::endl;
+    // ------------------------------------
+
+    // command recording workers
+    // ------------------------------------
+    workers.start(options.workerCount, this);
+    if (!options.benchmark)
+        std::cout << "Recording on " << workers.count() << " worker threads" << std::endl;
+    // ------------------------------------
+
+    // uniform blocks
+    // ------------------------------------
+    //one FrameUniforms plus a DrawUniforms for every command the workers can record: one per mesh, level of detail and
+    //worker at most
+    int lodsPerMesh = options.lod ? MAX_MESH_LODS : 1;
+    if (!uniforms.init(sizeof(DrawUniforms), 1 + arena.meshCount() * lodsPerMesh * workers.count() + 1,
+        options.forceMapRange))
+    {
+        std::cout << "ERROR::UNIFORMS::BUFFER_CREATION_FAILED" << std::endl;
+        return false;
+    }
+    // ------------------------------------
+
+    // frame pacing
+    // ------------------------------------
+    //the benchmark measures how fast frames can go, so it never waits for the display
+    pacer.setMode(options.benchmark ? FramePacer::MODE_UNCAPPED : options.pacing, options.targetFps);
+    if (!options.benchmark)
+        std::cout << "Frame pacing: " << FramePacer::modeName(pacer.mode()) << std::endl;
+    // ------------------------------------
+
+    // offscreen render target
+    // ------------------------------------
+    //only when asked for: at full size the blit would just cost time
+    if (options.renderScale < 1.0f || options.dynamicResolution)
+    {
+        offscreen = renderTarget.init(viewportWidth, viewportHeight);
+        if (offscreen)
+        {
+            resolution.setRange(std::min(DYNAMIC_MIN_SCALE, options.renderScale), options.renderScale);
+            renderTarget.setScale(options.renderScale);
+            if (!options.benchmark)
+                std::cout << "Rendering offscreen at " << renderTarget.width() << "x" << renderTarget.height()
+                    << (options.dynamicResolution ? ", scaled dynamically" : "") << std::endl;
+        }
+        else
+            std::cout << "WARNING::RENDER_TARGET::UNAVAILABLE drawing to the window" << std::endl;
+    }
+    // ------------------------------------
+
+    // frame capture
+    // ------------------------------------
+    if (options.capturePrefix && capture.init(options.capturePrefix, options.captureEvery) && !options.benchmark)
+        std::cout << "Capturing to " << options.capturePrefix << "<frame>.ppm" << std::endl;
+    // ------------------------------------
+
+    // the other windows
+    // ------------------------------------
+    //drawn once here, shown in every window by a thread of its own (see WindowPresenter.h)
+    if (presenter.windowCount() > 0 && presenter.start() && !options.benchmark)
+        std::cout << "Presenting in " << presenter.windowCount() + 1 << " windows" << std::endl;
+    // ------------------------------------
+
+    // benchmark mode
+    // ------------------------------------
+    //vsync off and a fixed sweep of instance counts; the loop below exits by itself once every size was measured
+    if (options.benchmark)
+    {
+        shaderBatch->finish(); //compile time isn't what we are measuring
+        benchmark = new Benchmark(options.sweep, options.warmupFrames, options.measuredFrames);
+        benchmark->begin(options.animate ? "instanced-streamed" : "instanced-static");
+    }
+    // ------------------------------------
+
+    startupTimer.mark("buffers, workers and the rest of setup");
+    return true;
+}
+
+void Renderer::applyEvents()
+{
+    RenderEvent event;
+    while (events.pop(event))
+    {
+        dirty = true; //every event changes what is on screen, except a pacing change (which is shown in the title)
+        //a resize isn't something the user waits to see the result of
+        if (event.type != RenderEvent::RESIZE && (frameInputTime == 0.0 || event.time < frameInputTime))
+            frameInputTime = event.time;
+
+        switch (event.type)
+        {
+        case RenderEvent::RESIZE:
+            //Set the size of the rendering window.
+            // make sure the viewport matches the new window dimensions; note that width and
+            // height will be significantly larger than specified on retina displays.
+            //First 2 parameters set the location of the lower left corner of the window
+            //The 3rd and 4th set the width and height of the rendering window in pixels
+            //Offscreen, the render target sets the viewport to its own size every frame.
+            if (offscreen)
+                renderTarget.resize(event.a, event.b, event.time);
+            else
+                glViewport(0, 0, event.a, event.b);
+            viewportWidth = std::max(1, event.a);
+            viewportHeight = std::max(1, event.b);
+            break;
+        case RenderEvent::MORE_INSTANCES:
+            if (instanced && !options.benchmark)
+                batch.setCount(batch.count() * 10);
+            break;
+        case RenderEvent::FEWER_INSTANCES:
+            if (instanced && !options.benchmark)
+                batch.setCount(batch.count() / 10);
+            break;
+        case RenderEvent::ZOOM_IN:
+            zoom *= 1.25f;
+            break;
+        case RenderEvent::ZOOM_OUT:
+            zoom /= 1.25f;
+            break;
+        case RenderEvent::PAN_KEYS:
+            //everything up to the key change still moves in the old direction
+            advancePan(event.time);
+            panDirectionX = event.a;
+            panDirectionY = event.b;
+            break;
+        case RenderEvent::DRAG:
+            //the visible area is 2 / zoom wide and high, the content follows the cursor
+            panX -= event.a * 2.0f / (zoom * viewportWidth);
+            panY += event.b * 2.0f / (zoom * viewportHeight);
+            break;
+        case RenderEvent::REDRAW:
+            break;
+        case RenderEvent::CYCLE_TEXTURE:
+            if (textures.count() > 0)
+            {
+                shownTexture = (shownTexture + 1) % textures.count();
+                std::cout << "Texture: " << textures.path(shownTexture) << std::endl;
+            }
+            break;
+        case RenderEvent::CYCLE_PACING:
+            if (!options.benchmark)
+            {
+                pacer.setMode(pacer.nextMode(), options.targetFps);
+                std::cout << "Frame pacing: " << FramePacer::modeName(pacer.mode()) << std::endl;
+            }
+            break;
+        }
+    }
+}
+
+void Renderer::advancePan(double time)
+{
+    //the pan follows the time the keys were actually held, not how many frames happened to see them
+    if (panDirectionX || panDirectionY)
+    {
+        float distance = (float)(time - panTime) * PAN_SPEED / zoom;
+        panX += panDirectionX * distance;
+        panY += panDirectionY * distance;
+    }
+    panTime = time;
+}
+
+bool Renderer::animating() const
+{
+    return options.animate || options.benchmark || panDirectionX || panDirectionY;
+}
+
+void Renderer::waitForRedraw()
+{
+    ShaderBatch& shaders = *shaderBatch;
+    double idleStart = glfwGetTime();
+    for (;;)
+    {
+        applyEvents();
+        reloadShaders();
+        shaders.poll();
+        //a program that finished compiling, or a reloaded one, changes the picture too
+        if (shaders.program(shaderSlots[SHADER_BASIC].id) != basicProgram ||
+            shaders.program(shaderSlots[SHADER_INSTANCED].id) != instancedProgram)
+            dirty = true;
+        //so is the sharp render target replacing the stretched one once a resize settled
+        double resizeDue = offscreen ? renderTarget.resizeDueTime() : 0.0;
+        if (resizeDue > 0.0 && glfwGetTime() >= resizeDue)
+            dirty = true;
+        //the last frame's capture still has to reach the writer
+        capture.update();
+        if (pollStreamer())
+            dirty = true;
+        //the levels still to come are uploaded by the frames, so they have to keep coming until the last one
+        if (textures.streaming())
+            dirty = true;
+        if (dirty || animating() || quit.load(std::memory_order_acquire))
+            break;
+
+        //a compile in flight is checked every frame, otherwise only the shader files need a look now and then
+        bool working = shaders.pendingCount() > 0 || capture.busy() || streamer.busy();
+        double timeout = working ? pacer.framePeriod() : IDLE_TIMEOUT;
+        if (resizeDue > 0.0)
+            timeout = std::min(timeout, resizeDue - glfwGetTime());
+        waitForEvents(timeout);
+    }
+
+    //what the display showed again instead of a new frame; the waits inside a frame period don't count
+    skippedFrames += (unsigned long long)((glfwGetTime() - idleStart) / pacer.framePeriod());
+}
+
+void Renderer::waitForEvents(double timeout)
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    sleeping.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (events.empty() && !quit.load(std::memory_order_acquire))
+        wake.wait_for(lock, std::chrono::duration<double>(timeout));
+    sleeping.store(false);
+}
+
+void Renderer::renderLoop()
+{
+    ShaderBatch& shaders = *shaderBatch;
+    bool shadersPending = true;
+    unsigned long long frame = 0;
+
+    double lastTitleUpdate = glfwGetTime();
+    int skippedStateCounter = profiler.addCounter("state_calls_skipped");
+    int issuedStateCounter = profiler.addCounter("state_calls_issued");
+    int drawCallCounter = profiler.addCounter("draw_calls");
+    int instanceCounter = profiler.addCounter("instances_submitted"); //after CPU culling; GPU culling happens later
+    int triangleCounter = profiler.addCounter("triangles_submitted"); //after CPU culling and LOD selection
+    int allocationCounter = profiler.addCounter("heap_allocs"); //operator new calls since the last frame, all threads
+    int arenaCounter = profiler.addCounter("frame_arena_bytes");
+    int latencyCounter = profiler.addCounter("input_latency_ms"); //0 on frames without input
+    int debugCounter = profiler.addCounter("gl_debug_messages"); //with --gl-debug, every context
+    //program, VAO and material switches in the sorted submission order, and their sum in the recorded order
+    int programChangeCounter = profiler.addCounter("program_changes");
+    int vaoChangeCounter = profiler.addCounter("vao_changes");
+    int materialChangeCounter = profiler.addCounter("material_changes");
+    int unsortedChangeCounter = profiler.addCounter("state_changes_unsorted");
+    unsigned long long lastDebugMessages = 0;
+    unsigned long long lastAllocations = heapAllocationCount();
+    unsigned long long steadyAllocations = 0; //after the warm-up frames, where the target is 0
+
+    //Render loop.
+    while (!quit.load(std::memory_order_acquire))
+    {
+        if (benchmark && benchmark->sceneChanged())
+            batch.setCount(benchmark->sceneSize());
+
+        //the limiter (and --idle) waits here, before the input is read, so the frame shows the freshest input it can
+        if (options.idle)
+        {
+            waitForRedraw();
+            if (quit.load(std::memory_order_acquire))
+                break;
+        }
+        pacer.waitForFrame();
+
+        profiler.beginFrame();
+        glState.resetFrameCounters();
+
+        // input, forwarded by the event thread
+        // ------------------------------------
+        profiler.beginPhase(FrameProfiler::PHASE_INPUT);
+        applyEvents();
+        advancePan(glfwGetTime());
+        reloadShaders();
+        pollStreamer();
+        bool compiled = shaders.poll(); //also swaps in reloaded programs, here between two frames
+        dirty = false; //whatever changed until here is in this frame
+        if (shadersPending && compiled)
+        {
+            shadersPending = false;
+            if (!options.benchmark)
+            {
+                std::cout << "Shaders ready after " << (glfwGetTime() - shaderStart) * 1000.0 << " ms";
+                if (shaderCache.enabled())
+                    std::cout << " (" << shaderCache.hitCount() << " cached, " << shaderCache.missCount() << " compiled)";
+                std::cout << std::endl;
+            }
+        }
+        // ------------------------------------
+
+        // hand the frame to the workers; they record (and stream the instances) while we clear
+        // ------------------------------------
+        basicProgram = shaders.program(shaderSlots[SHADER_BASIC].id);
+        instancedProgram = shaders.program(shaderSlots[SHADER_INSTANCED].id);
+        FrameJob job;
+        job.frame = frame++;
+        job.time = options.animate ? glfwGetTime() : 0.0; //a still scene is only streamed for CPU culling
+        job.instanceData = NULL;
+        if (instanced)
+        {
+            frameInstanceCount = batch.count();
+            job.instanceData = instancedProgram ? batch.beginFrame() : NULL;
+            frameInstanceBuffer = batch.instanceBuffer();
+            frameInstanceBase = batch.instanceBase();
+            frameFrustum = Frustum::fromView(panX, panY, zoom);
+            if (options.lod)
+                selectLods();
+        }
+        workers.kick(job);
+
+        //the next mip levels, queued before the draws that will sample them
+        textures.update();
+        // ------------------------------------
+
+        //Background color
+        // ------------------------------------
+        profiler.beginPhase(FrameProfiler::PHASE_CLEAR);
+        profiler.beginRenderWork();
+        if (offscreen)
+            renderTarget.begin(glfwGetTime());
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        profiler.endRenderWork(); //not the wait for the workers below, the GPU has nothing to do then
+        // ------------------------------------
+
+        profiler.beginPhase(FrameProfiler::PHASE_RECORD);
+        workers.collect(lists);
+        if (job.instanceData)
+            batch.endWrite();
+
+        // draw our first triangle
+        // ------------------------------------
+        profiler.beginPhase(FrameProfiler::PHASE_DRAW);
+        profiler.beginRenderWork();
+        replay(lists);
+        indirect.endFrame();
+        culler.endFrame();
+        uniforms.endFrame();
+        if (job.instanceData)
+            batch.endFrame();
+        if (offscreen)
+            renderTarget.resolve(); //the upscale, timed as part of the draw phase
+        profiler.endRenderWork();
+        capture.update();
+        capture.capture(job.frame, viewportWidth, viewportHeight); //of the finished picture, in the back buffer
+        presenter.publish(viewportWidth, viewportHeight);          //so is the copy the other windows show
+        // ------------------------------------
+
+        // glfw: swap buffers; events are polled on the main thread
+        // -------------------------------------------------------------------------------
+        profiler.beginPhase(FrameProfiler::PHASE_SWAP);
+        glfwSwapBuffers(window); //swap the color buffer (a large 2D buffer that contains color values for each pixel in GLFW's window) that is used to render to during this render iteration and show it as output to the screen.
+        profiler.setCounter(latencyCounter, pacer.presented(frameInputTime) * 1000.0);
+        frameInputTime = 0.0;
+        if (!startupTimer.finished())
+        {
+            startupTimer.finish("first frame", !options.benchmark);
+            if (!options.benchmark)
+                std::cout << "GL function lookups by then: " << glResolvedCount() << (options.lazyGL ? " (lazy)" : "")
+                    << " in " << glResolveMs() << " ms, glad has " << glFunctionCount() << " entry points" << std::endl;
+        }
+        // -------------------------------------------------------------------------------
+
+        //the frame's transient data is done with
+        profiler.setCounter(arenaCounter, (double)frameArena.used());
+        frameArena.reset();
+        deletionQueue.endFrame(); //fences what was dropped this frame, deletes what the GPU is done with
+        glObjects.labelNew();     //debug labels for the objects bound for the first time this frame
+        merged = NULL;
+        indirectSlots = NULL;
+        drawBlocks = NULL;
+        mergedCount = 0;
+
+        //counted from one frame to the next, so the title update below is included too
+        unsigned long long allocations = heapAllocationCount();
+        profiler.setCounter(allocationCounter, (double)(allocations - lastAllocations));
+        if (frame > WARMUP_FRAMES)
+            steadyAllocations += allocations - lastAllocations;
+        lastAllocations = allocations;
+
+        profiler.setCounter(skippedStateCounter, (double)glState.frameCounters().skipped);
+        profiler.setCounter(issuedStateCounter, (double)glState.frameCounters().issued);
+        profiler.setCounter(drawCallCounter, (double)frameDrawCalls);
+        profiler.setCounter(instanceCounter, (double)frameInstancesSubmitted);
+        profiler.setCounter(triangleCounter, (double)frameTrianglesSubmitted);
+        profiler.setCounter(programChangeCounter, (double)queue.sortedChanges().programs);
+        profiler.setCounter(vaoChangeCounter, (double)queue.sortedChanges().vertexArrays);
+        profiler.setCounter(materialChangeCounter, (double)queue.sortedChanges().materials);
+        profiler.setCounter(unsortedChangeCounter, (double)queue.recordedChanges().total());
+        GLDebugCounts debugCounts = glDebugCounts();
+        unsigned long long debugMessages = debugCounts.errors + debugCounts.performance + debugCounts.other;
+        profiler.setCounter(debugCounter, (double)(debugMessages - lastDebugMessages));
+        lastDebugMessages = debugMessages;
+        profiler.endFrame();
+
+        //one step per new GPU measurement; the new scale shows from the next frame on. The warm-up frames are left out,
+        //their GPU times include the driver compiling shaders (and llvmpipe's very first one is garbage)
+        if (offscreen && options.dynamicResolution && frame > WARMUP_FRAMES &&
+            profiler.resolvedGpuFrames() != resolutionSamples)
+        {
+            resolutionSamples = profiler.resolvedGpuFrames();
+            renderTarget.setScale(resolution.update(profiler.latestGpuRenderMs(), pacer.framePeriod() * 1000.0));
+        }
+
+        if (benchmark)
+        {
+            benchmark->frameFinished(frameTrianglesSubmitted);
+            if (benchmark->finished())
+                break;
+        }
+
+        //overlay the rolling frame stats in the window title; the event thread applies it
+        double now = glfwGetTime();
+        if (now - lastTitleUpdate >= 0.5)
+        {
+            char text[192];
+            if (instanced)
+                snprintf(text, sizeof(text), "LearnOpenGL | %d instances, %.0fk tris | ", batch.count(),
+                    profiler.counterAverage(triangleCounter) / 1000.0);
+            else
+                strcpy(text, "LearnOpenGL | ");
+            profiler.formatSummary(text + strlen(text), sizeof(text) - strlen(text));
+            snprintf(text + strlen(text), sizeof(text) - strlen(text), " | %.0f draws, binds skipped %.0f/frame | %s",
+                profiler.counterAverage(drawCallCounter), profiler.counterAverage(skippedStateCounter),
+                FramePacer::modeName(pacer.mode()));
+            if (offscreen)
+                snprintf(text + strlen(text), sizeof(text) - strlen(text), " | %dx%d (%.0f%%)", renderTarget.width(),
+                    renderTarget.height(), renderTarget.scale() * 100.0f);
+            if (options.idle)
+                snprintf(text + strlen(text), sizeof(text) - strlen(text), " | idle, %llu skipped", skippedFrames);
+            publishTitle(text);
+            lastTitleUpdate = now;
+        }
+    }
+
+    if (!options.benchmark)
+        std::cout << "Heap allocations after the first " << WARMUP_FRAMES << " frames: " << steadyAllocations
+            << ", frame arena peak " << frameArena.highWater() << " bytes" << std::endl;
+    if (!options.benchmark && pacer.inputCount() > 0)
+        std::cout << "Input to present latency: " << pacer.averageLatency() * 1000.0 << " ms average, "
+            << pacer.maxLatency() * 1000.0 << " ms max over " << pacer.inputCount() << " inputs" << std::endl;
+    if (glDebugOutputEnabled())
+    {
+        GLDebugCounts counts = glDebugCounts();
+        std::cout << "GL debug output: " << counts.errors << " errors, " << counts.performance
+            << " performance warnings, " << counts.other << " other messages" << std::endl;
+    }
+    if (!options.benchmark && options.lazyGL)
+        std::cout << "GL function lookups in total: " << glResolvedCount() << std::endl;
+    if (options.idle)
+        std::cout << "Idle redraw: " << frame << " frames drawn, " << skippedFrames << " display frames skipped"
+            << std::endl;
+}
+
+std::string Renderer::shaderSource(int file, const char* builtIn) const
+{
+    return std::string(shaderPreamble) + (file >= 0 ? shaderWatcher.content(file).c_str() : builtIn);
+}
+
+bool Renderer::pollStreamer()
+{
+    return streamer.poll(arena, meshRadius) > 0;
+}
+
+void Renderer::reloadShaders()
+{
+    unsigned int changedFiles = shaderWatcher.takeChanges();
+    if (!changedFiles)
+        return;
+
+    for (int i = 0; i < SHADER_COUNT; i++)
+    {
+        const ShaderSlot& slot = shaderSlots[i];
+        bool vertexChanged = slot.vertexFile >= 0 && (changedFiles & (1u << slot.vertexFile));
+        bool fragmentChanged = slot.fragmentFile >= 0 && (changedFiles & (1u << slot.fragmentFile));
+        if (!vertexChanged && !fragmentChanged)
+            continue;
+
+        std::string vertexSource = shaderSource(slot.vertexFile, shaderFiles[i].vertexSource);
+        std::string fragmentSource = shaderSource(slot.fragmentFile, shaderFiles[i].fragmentSource);
+        shaderBatch->replace(slot.id, vertexSource.c_str(), fragmentSource.c_str());
+    }
+}
+
+void Renderer::record(const FrameJob& job, int worker, int workerCount, CommandList& out)
+{
+    GLuint vao = arena.vao();
+    GLenum indexType = arena.indexType();
+
+    if (!instanced)
+    {
+        if (worker == 0 && basicProgram)
+        {
+            const MeshRange& mesh = arena.mesh(0);
+            DrawCommand command = { basicProgram, vao, GL_TRIANGLES, indexType, (GLint)mesh.firstIndex, mesh.indexCount,
+                mesh.baseVertex, 0, 0, 0, 0, MATERIAL_BASIC,
+                makeSortKey(PASS_OPAQUE, basicProgram, MATERIAL_BASIC, vao, 0.0f) };
+            out.add(command);
+        }
+        return;
+    }
+    if (!instancedProgram)
+        return;
+    //the scene is flat, every draw is at depth 0; with the one program and material the key only keeps the order
+    uint64_t sortKey = makeSortKey(PASS_OPAQUE, instancedProgram, MATERIAL_INSTANCED, vao, 0.0f);
+
+    //contiguous ranges in worker order, so replay() can merge them back into one instanced draw
+    int count = frameInstanceCount;
+    int active = std::max(1, std::min(workerCount, count / MIN_INSTANCES_PER_WORKER));
+    if (worker >= active)
+        return;
+    int begin = (int)((long long)count * worker / active);
+    int end = (int)((long long)count * (worker + 1) / active);
+    if (begin == end)
+        return;
+
+    //without culling the whole range is streamed in one go; culling packs each mesh' visible instances separately
+    if (job.instanceData && !cpuCull)
+        batch.writeInstances((InstanceData*)job.instanceData, begin, end, job.time);
+
+    //the instances are split into one contiguous range per mesh; emit a command for every mesh our range touches
+    int meshCount = arena.meshCount();
+    for (int m = 0; m < meshCount; m++)
+    {
+        int meshBegin = std::max(begin, (int)((long long)count * m / meshCount));
+        int meshEnd = std::min(end, (int)((long long)count * (m + 1) / meshCount));
+        if (meshBegin >= meshEnd)
+            continue;
+
+        //and for every level of detail in it: the smallest instances come first and use the coarsest level
+        const MeshRange& mesh = arena.mesh(m);
+        int levels = mesh.lodCount; //1 without --lod
+        for (int l = levels - 1; l >= 0; l--)
+        {
+            int lodBegin = l + 1 < levels ? std::max(meshBegin, frameLodEnds[m][l + 1]) : meshBegin;
+            int lodEnd = l > 0 ? std::min(meshEnd, frameLodEnds[m][l]) : meshEnd;
+            if (lodBegin >= lodEnd)
+                continue;
+
+            int drawn = lodEnd - lodBegin;
+            if (cpuCull)
+            {
+                if (!job.instanceData)
+                    continue;
+                drawn = batch.writeVisibleInstances((InstanceData*)job.instanceData, lodBegin, lodEnd, job.time,
+                    frameFrustum, meshRadius);
+                if (drawn == 0)
+                    continue;
+            }
+
+            const MeshLod& lod = mesh.lods[l];
+            DrawCommand command = { instancedProgram, vao, GL_TRIANGLES, indexType, (GLint)lod.firstIndex,
+                (GLsizei)lod.indexCount, mesh.baseVertex, drawn, frameInstanceBuffer, frameInstanceBase, lodBegin,
+                MATERIAL_INSTANCED, sortKey };
+            out.add(command);
+        }
+    }
+}
+
+void Renderer::selectLods()
+{
+    //A level with error e (mesh units) is off by e * scale * pixelsPerUnit pixels on screen, and fine as long as that
+    //stays under the threshold. The view is orthographic, so that only depends on the instance's scale, and the
+    //instances are sorted by scale: every level ends at one binary-searched instance per mesh.
+    int width = offscreen ? renderTarget.width() : viewportWidth;
+    int height = offscreen ? renderTarget.height() : viewportHeight;
+    float pixelsPerUnit = zoom * 0.5f * (float)std::max(width, height);
+    int count = frameInstanceCount;
+    int meshCount = arena.meshCount();
+    for (int m = 0; m < meshCount; m++)
+    {
+        int meshBegin = (int)((long long)count * m / meshCount);
+        int meshEnd = (int)((long long)count * (m + 1) / meshCount);
+        const MeshRange& mesh = arena.mesh(m);
+        frameLodEnds[m][0] = meshEnd;
+        for (int l = 1; l < mesh.lodCount; l++)
+        {
+            float error = mesh.lods[l].error * pixelsPerUnit;
+            frameLodEnds[m][l] = error > 0.0f ? batch.scaleBound(meshBegin, meshEnd, options.lodThreshold / error) : meshEnd;
+        }
+    }
+}
+
+static bool continues(const DrawCommand& pending, const DrawCommand& command)
+{
+    return pending.instanceCount > 0 && command.instanceCount > 0 && command.program == pending.program &&
+        command.vao == pending.vao && command.mode == pending.mode && command.indexType == pending.indexType &&
+        command.first == pending.first && command.count == pending.count && command.baseVertex == pending.baseVertex &&
+        command.instanceBuffer == pending.instanceBuffer && command.instanceBase == pending.instanceBase &&
+        command.material == pending.material && command.firstInstance == pending.firstInstance + pending.instanceCount;
+}
+
+//instanced draws of the same program, VAO, instance buffer and material can share one glMultiDrawElementsIndirect
+static bool sameIndirectGroup(const DrawCommand& a, const DrawCommand& b)
+{
+    return a.program == b.program && a.vao == b.vao && a.mode == b.mode && a.indexType == b.indexType &&
+        a.instanceBuffer == b.instanceBuffer && a.instanceBase == b.instanceBase && a.material == b.material;
+}
+
+void Renderer::replay(const std::vector<const CommandList*>& lists)
+{
+    //The workers sorted their lists by sort key, the queue merges them into the submission order (RenderQueue.h).
+    //Commands that only differ by a directly following instance range are the same draw split across workers; merge
+    //them so splitting the recording doesn't multiply the draw calls.
+    size_t recorded = 0;
+    for (size_t l = 0; l < lists.size(); l++)
+        recorded += lists[l]->size();
+    const DrawCommand** order = frameArena.allocateArray<const DrawCommand*>(recorded);
+    size_t ordered = queue.merge(lists, frameArena, order);
+    merged = frameArena.allocateArray<DrawCommand>(recorded);
+    indirectSlots = frameArena.allocateArray<int>(recorded);
+
+    mergedCount = 0;
+    for (size_t i = 0; i < ordered; i++)
+    {
+        if (mergedCount > 0 && continues(merged[mergedCount - 1], *order[i]))
+            merged[mergedCount - 1].instanceCount += order[i]->instanceCount;
+        else
+            merged[mergedCount++] = *order[i];
+    }
+    frameInstancesSubmitted = 0;
+    frameTrianglesSubmitted = 0;
+    for (size_t i = 0; i < mergedCount; i++)
+    {
+        frameInstancesSubmitted += merged[i].instanceCount;
+        frameTrianglesSubmitted += (long long)(merged[i].count / 3) * std::max(merged[i].instanceCount, 1);
+    }
+
+    //Every uniform block of the frame is written before the first draw (see UniformRing.h): the pan/zoom that applies
+    //to every instanced draw, culled or not, and the material of each draw.
+    drawBlocks = frameArena.allocateArray<GLintptr>(mergedCount);
+    uniforms.beginFrame();
+    //the texture array is bound once for the whole frame; which layer of it is shown is part of the uniforms
+    FrameUniforms frameUniforms = { { panX, panY }, zoom, -1, 0.0f };
+    if (shownTexture < textures.count() && textures.resident(shownTexture))
+    {
+        glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, textures.texture(shownTexture));
+        frameUniforms.textureLayer = textures.layer(shownTexture);
+        frameUniforms.textureMinLod = (float)textures.finestLevel(shownTexture);
+    }
+    GLintptr frameBlock = uniforms.push(frameUniforms);
+    for (size_t i = 0; i < mergedCount; i++)
+        drawBlocks[i] = uniforms.push(materials[merged[i].material]);
+    uniforms.endWrite();
+    uniforms.bind<FrameUniforms>(UNIFORM_BINDING_FRAME, frameBlock);
+
+    frameDrawCalls = 0;
+    if (cullOnGpu())
+        return;
+
+    //every indexed instanced draw becomes an indirect command; they are all uploaded at once
+    indirect.begin();
+    for (size_t i = 0; i < mergedCount; i++)
+    {
+        const DrawCommand& command = merged[i];
+        indirectSlots[i] = -1;
+        if (command.instanceCount > 0 && command.indexType)
+        {
+            DrawElementsIndirectCommand indirectCommand = { (GLuint)command.count, (GLuint)command.instanceCount,
+                (GLuint)command.first, command.baseVertex, (GLuint)command.firstInstance };
+            indirectSlots[i] = indirect.add(indirectCommand);
+        }
+    }
+    indirect.upload();
+
+    boundInstanceBuffer = 0;
+    for (size_t i = 0; i < mergedCount;)
+    {
+        const DrawCommand& command = merged[i];
+        if (indirectSlots[i] < 0)
+        {
+            submit(command, drawBlocks[i]);
+            i++;
+            continue;
+        }
+
+        //the longest run of consecutive slots that can go out as one call
+        size_t end = i + 1;
+        while (end < mergedCount && indirectSlots[end] == indirectSlots[end - 1] + 1 && sameIndirectGroup(command, merged[end]))
+            end++;
+
+        glState.useProgram(command.program);
+        glState.bindVertexArray(command.vao);
+        uniforms.bind<DrawUniforms>(UNIFORM_BINDING_DRAW, drawBlocks[i]); //the whole run shares the material
+        int callsBefore = indirect.drawCalls();
+        indirect.draw(command.mode, command.indexType, indirectSlots[i], (int)(end - i), batch, command.instanceBuffer,
+            command.instanceBase);
+        frameDrawCalls += indirect.drawCalls() - callsBefore;
+        boundInstanceBuffer = 0; //the indirect path re-pointed the instance attributes
+        i = end;
+    }
+}
+
+bool Renderer::cullOnGpu()
+{
+    //one dispatch and one draw for the whole frame, so everything has to be instanced, indexed and in one group
+    if (!culler.enabled() || mergedCount == 0 || (int)mergedCount > GpuCuller::MAX_COMMANDS)
+        return false;
+    for (size_t i = 0; i < mergedCount; i++)
+    {
+        if (merged[i].instanceCount == 0 || !merged[i].indexType || !sameIndirectGroup(merged[0], merged[i]))
+            return false;
+    }
+
+    uniforms.bind<DrawUniforms>(UNIFORM_BINDING_DRAW, drawBlocks[0]);
+    culler.cullAndDraw(merged, (int)mergedCount, Frustum::fromView(panX, panY, zoom), meshRadius,
+        merged[0].program, batch);
+    frameDrawCalls = 1;
+    boundInstanceBuffer = 0;
+    return true;
+}
+
+void Renderer::submit(const DrawCommand& command, GLintptr drawBlock)
+{
+    glState.useProgram(command.program); //specificy which program to use
+    glState.bindVertexArray(command.vao); // seeing as we only have a single VAO there's no need to bind it every time; the state cache turns these into no-ops after the first frame
+    uniforms.bind<DrawUniforms>(UNIFORM_BINDING_DRAW, drawBlock); //its slice of the uniform ring
+    frameDrawCalls++;
+
+    //offset of the first index inside the element buffer
+    size_t indexSize = command.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    const void* indexOffset = (const void*)(command.first * indexSize);
+
+    if (command.instanceCount == 0)
+    {
+        //OpenGL functions based on the first parameter which is an enum.
+        if (command.indexType)
+            glDrawElementsBaseVertex(command.mode, command.count, command.indexType, indexOffset, command.baseVertex);
+        else
+            glDrawArrays(command.mode, command.first, command.count);
+        return;
+    }
+
+    if (command.instanceBuffer != boundInstanceBuffer || command.instanceBase != boundInstanceBase ||
+        command.firstInstance != boundFirstInstance)
+    {
+        batch.bindInstances(command.instanceBuffer, command.instanceBase, command.firstInstance);
+        boundInstanceBuffer = command.instanceBuffer;
+        boundInstanceBase = command.instanceBase;
+        boundFirstInstance = command.firstInstance;
+    }
+
+    //one call for every copy of the mesh
+    if (command.indexType)
+        glDrawElementsInstancedBaseVertex(command.mode, command.count, command.indexType, indexOffset, command.instanceCount,
+            command.baseVertex);
+    else
+        glDrawArraysInstanced(command.mode, command.first, command.count, command.instanceCount);
+}
+
+void Renderer::cleanup()
+{
+    workers.stop();
+    shaderWatcher.stop();
+    streamer.stop();
+    if (!shaderBatch)
+    {
+        deletionQueue.flush();
+        return; //setup() failed before anything was created
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    profiler.shutdown();
+    if (presenter.active())
+    {
+        presenter.stop();
+        if (!options.benchmark)
+        {
+            std::cout << "Windows: " << presenter.published() << " frames shared, " << presenter.dropped() << " dropped";
+            for (int i = 0; i < presenter.windowCount(); i++)
+                std::cout << ", window " << i + 2 << " presented " << presenter.presented(i);
+            std::cout << std::endl;
+        }
+    }
+    if (batch.animated() && !options.benchmark)
+        std::cout << "Stream buffer: " << batch.streamBuffer().stallCount() << " stalls, " << batch.streamBuffer().orphanCount() << " orphans" << std::endl;
+    if (offscreen && !options.benchmark)
+        std::cout << "Render target: " << renderTarget.reallocations() << " allocations, " << resolution.changes()
+            << " scale changes, last " << renderTarget.width() << "x" << renderTarget.height() << std::endl;
+    renderTarget.shutdown();
+    if (capture.active())
+    {
+        capture.shutdown();
+        if (!options.benchmark)
+            std::cout << "Capture: " << capture.written() << " frames written, " << capture.dropped() << " dropped, "
+                << capture.failed() << " failed" << std::endl;
+    }
+    if (textures.count() > 0 && !options.benchmark)
+        std::cout << "Textures: " << textures.uploadedBytes() / 1024 << " KiB uploaded over " << textures.uploadFrames()
+            << " frames" << (textures.streaming() ? ", still streaming" : "") << std::endl;
+    textures.shutdown();
+    culler.shutdown();
+    uniforms.shutdown();
+    indirect.shutdown();
+    batch.shutdown();
+    shaderBatch->shutdown();
+    arena.shutdown();
+    frameArena.shutdown();
+    // ------------------------------------------------------------------------
+
+    //nothing is drawn anymore, so what's still queued can go right away
+    deletionQueue.flush();
+
+    //anything still registered was created without a matching delete
+    if (glObjects.reportLeaks() == 0 && !options.benchmark)
+        std::cout << "All GL objects deleted" << std::endl;
+
+    delete shaderBatch;
+    delete benchmark;
+    shaderBatch = NULL;
+    benchmark = NULL;
+}
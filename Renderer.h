@@ -0,0 +1,238 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AppOptions.h"
+#include "CommandWorkers.h"
+#include "DynamicResolution.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "Frustum.h"
+#include "GLDeletionQueue.h"
+#include "GLObjects.h"
+#include "GLStateCache.h"
+#include "GpuCuller.h"
+#include "IndirectDrawBatch.h"
+#include "InstancedBatch.h"
+#include "MeshArena.h"
+#include "MeshStreamer.h"
+#include "RenderQueue.h"
+#include "RenderTarget.h"
+#include "ShaderCache.h"
+#include "ShaderWatcher.h"
+#include "SpscQueue.h"
+#include "TextureManager.h"
+#include "UniformRing.h"
+#include "WindowPresenter.h"
+
+class Benchmark;
+class ShaderBatch;
+
+//the programs the renderer compiles, see shaderFiles in Renderer.cpp
+enum ShaderId
+{
+    SHADER_BASIC,
+    SHADER_INSTANCED,
+    SHADER_COUNT
+};
+
+//RENDER THREAD
+//***********************************************************
+/*
+  GLFW wants its event functions (glfwPollEvents, glfwSetWindowTitle, window creation...) called from the main thread,
+  but an OpenGL context can be current on any thread. So the work is split:
+
+  Main (event) thread: creates the window, pumps events and turns them into RenderEvents.
+  Render thread: makes the context current and owns every GL call from then on. It drains the RenderEvents at the start
+  of each frame, kicks the CommandWorkers, and replays the command lists they record.
+  Worker threads: decide what to draw and write this frame's instance data straight into the mapped stream region;
+  they never touch GL.
+  Presenter threads (--windows): one per extra window, each showing the render thread's newest frame on a context of
+  its own, see WindowPresenter.h.
+
+  A slow swap (vsync, a busy driver) now only blocks the render thread; the window keeps responding to the OS. Nothing
+  is shared between the threads except the event queue (main -> render), the title mailbox (render -> main) and the
+  finished flag.
+*/
+
+struct RenderEvent
+{
+    enum Type
+    {
+        RESIZE,          //a, b = new framebuffer size
+        MORE_INSTANCES,
+        FEWER_INSTANCES,
+        ZOOM_IN,
+        ZOOM_OUT,
+        PAN_KEYS,        //a, b = direction (-1, 0 or 1) held in x and y from now on
+        DRAG,            //a, b = cursor movement in framebuffer pixels, x right and y down
+        CYCLE_PACING,    //next FramePacer mode
+        CYCLE_TEXTURE,   //show the next --texture
+        REDRAW           //the window contents were lost (uncovered, restored) and have to be drawn again
+    };
+
+    Type type;
+    int a;
+    int b;
+    double time; //glfwGetTime() when the main thread posted it, for the input latency
+};
+
+class Renderer : public CommandRecorder
+{
+public:
+    //uploadWindow is a hidden window whose context shares objects with window's, for MeshStreamer. May be NULL.
+    Renderer(GLFWwindow* window, const AppOptions& options, GLFWwindow* uploadWindow = NULL);
+    ~Renderer();
+
+    //--windows: another window to show the frames in, whose context shares objects with window's. Main thread, before
+    //start(); false once there are WindowPresenter::MAX_WINDOWS.
+    bool addWindow(GLFWwindow* extraWindow);
+    //Main thread: the framebuffer of an addWindow() window has a new size.
+    void resizeWindow(GLFWwindow* extraWindow, int width, int height);
+
+    //Releases the calling thread's context and starts the render thread, which takes it over.
+    void start();
+
+    //Asks the render thread to finish its frame and clean up, then joins it.
+    void stop();
+
+    //Main thread only (the single producer of the event queue). tryPostEvent returns false instead of warning when the
+    //queue is full.
+    void postEvent(RenderEvent::Type type, int a = 0, int b = 0);
+    bool tryPostEvent(RenderEvent::Type type, int a = 0, int b = 0);
+
+    //True once the render thread has exited on its own (benchmark done, setup failed). It posts an empty event so a
+    //waiting main thread notices right away.
+    bool finished() const { return done.load(std::memory_order_acquire); }
+    int exitCode() const { return result; }
+
+    //Copies the newest window title into buffer if it changed since the last call. Main thread only.
+    bool takeTitle(char* buffer, size_t size);
+
+    //CommandRecorder, runs on the worker threads.
+    void record(const FrameJob& job, int worker, int workerCount, CommandList& out);
+
+private:
+    void threadMain();
+    bool setup();
+    void renderLoop();
+    void cleanup();
+    void applyEvents();
+    void advancePan(double time); //moves the view for the pan keys held until time
+    bool animating() const;       //something changes without input, so frames have to keep coming
+    void waitForRedraw();         //--idle: returns once there is something new to draw
+    void waitForEvents(double timeout);
+    void replay(const std::vector<const CommandList*>& lists);
+    bool cullOnGpu(); //draws merged through the GpuCuller if it can take all of it
+    void submit(const DrawCommand& command, GLintptr drawBlock);
+    void publishTitle(const char* title);
+    std::string shaderSource(int file, const char* builtIn) const; //preamble + file, or the built-in copy without one
+    void reloadShaders(); //hands saved shader files to ShaderBatch::replace()
+    bool pollStreamer();  //swaps in the meshes the streamer finished, true if there were any
+    void selectLods();    //--lod: fills frameLodEnds for this frame's view
+
+    GLFWwindow* window;
+    AppOptions options;
+    std::thread thread;
+    std::atomic<bool> quit;
+    std::atomic<bool> done;
+    int result;
+
+    SpscQueue<RenderEvent, 256> events;
+    //--idle: the render thread sleeps here while nothing animates; postEvent only locks when it does
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping;
+
+    std::mutex titleMutex;
+    char title[192];
+    bool titleChanged;
+
+    //GL objects and the subsystems that own them, render thread only
+    GLStateCache glState;
+    GLObjects glObjects;
+    GLDeletionQueue deletionQueue;
+    ShaderCache shaderCache;
+    ShaderBatch* shaderBatch;
+    FrameProfiler profiler;
+    FramePacer pacer;
+    double frameInputTime; //oldest input applied this frame, 0 for none
+    bool dirty;            //the picture changed since the last frame was drawn
+    unsigned long long skippedFrames; //--idle: display frames that passed without a new one
+    //--render-scale / --dynamic-res draw into renderTarget and blit it to the window; without them it isn't created
+    RenderTarget renderTarget;
+    bool offscreen;
+    DynamicResolution resolution;
+    unsigned long long resolutionSamples; //profiler.resolvedGpuFrames() the scale was last updated at
+    FrameCapture capture; //--capture
+    WindowPresenter presenter; //--windows
+    Benchmark* benchmark;
+    //ShaderBatch ids, and the ShaderWatcher index of each program's files (-1 = not found, built-in source)
+    struct ShaderSlot
+    {
+        int id;
+        int vertexFile;
+        int fragmentFile;
+    };
+    ShaderSlot shaderSlots[SHADER_COUNT];
+    ShaderWatcher shaderWatcher;
+    double shaderStart;
+    MeshArena arena;
+    MeshStreamer streamer; //--mesh files, replacing the arena's meshes as they arrive
+    GLFWwindow* uploadWindow;
+    bool instanced;
+    InstancedBatch batch;
+    IndirectDrawBatch indirect;
+    UniformRing uniforms; //every uniform block of the frame, see UniformBlocks.h
+    GpuCuller culler;
+    bool cpuCull; //the workers cull while writing the instances, see InstanceStore.h
+    float meshRadius; //bounding sphere of every mesh at instance scale 1
+    TextureManager textures; //--texture files
+    int shownTexture;        //the one the instanced draws show, T cycles
+    CommandWorkers workers;
+    std::vector<const CommandList*> lists;
+    RenderQueue queue; //merges the workers' sorted lists
+    //per-frame data below comes from frameArena and is gone after the swap
+    FrameArena frameArena;
+    DrawCommand* merged; //this frame's commands after merging
+    size_t mergedCount;
+    int* indirectSlots;  //merged[i]'s command index in the indirect batch, or -1
+    GLintptr* drawBlocks; //merged[i]'s DrawUniforms in the uniform ring
+
+    //What the workers record this frame. Written by the render thread before kick(), only read by the workers.
+    GLuint basicProgram;
+    GLuint instancedProgram;
+    int frameInstanceCount;
+    GLuint frameInstanceBuffer;
+    GLintptr frameInstanceBase;
+    Frustum frameFrustum;
+    int frameDrawCalls;
+    long long frameInstancesSubmitted;
+    long long frameTrianglesSubmitted;
+    //--lod: instances of mesh m from frameLodEnds[m][l + 1] up to frameLodEnds[m][l] are drawn with level l
+    int frameLodEnds[MAX_MESHES][MAX_MESH_LODS];
+
+    //2D view of the instanced scene, see Frustum.h
+    float panX;
+    float panY;
+    float zoom;
+    int panDirectionX; //pan keys held, -1, 0 or 1
+    int panDirectionY;
+    double panTime;    //the pan is applied up to this glfwGetTime()
+    int viewportWidth; //framebuffer size, for turning drags into world units
+    int viewportHeight;
+
+    //instance attribute binding of the last replayed instanced draw, so consecutive ranges don't re-point them
+    GLuint boundInstanceBuffer;
+    GLintptr boundInstanceBase;
+    GLint boundFirstInstance;
+};
@@ -0,0 +1,361 @@
+#include "Shader.h"
+#include "GLExtensions.h"
+#include "ShaderCache.h"
+#include "UniformBlocks.h"
+
+#include <iostream>
+#include <utility>
+
+unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource, ShaderCache* cache)
+{
+    // program cache
+    // ------------------------------------
+    //a hit skips compiling and linking entirely
+    if (cache)
+    {
+        unsigned int cached = cache->load(vertexSource, fragmentSource);
+        if (cached)
+            return cached;
+    }
+    // ------------------------------------
+
+    // vertex shader
+    // ------------------------------------
+    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER); //Creates the variable for the name and sets it all in one line. glCreateShader creates a shader based on the enum parameter
+    glShaderSource(vertexShader, 1, &vertexSource, NULL); //links the shader code to our shader objects. 1st parameter: the shader object, 2nd: how many strings being passed in. 3rd: source code of shader. 4th: null
+    glCompileShader(vertexShader);
+
+    // check for shader compile errors
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+    // ------------------------------------
+
+
+    // fragment shader
+    // ------------------------------------
+    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);//Creates the variable for the name and sets it all in one line. glCreateShader creates a shader based on the enum parameter
+    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);//links the shader code to our shader objects. 1st parameter: the shader object, 2nd: how many strings being passed in. 3rd: source code of shader. 4th: null
+    glCompileShader(fragmentShader);
+   
+    // check for shader compile errors
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+    // ------------------------------------
+
+
+    // link shaders togther
+    // ------------------------------------
+
+    //When linking shaders, the outputs of each shader is linked to the inputs of the next shader. Errors arise if inputs and outputs don't match.
+    unsigned int shaderProgram = glCreateProgram(); //creates program object called shaderProgram
+    if (cache)
+        cache->prepareForStore(shaderProgram); //must be set before linking
+    glAttachShader(shaderProgram, vertexShader); //add shader
+    glAttachShader(shaderProgram, fragmentShader); //add shader
+    glLinkProgram(shaderProgram); //link shaders
+    
+    // check for linking errors
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+    else if (cache)
+    {
+        cache->store(shaderProgram, vertexSource, fragmentSource);
+    }
+    
+    //Shaders can be deleted after they are linked to program object
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    // ------------------------------------
+
+    return shaderProgram;
+}
+
+unsigned int createComputeProgram(const char* computeSource)
+{
+    // compute shader
+    // ------------------------------------
+    //same steps as the vertex and fragment shaders, but a compute shader is a whole program by itself
+    //the handles delete whatever is left over on every return path
+    GLShader computeShader;
+    computeShader.create("compute shader", GL_COMPUTE_SHADER);
+    GLuint shader = computeShader.get();
+    glShaderSource(shader, 1, &computeSource, NULL);
+    glCompileShader(shader);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+        return 0;
+    }
+    // ------------------------------------
+
+    GLProgram program;
+    program.create("compute program");
+    glAttachShader(program.get(), shader);
+    glLinkProgram(program.get());
+
+    glGetProgramiv(program.get(), GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program.get(), 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        return 0;
+    }
+    return program.release();
+}
+
+// ShaderBatch
+// ------------------------------------
+ShaderBatch::ShaderBatch(ShaderCache* shaderCache)
+    : cache(shaderCache)
+{
+    //let the driver use as many compiler threads as it likes
+    if (glext.parallelShaderCompile && glext.MaxShaderCompilerThreads)
+        glext.MaxShaderCompilerThreads(0xFFFFFFFFu);
+}
+
+void ShaderBatch::shutdown()
+{
+    //the handles queue their shaders and programs for deletion
+    entries.clear();
+}
+
+int ShaderBatch::add(const char* name, const char* vertexSource, const char* fragmentSource)
+{
+    int id = 0;
+    while (id < (int)entries.size() && entries[id].state != STATE_FREE)
+        id++;
+    if (id == (int)entries.size())
+        entries.push_back(Entry());
+
+    Entry& entry = entries[id];
+    entry.name = name;
+    entry.vertexSource = vertexSource;
+    entry.fragmentSource = fragmentSource;
+    entry.state = STATE_QUEUED;
+    entry.replaces = -1;
+    entry.replacement = -1;
+    return id;
+}
+
+void ShaderBatch::replace(int id, const char* vertexSource, const char* fragmentSource)
+{
+    if (id < 0 || id >= (int)entries.size() || entries[id].state == STATE_FREE || entries[id].replaces >= 0)
+        return;
+
+    //an ordinary entry that nobody asks for by id; settle() moves its program over once it is done
+    int replacement = add(entries[id].name, vertexSource, fragmentSource);
+    entries[replacement].replaces = id;
+    entries[id].replacement = replacement;
+    submit();
+}
+
+void ShaderBatch::settle(int id)
+{
+    Entry& entry = entries[id];
+    if (entry.replaces < 0 || (entry.state != STATE_READY && entry.state != STATE_FAILED))
+        return;
+
+    //a newer replace() came in meanwhile: this one is simply dropped
+    Entry& target = entries[entry.replaces];
+    if (target.replacement == id)
+    {
+        if (entry.state == STATE_READY)
+        {
+            target.program = std::move(entry.program); //the old program is queued for deletion
+            target.vertexSource.swap(entry.vertexSource);
+            target.fragmentSource.swap(entry.fragmentSource);
+            target.state = STATE_READY;
+            std::cout << "Shader " << target.name << " reloaded" << std::endl;
+        }
+        else
+        {
+            std::cout << "WARNING::SHADER::RELOAD_FAILED (" << target.name << ") keeping the previous program" << std::endl;
+        }
+        target.replacement = -1;
+    }
+
+    entry.program.reset();
+    entry.vertexSource.clear();
+    entry.fragmentSource.clear();
+    entry.replaces = -1;
+    entry.state = STATE_FREE;
+}
+
+void ShaderBatch::submit()
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        Entry& entry = entries[i];
+        if (entry.state != STATE_QUEUED)
+            continue;
+
+        if (cache)
+        {
+            GLuint cached = cache->load(entry.vertexSource.c_str(), entry.fragmentSource.c_str());
+            if (cached)
+            {
+                entry.program.adopt(cached, entry.name);
+                assignUniformBlockBindings(cached); //not part of the binary, always set after loading
+                entry.state = STATE_READY;
+                settle((int)i);
+                continue;
+            }
+        }
+
+        //no status queries here: each of these calls returns as soon as the work is handed to the driver
+        const char* vertexSource = entry.vertexSource.c_str();
+        const char* fragmentSource = entry.fragmentSource.c_str();
+        entry.vertexShader.create(entry.name, GL_VERTEX_SHADER);
+        glShaderSource(entry.vertexShader.get(), 1, &vertexSource, NULL);
+        glCompileShader(entry.vertexShader.get());
+
+        entry.fragmentShader.create(entry.name, GL_FRAGMENT_SHADER);
+        glShaderSource(entry.fragmentShader.get(), 1, &fragmentSource, NULL);
+        glCompileShader(entry.fragmentShader.get());
+
+        entry.program.create(entry.name);
+        GLuint program = entry.program.get();
+        if (cache)
+            cache->prepareForStore(program);
+        glAttachShader(program, entry.vertexShader.get());
+        glAttachShader(program, entry.fragmentShader.get());
+        glLinkProgram(program);
+        entry.state = STATE_COMPILING;
+    }
+}
+
+bool ShaderBatch::isComplete(const Entry& entry) const
+{
+    //the program's completion status covers its shaders too
+    GLint complete = GL_FALSE;
+    glGetProgramiv(entry.program.get(), GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+void ShaderBatch::finalize(Entry& entry)
+{
+    int success;
+    char infoLog[512];
+    GLuint program = entry.program.get();
+    GLuint vertexShader = entry.vertexShader.get();
+    GLuint fragmentShader = entry.fragmentShader.get();
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        //find out which stage broke, same messages as createShaderProgram
+        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED (" << entry.name << ")\n" << infoLog << std::endl;
+        }
+        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED (" << entry.name << ")\n" << infoLog << std::endl;
+        }
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED (" << entry.name << ")\n" << infoLog << std::endl;
+        entry.state = STATE_FAILED;
+    }
+    else
+    {
+        if (cache)
+            cache->store(program, entry.vertexSource.c_str(), entry.fragmentSource.c_str());
+        assignUniformBlockBindings(program);
+        entry.state = STATE_READY;
+    }
+
+    //Shaders can be deleted after they are linked to program object
+    entry.vertexShader.reset();
+    entry.fragmentShader.reset();
+}
+
+bool ShaderBatch::poll()
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        Entry& entry = entries[i];
+        if (entry.state != STATE_COMPILING)
+            continue;
+
+        if (glext.parallelShaderCompile)
+        {
+            if (isComplete(entry))
+            {
+                finalize(entry);
+                settle((int)i);
+            }
+        }
+        else
+        {
+            //every status query blocks here, so only take the hit for one program this call
+            finalize(entry);
+            settle((int)i);
+            break;
+        }
+    }
+    return pendingCount() == 0;
+}
+
+void ShaderBatch::finish()
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].state == STATE_COMPILING)
+        {
+            finalize(entries[i]);
+            settle((int)i);
+        }
+    }
+}
+
+bool ShaderBatch::ready(int id) const
+{
+    return id >= 0 && id < (int)entries.size() && entries[id].state == STATE_READY;
+}
+
+bool ShaderBatch::failed(int id) const
+{
+    return id >= 0 && id < (int)entries.size() && entries[id].state == STATE_FAILED;
+}
+
+GLuint ShaderBatch::program(int id) const
+{
+    return ready(id) ? entries[id].program.get() : 0;
+}
+
+GLuint ShaderBatch::release(int id)
+{
+    return ready(id) ? entries[id].program.release() : 0;
+}
+
+int ShaderBatch::pendingCount() const
+{
+    int pending = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i].state == STATE_QUEUED || entries[i].state == STATE_COMPILING)
+            pending++;
+    return pending;
+}
+// ------------------------------------
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "GLResource.h"
+
+class ShaderCache;
+
+// compiles a vertex and fragment shader and links them into a program. Errors are printed but still return the program
+// so the caller carries on like before; a broken program just draws nothing.
+// With a cache the linked binary is restored from disk when the sources and driver match, and saved after a fresh link.
+unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource, ShaderCache* cache = NULL);
+
+// compiles a compute shader into its own program (GL 4.3, check glext.computeShader first). Returns 0 on errors, which
+// are printed.
+unsigned int createComputeProgram(const char* computeSource);
+
+//BATCH SHADER COMPILATION
+//***********************************************************
+/*
+  createShaderProgram() compiles and checks each shader one after the other. Asking for GL_COMPILE_STATUS right after
+  glCompileShader forces the driver to finish that compile on the spot, so every shader is compiled serially on our thread.
+
+  ShaderBatch instead submits every shader and program first (glCompileShader and glLinkProgram return immediately) and
+  only looks at the results later. With GL_KHR_parallel_shader_compile the driver compiles on its own worker threads and
+  GL_COMPLETION_STATUS_KHR tells us, without blocking, whether a program is done, so poll() can be called once per frame
+  while the render loop keeps running. Without the extension querying a status blocks, so poll() finishes at most one
+  program per call to spread the cost over several frames.
+
+  Programs found in the ShaderCache are ready right after submit(). Either way a program gets the uniform block bindings
+  of UniformBlocks.h before it is reported ready.
+
+  replace() recompiles a program from new sources the same way, in the background. program(id) keeps returning the
+  current program while the replacement compiles; the poll() that finds it linked swaps it in, so the switch always
+  happens between two frames. If the new sources don't compile or link, the errors are printed and the current program
+  simply stays. The old program goes through the GLDeletionQueue, so frames still in flight can finish drawing with it.
+*/
+
+class ShaderBatch
+{
+public:
+    explicit ShaderBatch(ShaderCache* cache = NULL);
+
+    //Queues every shader and program that wasn't released for deletion. Call it before the GLDeletionQueue is flushed.
+    void shutdown();
+
+    //Queues a program and returns its id. The sources are copied; name must stay valid and is used in error messages.
+    int add(const char* name, const char* vertexSource, const char* fragmentSource);
+
+    //Starts recompiling id from new sources right away (see above). A newer replace() supersedes one still compiling.
+    void replace(int id, const char* vertexSource, const char* fragmentSource);
+
+    //Starts compiling and linking everything queued since the last submit().
+    void submit();
+
+    //Checks the programs still in flight without blocking (see above). Returns true once nothing is pending.
+    bool poll();
+
+    //Blocks until every submitted program has finished.
+    void finish();
+
+    bool ready(int id) const;  //linked successfully, program(id) can be used
+    bool failed(int id) const; //compile or link error, already printed
+    GLuint program(int id) const;
+
+    //Hands ownership of a ready program to the caller; the batch won't delete it.
+    GLuint release(int id);
+
+    int pendingCount() const;
+
+private:
+    enum State
+    {
+        STATE_QUEUED,
+        STATE_COMPILING,
+        STATE_READY,
+        STATE_FAILED,
+        STATE_FREE //a finished replacement, the slot is reused by add()
+    };
+
+    struct Entry
+    {
+        const char* name;
+        std::string vertexSource;
+        std::string fragmentSource;
+        GLShader vertexShader;
+        GLShader fragmentShader;
+        GLProgram program;
+        State state;
+        int replaces;    //entry this one is the replacement of, or -1
+        int replacement; //newest replacement compiling for this entry, or -1
+    };
+
+    bool isComplete(const Entry& entry) const;
+    void finalize(Entry& entry);
+    void settle(int id); //hands a finished replacement over to the entry it replaces
+
+    ShaderCache* cache;
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,174 @@
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+//file layout: CacheHeader followed by `length` bytes of driver binary
+struct CacheHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned long long key;
+    unsigned int binaryFormat;
+    unsigned int length;
+};
+
+static const char CACHE_MAGIC[4] = { 'O', 'G', 'T', 'B' };
+static const unsigned int CACHE_VERSION = 1;
+
+// FNV-1a: tiny, fast and good enough to tell shader sources apart
+static unsigned long long hashBytes(unsigned long long hash, const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void makeDirectory(const char* path)
+{
+#ifdef _WIN32
+    _mkdir(path);
+#else
+    mkdir(path, 0755);
+#endif
+}
+
+ShaderCache::ShaderCache()
+    : active(false), hits(0), misses(0)
+{
+}
+
+bool ShaderCache::init(const char* directory)
+{
+    active = false;
+    if (!glext.programBinary)
+        return false;
+
+    const char* vendor = (const char*)glGetString(GL_VENDOR);
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    driverId = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+    cacheDirectory = directory;
+    makeDirectory(directory); //fine if it already exists
+    active = true;
+    return true;
+}
+
+unsigned long long ShaderCache::keyFor(const char* vertexSource, const char* fragmentSource) const
+{
+    unsigned long long hash = 14695981039346656037ull;
+    hash = hashBytes(hash, vertexSource, strlen(vertexSource) + 1); //include the terminator so "ab"+"c" != "a"+"bc"
+    hash = hashBytes(hash, fragmentSource, strlen(fragmentSource) + 1);
+    hash = hashBytes(hash, driverId.c_str(), driverId.size());
+    return hash;
+}
+
+std::string ShaderCache::pathFor(unsigned long long key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", key);
+    return cacheDirectory + name;
+}
+
+GLuint ShaderCache::load(const char* vertexSource, const char* fragmentSource)
+{
+    if (!active)
+        return 0;
+
+    unsigned long long key = keyFor(vertexSource, fragmentSource);
+    FILE* file = fopen(pathFor(key).c_str(), "rb");
+    if (!file)
+    {
+        misses++;
+        return 0;
+    }
+
+    CacheHeader header;
+    std::vector<char> binary;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, CACHE_MAGIC, 4) == 0 &&
+        header.version == CACHE_VERSION && header.key == key && header.length > 0;
+    if (valid)
+    {
+        binary.resize(header.length);
+        valid = fread(binary.data(), 1, header.length, file) == header.length;
+    }
+    fclose(file);
+
+    if (!valid)
+    {
+        misses++;
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glext.ProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)header.length);
+
+    //a rejected binary (e.g. the driver changed without changing its version string) fails the link status
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        misses++;
+        return 0;
+    }
+
+    hits++;
+    return program;
+}
+
+void ShaderCache::prepareForStore(GLuint program) const
+{
+    if (active)
+        glext.ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ShaderCache::store(GLuint program, const char* vertexSource, const char* fragmentSource)
+{
+    if (!active)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glext.GetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    CacheHeader header;
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = CACHE_VERSION;
+    header.key = keyFor(vertexSource, fragmentSource);
+    header.binaryFormat = format;
+    header.length = (unsigned int)written;
+
+    //write to a temporary name first so a crash mid-write never leaves a truncated entry behind
+    std::string path = pathFor(header.key);
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file)
+        return;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(binary.data(), 1, written, file) == (size_t)written;
+    fclose(file);
+
+    remove(path.c_str()); //rename doesn't replace existing files on Windows
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0)
+        remove(temporary.c_str());
+}
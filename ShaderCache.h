@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+
+//SHADER PROGRAM CACHE
+//***********************************************************
+/*
+  Compiling and linking GLSL happens inside the driver and is slow, and it happens again on every launch even though the
+  sources rarely change. With GL 4.1 / ARB_get_program_binary a linked program can be saved with glGetProgramBinary and
+  restored later with glProgramBinary, skipping the compiler entirely.
+
+  Binaries are only valid for the exact driver that produced them, so the cache key is a hash of the shader sources plus
+  the GL vendor, renderer and version strings. A driver update changes the version string and so misses the cache instead
+  of loading a stale binary. The driver may still reject a binary (glProgramBinary then fails the link status), in
+  which case the caller compiles from source and the entry is rewritten.
+
+  Each program is one file in the cache directory named after its key.
+*/
+
+class ShaderCache
+{
+public:
+    ShaderCache();
+
+    //Needs a current context. Returns false (and stays disabled) when the driver has no program binary formats.
+    bool init(const char* directory);
+    bool enabled() const { return active; }
+
+    //Returns a linked program restored from the cache, or 0 on a miss or if the driver rejected the binary.
+    GLuint load(const char* vertexSource, const char* fragmentSource);
+
+    //Saves a linked program. The program must have been created with prepareForStore() before linking.
+    void store(GLuint program, const char* vertexSource, const char* fragmentSource);
+
+    //Asks the driver to keep the binary retrievable. Call between glCreateProgram and glLinkProgram.
+    void prepareForStore(GLuint program) const;
+
+    unsigned int hitCount() const { return hits; }
+    unsigned int missCount() const { return misses; }
+
+private:
+    unsigned long long keyFor(const char* vertexSource, const char* fragmentSource) const;
+    std::string pathFor(unsigned long long key) const;
+
+    bool active;
+    std::string cacheDirectory;
+    std::string driverId; //vendor + renderer + version, part of every key
+    unsigned int hits;
+    unsigned int misses;
+};
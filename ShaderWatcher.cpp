@@ -0,0 +1,157 @@
+#include "ShaderWatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+const int ShaderWatcher::MAX_FILES;
+const int ShaderWatcher::POLL_INTERVAL_MS;
+
+//time is the modification time in the finest unit the platform reports (st_mtime alone only has whole seconds, and a
+//save of the same size within the second of the last look would go unnoticed)
+#ifdef _WIN32
+static bool statFile(const std::string& path, long long& time, long long& size)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info))
+        return false;
+    time = ((long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime; //100 ns ticks
+    size = ((long long)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    return true;
+}
+#else
+static bool statFile(const std::string& path, long long& time, long long& size)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+#ifdef __APPLE__
+    time = (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+    time = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+    size = (long long)info.st_size;
+    return true;
+}
+#endif
+
+static bool readFile(const std::string& path, std::string& text)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    text.clear();
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    fclose(file);
+    return true;
+}
+
+ShaderWatcher::ShaderWatcher()
+    : count(0), running(false), changed(0)
+{
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    stop();
+}
+
+int ShaderWatcher::watch(const std::string& path)
+{
+    if (count == MAX_FILES || thread.joinable())
+        return -1;
+
+    File& file = files[count];
+    if (!statFile(path, file.time, file.size) || !readFile(path, file.content))
+        return -1;
+    file.path = path;
+    file.seenTime = file.time;
+    file.seenSize = file.size;
+    return count++;
+}
+
+void ShaderWatcher::start()
+{
+    if (thread.joinable() || count == 0)
+        return;
+    running = true;
+    thread = std::thread(&ShaderWatcher::threadMain, this);
+}
+
+void ShaderWatcher::stop()
+{
+    if (!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+unsigned int ShaderWatcher::takeChanges()
+{
+    //the common case: nothing changed, no lock
+    unsigned int mask = changed.exchange(0, std::memory_order_acquire);
+    if (!mask)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < count; i++)
+        if (mask & (1u << i))
+            files[i].content.swap(files[i].loaded);
+    return mask;
+}
+
+void ShaderWatcher::threadMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running)
+    {
+        wake.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS));
+        if (!running)
+            break;
+        lock.unlock();
+
+        for (int i = 0; i < count; i++)
+        {
+            File& file = files[i];
+            long long time, size;
+            if (!statFile(file.path, time, size)) //being replaced right now, look again next time
+                continue;
+            if (time == file.time && size == file.size)
+                continue;
+
+            //only read it once two looks in a row agree, so a half-written file isn't picked up
+            if (time != file.seenTime || size != file.seenSize)
+            {
+                file.seenTime = time;
+                file.seenSize = size;
+                continue;
+            }
+
+            std::string text;
+            if (!readFile(file.path, text) || text.empty())
+                continue;
+            file.time = time;
+            file.size = size;
+
+            std::lock_guard<std::mutex> handOver(mutex);
+            file.loaded.swap(text);
+            changed.fetch_or(1u << i, std::memory_order_release);
+        }
+
+        lock.lock();
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//SHADER FILE WATCHER
+//***********************************************************
+/*
+  Shader sources are read from files so they can be edited while the program runs. A background thread looks at the
+  modification time and size of every watched file a few times a second. When one changes it waits for the next look
+  to see the same values (editors often truncate a file and write it in several steps), reads it and hands the new
+  text over.
+
+  The render thread calls takeChanges() once per frame. Without changes that is a single atomic load; with changes it
+  copies the new text out under a short lock. Everything slow (stat, reading the file) happens on the watcher thread,
+  and the recompile itself goes through ShaderBatch::replace(), so saving a shader never stalls a frame.
+
+  The modification time is compared to the nanosecond (st_mtim, or the 100 ns FILETIME on Windows), not to the second:
+  a one-character edit keeps the size, and a save within the same second would look like no change at all. The files
+  are only stat()ed, no OS change notifications: it's the same code on every platform and a few stat calls
+  every 250 ms cost nothing.
+*/
+
+class ShaderWatcher
+{
+public:
+    static const int MAX_FILES = 16;          //takeChanges() returns a bit per file
+    static const int POLL_INTERVAL_MS = 250;
+
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    //Reads path and starts tracking it. Returns the file's index, or -1 if it can't be read. Only before start().
+    int watch(const std::string& path);
+
+    void start();
+    void stop();
+
+    //Render thread. Returns a bit mask of the files that changed since the last call (bit i = index i) and updates
+    //their content().
+    unsigned int takeChanges();
+
+    //The newest text of the file that takeChanges() (or watch()) handed to the render thread.
+    const std::string& content(int index) const { return files[index].content; }
+    const std::string& path(int index) const { return files[index].path; }
+    int fileCount() const { return count; }
+
+private:
+    ShaderWatcher(const ShaderWatcher&);
+    ShaderWatcher& operator=(const ShaderWatcher&);
+
+    struct File
+    {
+        std::string path;
+        long long time;    //modification time (platform units) and size the content was read at
+        long long size;
+        long long seenTime; //what the last look found, read once it stays the same
+        long long seenSize;
+        std::string loaded;  //read by the watcher thread, not yet taken
+        std::string content; //render thread side
+    };
+
+    void threadMain();
+
+    File files[MAX_FILES];
+    int count;
+    std::thread thread;
+    std::mutex mutex;              //guards File::loaded while it is handed over
+    std::condition_variable wake;  //stop() doesn't wait out the poll interval
+    bool running;
+    std::atomic<unsigned int> changed;
+};
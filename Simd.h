@@ -0,0 +1,117 @@
+#pragma once
+
+//SIMD
+//***********************************************************
+/*
+  A few 4-wide float operations on top of SSE (every x86-64 CPU, and 32-bit MSVC builds with /arch:SSE2, the default)
+  or NEON (ARM), with a plain array fallback for anything else. The kernels in InstanceStore are written once against
+  these and compile to one instruction per call on both instruction sets.
+
+  Masks are floats with all bits set (true) or clear (false) per lane, the way both instruction sets return comparisons.
+  maskBits() packs them into the low four bits of an int: lane 0 = bit 0.
+
+  4 lanes and not AVX's 8: the project builds without /arch:AVX, and a binary that uses AVX crashes on the CPUs that
+  don't have it. The kernels are bound by memory bandwidth long before the extra lanes would matter.
+*/
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace simd
+{
+
+#if defined(SIMD_SSE)
+
+typedef __m128 float4;
+
+inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+inline float4 splat(float value) { return _mm_set1_ps(value); }
+inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 madd(float4 a, float4 b, float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); } //a * b + c
+inline float4 negate(float4 a) { return _mm_sub_ps(_mm_setzero_ps(), a); }
+inline float4 greaterEqual(float4 a, float4 b) { return _mm_cmpge_ps(a, b); }
+inline float4 maskAnd(float4 a, float4 b) { return _mm_and_ps(a, b); }
+inline int maskBits(float4 mask) { return _mm_movemask_ps(mask); }
+
+//rows a, b, c, d -> columns, in place
+inline void transpose(float4& a, float4& b, float4& c, float4& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+#elif defined(SIMD_NEON)
+
+typedef float32x4_t float4;
+
+inline float4 load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 splat(float value) { return vdupq_n_f32(value); }
+inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 madd(float4 a, float4 b, float4 c) { return vmlaq_f32(c, a, b); }
+inline float4 negate(float4 a) { return vnegq_f32(a); }
+inline float4 greaterEqual(float4 a, float4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+inline float4 maskAnd(float4 a, float4 b)
+{
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline int maskBits(float4 mask)
+{
+    //no movemask on NEON: keep each lane's bit weight where the mask is set and add the lanes up
+    static const uint32_t weights[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(weights));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return (int)(vget_lane_u32(sum, 0) + vget_lane_u32(sum, 1));
+}
+
+inline void transpose(float4& a, float4& b, float4& c, float4& d)
+{
+    float32x4x2_t ab = vtrnq_f32(a, b);
+    float32x4x2_t cd = vtrnq_f32(c, d);
+    a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+struct float4 { float v[4]; };
+
+inline float4 load(const float* p) { float4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+inline void store(float* p, float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+inline float4 splat(float value) { float4 r = { { value, value, value, value } }; return r; }
+inline float4 add(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+inline float4 mul(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+inline float4 madd(float4 a, float4 b, float4 c) { return add(mul(a, b), c); }
+inline float4 negate(float4 a) { for (int i = 0; i < 4; i++) a.v[i] = -a.v[i]; return a; }
+//masks stay 1.0 / 0.0 here, maskBits() only looks at != 0
+inline float4 greaterEqual(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] >= b.v[i] ? 1.0f : 0.0f; return a; }
+inline float4 maskAnd(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] != 0.0f && b.v[i] != 0.0f ? 1.0f : 0.0f; return a; }
+inline int maskBits(float4 mask)
+{
+    int bits = 0;
+    for (int i = 0; i < 4; i++)
+        bits |= (mask.v[i] != 0.0f) << i;
+    return bits;
+}
+
+inline void transpose(float4& a, float4& b, float4& c, float4& d)
+{
+    float4 rows[4] = { a, b, c, d };
+    for (int i = 0; i < 4; i++)
+    {
+        a.v[i] = rows[i].v[0];
+        b.v[i] = rows[i].v[1];
+        c.v[i] = rows[i].v[2];
+        d.v[i] = rows[i].v[3];
+    }
+}
+
+#endif
+
+} //namespace simd
@@ -55,23 +55,126 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <vector>
+
+#include "AppOptions.h"
+#include "Renderer.h"
+#include "StartupTimer.h"
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// it runs on the main thread, which doesn't own the context, so the new size is forwarded to the render thread
+// where glViewport is called
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    //Set the size of the rendering window.
-    // make sure the viewport matches the new window dimensions; note that width and 
-    // height will be significantly larger than specified on retina displays.
-    //First 2 parameters set the location of the lower left corner of the window
-    //The 3rd and 4th set the width and height of the rendering window in pixels
-    glViewport(0, 0, width, height);
+    Renderer* renderer = (Renderer*)glfwGetWindowUserPointer(window);
+    renderer->postEvent(RenderEvent::RESIZE, width, height);
+}
+
+// --windows: the other windows only scale their copy of the frame to the new size, the scene isn't drawn again
+void extra_framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    Renderer* renderer = (Renderer*)glfwGetWindowUserPointer(window);
+    renderer->resizeWindow(window, width, height);
+}
+
+// glfw: the window contents were lost (uncovered, restored from minimized), so with --idle the last frame has to be
+// drawn again even though nothing changed
+void window_refresh_callback(GLFWwindow* window)
+{
+    Renderer* renderer = (Renderer*)glfwGetWindowUserPointer(window);
+    renderer->postEvent(RenderEvent::REDRAW);
+}
+
+// input: GLFW calls these from glfwWaitEvents the moment the OS hands the event over, and postEvent stamps it with
+// that time. Nothing is polled once per frame any more, so a key press is neither late by a frame nor missed.
+// in instanced mode UP/DOWN multiply/divide the instance count by 10; the render thread ignores them otherwise
+// +/- zoom the instanced view, WASD or dragging with the left button pan it, V cycles the frame pacing modes
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    (void)scancode;
+    (void)mods;
+    Renderer* renderer = (Renderer*)glfwGetWindowUserPointer(window);
+
+    if (action == GLFW_PRESS)
+    {
+        switch (key)
+        {
+        case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(window, true); break;
+        case GLFW_KEY_UP: renderer->postEvent(RenderEvent::MORE_INSTANCES); break;
+        case GLFW_KEY_DOWN: renderer->postEvent(RenderEvent::FEWER_INSTANCES); break;
+        case GLFW_KEY_EQUAL:
+        case GLFW_KEY_KP_ADD: renderer->postEvent(RenderEvent::ZOOM_IN); break;
+        case GLFW_KEY_MINUS:
+        case GLFW_KEY_KP_SUBTRACT: renderer->postEvent(RenderEvent::ZOOM_OUT); break;
+        case GLFW_KEY_V: renderer->postEvent(RenderEvent::CYCLE_PACING); break;
+        case GLFW_KEY_T: renderer->postEvent(RenderEvent::CYCLE_TEXTURE); break;
+        default: break;
+        }
+    }
+
+    // the pan keys only send an event when the held direction changes (key repeat doesn't), the render thread moves
+    // the view for exactly as long as they are held
+    static bool left = false, right = false, up = false, down = false;
+    if (action == GLFW_REPEAT)
+        return;
+    bool held = action == GLFW_PRESS;
+    switch (key)
+    {
+    case GLFW_KEY_A: left = held; break;
+    case GLFW_KEY_D: right = held; break;
+    case GLFW_KEY_W: up = held; break;
+    case GLFW_KEY_S: down = held; break;
+    default: return;
+    }
+    static int directionX = 0, directionY = 0;
+    int x = (int)right - (int)left;
+    int y = (int)up - (int)down;
+    if (x != directionX || y != directionY)
+    {
+        directionX = x;
+        directionY = y;
+        renderer->postEvent(RenderEvent::PAN_KEYS, x, y);
+    }
+}
+
+// dragging with the left button: the cursor movement is summed up here and sent in framebuffer pixels. Moves that
+// don't fit into the event queue stay in the sum and go out with the next one instead of being lost.
+static bool dragging = false;
+static double dragX = 0.0, dragY = 0.0;       // last cursor position, in window coordinates
+static double pendingX = 0.0, pendingY = 0.0; // movement not sent yet, in framebuffer pixels
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    (void)mods;
+    if (button != GLFW_MOUSE_BUTTON_LEFT)
+        return;
+    dragging = action == GLFW_PRESS;
+    glfwGetCursorPos(window, &dragX, &dragY);
+    pendingX = pendingY = 0.0;
 }
 
-// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
-void processInput(GLFWwindow* window)
+void cursor_position_callback(GLFWwindow* window, double x, double y)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    if (!dragging)
+        return;
+
+    // the cursor is in screen coordinates, which aren't pixels on high DPI displays
+    int windowWidth, windowHeight, framebufferWidth, framebufferHeight;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    if (windowWidth <= 0 || windowHeight <= 0)
+        return;
+    pendingX += (x - dragX) * framebufferWidth / windowWidth;
+    pendingY += (y - dragY) * framebufferHeight / windowHeight;
+    dragX = x;
+    dragY = y;
+
+    int moveX = (int)pendingX, moveY = (int)pendingY;
+    if ((moveX || moveY) && ((Renderer*)glfwGetWindowUserPointer(window))->tryPostEvent(RenderEvent::DRAG, moveX, moveY))
+    {
+        pendingX -= moveX;
+        pendingY -= moveY;
+    }
 }
 
 //Settings
@@ -80,29 +183,23 @@ const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 //----------------------------------------
 
+int main(int argc, char** argv)
+{
+    //every step up to the first frame on screen is timed, see StartupTimer.h
+    startupTimer.begin();
 
-//Vertex and fragment shader code
-//----------------------------------------
-const char* vertexShaderSource = "#version 330 core\n"
-"layout (location = 0) in vec3 aPos;\n"
-"void main()\n"
-"{\n"
-"   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
-"}\0";
-
-const char* fragmentShaderSource = "#version 330 core\n"
-"out vec4 FragColor;\n"
-"void main()\n"
-"{\n"
-"   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
-"}\n\0";
-//----------------------------------------
+    // command line
+    //----------------------------------------
+    AppOptions options;
+    if (!parseCommandLine(argc, argv, options))
+        return -1;
+    startupTimer.mark("command line");
+    //----------------------------------------
 
-int main()
-{
     // glfw: initialize and configure
     //----------------------------------------
     glfwInit(); //Initialize GLFW
+    startupTimer.mark("glfwInit");
 
     //We configure GLFW with glfwWindowHint
     //First argument says what to configure, second argument is value of our option. Possible options: https://www.glfw.org/docs/latest/window.html#window_hints
@@ -111,6 +208,8 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    //a debug context makes the driver report errors and performance warnings through KHR_debug, see GLDebug.h
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, options.glDebug ? GLFW_TRUE : GLFW_FALSE);
     //----------------------------------------
 
     
@@ -120,7 +219,22 @@ int main()
 
     //first 2 arguments are width and height. The 3rd is the name of the window. Ignore the last 2 for now.
     //Returns a GLFWwindow object
-    GLFWwindow* window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL); 
+    //--gpu-cull needs compute shaders: ask for 4.3 first and settle for 3.3 (without culling) if the driver refuses
+    GLFWwindow* window = NULL;
+    if (options.gpuCull)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "WARNING::WINDOW::NO_GL_4_3_CONTEXT" << std::endl;
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        }
+    }
+    if (window == NULL)
+        window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
 
     //Checks that window is created.
     if (window == NULL)
@@ -130,153 +244,106 @@ int main()
         return -1;
     }
     glfwMakeContextCurrent(window); //Tell GLFW to make the context of our window the main context.
-    // ----------------------------------------
-
-    //Set the size of the rendering window
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    startupTimer.mark("window and context");
 
-    // glad: load all OpenGL function pointers
-    //----------------------------------------
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    //--mesh files are uploaded by a loader thread on a second context that shares the window's objects. Contexts only
+    //come with windows in GLFW, so it gets a hidden 1x1 one; the renderer falls back to uploading them itself without.
+    GLFWwindow* uploadWindow = NULL;
+    if (!options.meshFiles.empty())
     {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        uploadWindow = glfwCreateWindow(1, 1, "upload", NULL, window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+        startupTimer.mark("upload context");
     }
-    //----------------------------------------
-
 
-    // vertex shader
-    // ------------------------------------
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER); //Creates the variable for the name and sets it all in one line. glCreateShader creates a shader based on the enum parameter
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL); //links the shader code to our shader objects. 1st parameter: the shader object, 2nd: how many strings being passed in. 3rd: source code of shader. 4th: null
-    glCompileShader(vertexShader);
-
-    // check for shader compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    // ------------------------------------
-
-
-    // fragment shader
-    // ------------------------------------
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);//Creates the variable for the name and sets it all in one line. glCreateShader creates a shader based on the enum parameter
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);//links the shader code to our shader objects. 1st parameter: the shader object, 2nd: how many strings being passed in. 3rd: source code of shader. 4th: null
-    glCompileShader(fragmentShader);
-   
-    // check for shader compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    //--windows: every other window shares the objects too, so nothing is uploaded twice. Window i goes to the middle of
+    //monitor i while there are enough monitors (the first one is where the OS put the main window).
+    std::vector<GLFWwindow*> extraWindows;
+    int monitorCount = 0;
+    GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
+    for (int i = 1; i < options.windowCount; i++)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        GLFWwindow* extraWindow = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, window);
+        if (extraWindow == NULL)
+        {
+            std::cout << "WARNING::WINDOW::EXTRA_WINDOW_NOT_CREATED showing " << i << " windows" << std::endl;
+            break;
+        }
+        if (i < monitorCount)
+        {
+            int x, y, width, height;
+            glfwGetMonitorWorkarea(monitors[i], &x, &y, &width, &height);
+            glfwSetWindowPos(extraWindow, x + (width - 800) / 2, y + (height - 600) / 2);
+        }
+        extraWindows.push_back(extraWindow);
     }
-    // ------------------------------------
-
-
-    // link shaders togther
-    // ------------------------------------
+    if (!extraWindows.empty())
+        startupTimer.mark("extra windows");
+    // ----------------------------------------
 
-    //When linking shaders, the outputs of each shader is linked to the inputs of the next shader. Errors arise if inputs and outputs don't match.
-    unsigned int shaderProgram = glCreateProgram(); //creates program object called shaderProgram
-    glAttachShader(shaderProgram, vertexShader); //add shader
-    glAttachShader(shaderProgram, fragmentShader); //add shader
-    glLinkProgram(shaderProgram); //link shaders
-    
-    // check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    //Set the size of the rendering window
+    Renderer renderer(window, options, uploadWindow);
+    glfwSetWindowUserPointer(window, &renderer);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    //the other windows take the same input, only their size is their own
+    for (size_t i = 0; i < extraWindows.size(); i++)
+    {
+        renderer.addWindow(extraWindows[i]);
+        glfwSetWindowUserPointer(extraWindows[i], &renderer);
+        glfwSetFramebufferSizeCallback(extraWindows[i], extra_framebuffer_size_callback);
+        glfwSetWindowRefreshCallback(extraWindows[i], window_refresh_callback); //a new frame repaints every window
+        glfwSetKeyCallback(extraWindows[i], key_callback);
+        glfwSetMouseButtonCallback(extraWindows[i], mouse_button_callback);
+        glfwSetCursorPosCallback(extraWindows[i], cursor_position_callback);
     }
-    
-    glUseProgram(shaderProgram); //Sets the program to use whatever is passed in. 
-
-    //Shaders can be deleted after they are linked to program object
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    // ------------------------------------
+    startupTimer.mark("renderer and callbacks"); //the render thread marks everything after this
 
+    // render thread
+    //----------------------------------------
+    //From here on the context belongs to the render thread (see Renderer.h): it loads glad, creates the buffers and
+    //shaders and runs the render loop. This thread only handles window events.
+    renderer.start();
+    //----------------------------------------
 
-    // set up vertices for our triangle
-    // ------------------------------------------------------------------
-    float vertices[] = {
-        -0.5f, -0.5f, 0.0f, // left  
-         0.5f, -0.5f, 0.0f, // right 
-         0.0f,  0.5f, 0.0f  // top   
-    };
-    // ------------------------------------------------------------------
- 
-
-    //Vertex buffer object (VBO)
-    // ------------------------------------
-    unsigned int VBO; //declares varible to store ID for our VBO
-    glGenBuffers(1, &VBO); //creates the ID that is stored in VBO
-    glBindBuffer(GL_ARRAY_BUFFER, VBO); //VBO binded to GL_ARRAY_BUFFER so that anything working the GL_ARRAY_BUFFER is now working with VBO
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW); //memory is allocated on the GPU for data and vertex data is uploaded to VBO, since it is binded
-    // ------------------------------------   
-
-    //Vertex Array Objects
-    // ------------------------------------
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO); //same as before, create an ID for an object (the VAO here)
-    glBindVertexArray(VAO); //Binds the VAO
-    // ------------------------------------
-
-    //glVertexAttribPointer
-    // ------------------------------------
-    ////1st parameter: index/location of vertex attribute. 2nd: size of the vertex attribute. 3rd: type of the data. 4th: bool for normalized data. 5th: stride, AKA space between consectutive vertex attributes.
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0); //enables vertex attribute, they are disabled by default
-    // ------------------------------------
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0); //Unbinds the VBO
-    glBindVertexArray(0); //We unbind the VAO to not make any more changes to it. Optional, but good practice.
-
-    //Render loop.
-    while (!glfwWindowShouldClose(window))
+    //Event loop. Closing any of the windows ends the program.
+    bool closed = false;
+    while (!closed && !renderer.finished())
     {
-        // input
-        // ------------------------------------
-        processInput(window);
-        // ------------------------------------
-
-        //Background color
-        // ------------------------------------
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        // ------------------------------------
-               
-        // draw our first triangle
-        // ------------------------------------
-        glUseProgram(shaderProgram); //specificy which program to use
-        glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-        glDrawArrays(GL_TRIANGLES, 0, 3); //OpenGL functions based on the first parameter which is an enum.
-        // ------------------------------------
-      
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window); //swap the color buffer (a large 2D buffer that contains color values for each pixel in GLFW's window) that is used to render to during this render iteration and show it as output to the screen.
-        glfwPollEvents(); //checks if any events are triggered, updates window state, and calls corresponding functions (which we regist via callback methods)
-        // -------------------------------------------------------------------------------
+        //checks if any events are triggered, updates window state, and calls corresponding functions (which we regist via callback methods)
+        //input arrives through the callbacks above, so this thread can sleep until the next event; the render thread
+        //wakes it with glfwPostEmptyEvent for a new title and when it is done
+        glfwWaitEvents();
+
+        //overlay the rolling frame stats in the window title; only this thread may set it
+        char title[192];
+        if (renderer.takeTitle(title, sizeof(title)))
+        {
+            glfwSetWindowTitle(window, title);
+            for (size_t i = 0; i < extraWindows.size(); i++)
+                glfwSetWindowTitle(extraWindows[i], title);
+        }
+
+        closed = glfwWindowShouldClose(window) != 0;
+        for (size_t i = 0; i < extraWindows.size(); i++)
+            closed = closed || glfwWindowShouldClose(extraWindows[i]) != 0;
     }
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram);
-    // ------------------------------------------------------------------------
+    //lets the render thread finish its frame and delete its GL objects
+    renderer.stop();
+    int exitCode = renderer.exitCode();
+    if (uploadWindow)
+        glfwDestroyWindow(uploadWindow);
+    for (size_t i = 0; i < extraWindows.size(); i++)
+        glfwDestroyWindow(extraWindows[i]); //their presenter threads ended with the render thread
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
-    return 0;
+    return exitCode;
     // ------------------------------------------------------------------ 
 }
-
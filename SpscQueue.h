@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+//LOCK-FREE QUEUE
+//***********************************************************
+/*
+  A bounded single-producer / single-consumer ring buffer. Exactly one thread may push and exactly one (other) thread may
+  pop; with that restriction no locks are needed, only two atomic indices:
+
+  The producer writes the item, then publishes it by storing the new tail with release ordering. The consumer reads the
+  tail with acquire ordering, so once it sees the new tail it is guaranteed to also see the item. The same pairing on the
+  head tells the producer a slot is free again.
+
+  head and tail are padded apart onto separate cache lines so the two threads don't keep stealing the same line from
+  each other. Padding instead of alignas(64) keeps the queue usable inside heap-allocated objects, which C++14's
+  operator new doesn't over-align.
+  Capacity must be a power of two; the queue holds at most Capacity - 1 items.
+*/
+
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    //producer thread only; returns false when the queue is full
+    bool push(const T& item)
+    {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        size_t nextTail = (currentTail + 1) & (Capacity - 1);
+        if (nextTail == head.load(std::memory_order_acquire))
+            return false;
+        items[currentTail] = item;
+        tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    //consumer thread only; returns false when the queue is empty
+    bool pop(T& item)
+    {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[currentHead];
+        head.store((currentHead + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    //only a hint when called from a third thread
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+
+    static const size_t CACHE_LINE = 64;
+
+    char padFront[CACHE_LINE];
+    std::atomic<size_t> head; //next slot to read, written by the consumer
+    char padHead[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail; //next slot to write, written by the producer
+    char padTail[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    T items[Capacity];
+};
@@ -0,0 +1,58 @@
+#include "StartupTimer.h"
+
+#include <cstdio>
+#include <iostream>
+
+StartupTimer startupTimer;
+
+const int StartupTimer::MAX_PHASES;
+
+StartupTimer::StartupTimer()
+    : phaseCount(0), started(false), done(false)
+{
+}
+
+void StartupTimer::begin()
+{
+    start = Clock::now();
+    phaseCount = 0;
+    started = true;
+    done = false;
+}
+
+void StartupTimer::mark(const char* name)
+{
+    if (!started || done || phaseCount == MAX_PHASES)
+        return;
+    phases[phaseCount].name = name;
+    phases[phaseCount].end = Clock::now();
+    phaseCount++;
+}
+
+double StartupTimer::totalMs() const
+{
+    if (phaseCount == 0)
+        return 0.0;
+    return std::chrono::duration<double, std::milli>(phases[phaseCount - 1].end - start).count();
+}
+
+void StartupTimer::finish(const char* name, bool print)
+{
+    if (!started || done)
+        return;
+    mark(name);
+    done = true;
+    if (!print)
+        return;
+
+    std::cout << "Startup: " << totalMs() << " ms to the first presented frame" << std::endl;
+    Clock::time_point previous = start;
+    for (int i = 0; i < phaseCount; i++)
+    {
+        double ms = std::chrono::duration<double, std::milli>(phases[i].end - previous).count();
+        char line[96];
+        snprintf(line, sizeof(line), "  %8.2f ms  %s", ms, phases[i].name);
+        std::cout << line << std::endl;
+        previous = phases[i].end;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+
+//STARTUP TIMING
+//***********************************************************
+/*
+  The frame profiler only starts with the render loop, but a launch spends its first hundred milliseconds or more
+  before that: initializing GLFW, creating the window and its context, loading the GL entry points, submitting the
+  shaders, building and uploading the meshes. StartupTimer cuts that time into named phases from the start of main()
+  up to the first frame that was presented, and prints them once that frame is on screen.
+
+  mark(name) ends the phase that ran since the previous mark and calls it name. The main thread marks its phases until
+  it starts the render thread, the render thread marks everything after that; starting the thread orders the two, so
+  there is no lock. Every mark after finish() is ignored, and a mark never allocates.
+*/
+
+class StartupTimer
+{
+public:
+    static const int MAX_PHASES = 24;
+
+    StartupTimer();
+
+    //Resets the clock; the first phase starts here. Call it first thing in main().
+    void begin();
+
+    //Ends the current phase and names it. name must outlive the timer (a string literal).
+    void mark(const char* name);
+
+    //Marks the last phase and prints the breakdown, once. Does nothing if begin() wasn't called.
+    void finish(const char* name, bool print);
+    bool finished() const { return done; }
+
+    //Milliseconds from begin() to finish().
+    double totalMs() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Phase
+    {
+        const char* name;
+        Clock::time_point end;
+    };
+
+    Clock::time_point start;
+    Phase phases[MAX_PHASES];
+    int phaseCount;
+    bool started;
+    bool done;
+};
+
+extern StartupTimer startupTimer;
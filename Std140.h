@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+
+//STD140 LAYOUT
+//***********************************************************
+/*
+  A uniform block declared with layout (std140) has a layout every driver agrees on, so the CPU can fill it with a plain
+  struct and copy it into a buffer as is. The C++ struct only matches if every member sits at the offset the std140
+  rules give it:
+
+      float, int, uint     4 byte aligned
+      vec2                 8 byte aligned
+      vec3, vec4           16 byte aligned (a vec3 is 12 bytes, a float may follow in the remaining 4)
+      mat4                 four vec4 columns
+      arrays, structs      every element 16 byte aligned, even arrays of float
+
+  The types below carry those alignments, so member offsets come out right on their own as long as a block sticks to
+  scalars, vec2, vec4 and mat4. vec3 is left out on purpose: alignas(16) would round its size up to 16 and shift
+  whatever follows it. Use a vec4, or a vec2 and a float. Array elements go through padded<T>.
+
+  Each block then states the offsets it expects with STD140_OFFSET and STD140_SIZE, so a member added in the wrong
+  place fails to compile instead of reading garbage in the shader.
+*/
+
+namespace std140
+{
+
+struct alignas(8) vec2
+{
+    float x, y;
+};
+
+struct alignas(16) vec4
+{
+    float x, y, z, w;
+};
+
+struct alignas(16) mat4
+{
+    vec4 columns[4];
+};
+
+//one element of an array inside a block: every element starts on a 16 byte boundary
+template <class T>
+struct alignas(16) padded
+{
+    T value;
+};
+
+} // namespace std140
+
+//offsets are the ones glGetActiveUniformsiv(GL_UNIFORM_OFFSET) reports for the GLSL block
+#define STD140_OFFSET(Block, member, offset) \
+    static_assert(offsetof(Block, member) == (offset), #Block "::" #member " isn't at its std140 offset")
+
+//rounded up to a multiple of 16, the way GL_UNIFORM_BLOCK_DATA_SIZE reports it
+#define STD140_SIZE(Block, size) \
+    static_assert(sizeof(Block) == (size), #Block " doesn't have its std140 size")
@@ -0,0 +1,124 @@
+#include "StreamBuffer.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+
+const int StreamBuffer::REGION_COUNT;
+
+StreamBuffer::StreamBuffer()
+    : bufferTarget(GL_ARRAY_BUFFER), bufferMode(MODE_MAP_RANGE), bytesPerRegion(0), currentRegion(0),
+      persistentPointer(NULL), mappedRegion(NULL), stalls(0), orphans(0)
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    //GL objects need a current context, so they are released in shutdown() and not here; the wrappers only queue
+    //what is left for deletion
+}
+
+bool StreamBuffer::init(GLenum target, size_t regionSize, bool forceMapRange)
+{
+    shutdown();
+
+    bufferTarget = target;
+    bytesPerRegion = regionSize;
+    currentRegion = 0;
+    GLsizeiptr totalSize = (GLsizeiptr)(regionSize * REGION_COUNT);
+
+    bufferObject.create("stream buffer");
+    GLStateCache::current().bindBuffer(bufferTarget, bufferObject.get());
+
+    if (glext.bufferStorage && !forceMapRange)
+    {
+        // persistent mapping: immutable storage, mapped once
+        // ------------------------------------
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glext.BufferStorage(bufferTarget, totalSize, NULL, flags);
+        persistentPointer = (char*)glMapBufferRange(bufferTarget, 0, totalSize, flags);
+        if (persistentPointer)
+        {
+            bufferMode = MODE_PERSISTENT;
+            return true;
+        }
+
+        //storage is immutable, so a failed map means starting over with a normal buffer
+        bufferObject.create("stream buffer");
+        GLStateCache::current().bindBuffer(bufferTarget, bufferObject.get());
+        // ------------------------------------
+    }
+
+    bufferMode = MODE_MAP_RANGE;
+    glBufferData(bufferTarget, totalSize, NULL, GL_STREAM_DRAW);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void StreamBuffer::shutdown()
+{
+    if (!bufferObject)
+        return;
+
+    for (int i = 0; i < REGION_COUNT; i++)
+        fences[i].reset();
+    GLStateCache::current().bindBuffer(bufferTarget, bufferObject.get());
+    if (persistentPointer || mappedRegion)
+        glUnmapBuffer(bufferTarget);
+    bufferObject.reset(); //deleted once the frames still reading it are done
+
+    persistentPointer = NULL;
+    mappedRegion = NULL;
+}
+
+void StreamBuffer::waitForRegion(int region)
+{
+    //normally the GPU finished this region a couple of frames ago and the fence is already signaled
+    if (!fences[region].wait())
+        stalls++;
+    fences[region].reset();
+}
+
+void* StreamBuffer::beginWrite()
+{
+    GLStateCache::current().bindBuffer(bufferTarget, bufferObject.get());
+
+    if (bufferMode == MODE_PERSISTENT)
+    {
+        waitForRegion(currentRegion);
+        return persistentPointer + regionOffset();
+    }
+
+    //map-range: if the GPU is still busy with this region, orphan instead of waiting
+    if (!fences[currentRegion].signaled())
+    {
+        orphans++;
+        glBufferData(bufferTarget, (GLsizeiptr)(bytesPerRegion * REGION_COUNT), NULL, GL_STREAM_DRAW);
+        for (int i = 0; i < REGION_COUNT; i++)
+            fences[i].reset(); //the new storage isn't read by anything yet
+    }
+    fences[currentRegion].reset();
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    mappedRegion = glMapBufferRange(bufferTarget, (GLintptr)regionOffset(), (GLsizeiptr)bytesPerRegion, access);
+    return mappedRegion;
+}
+
+void StreamBuffer::endWrite()
+{
+    if (bufferMode == MODE_MAP_RANGE && mappedRegion)
+    {
+        GLStateCache::current().bindBuffer(bufferTarget, bufferObject.get());
+        glUnmapBuffer(bufferTarget);
+        mappedRegion = NULL;
+    }
+    //persistent + coherent: writes become visible to commands issued after this point, nothing to do
+}
+
+void StreamBuffer::endFrame()
+{
+    fences[currentRegion].insert();
+    currentRegion = (currentRegion + 1) % REGION_COUNT;
+}
+
+const char* StreamBuffer::modeName(Mode mode)
+{
+    return mode == MODE_PERSISTENT ? "persistent" : "map-range";
+}
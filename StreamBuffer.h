@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+#include "GLResource.h"
+
+//STREAMING BUFFERS
+//***********************************************************
+/*
+  Data that changes every frame shouldn't go through glBufferData/glBufferSubData: the driver has to copy it out of our
+  memory, and if the GPU is still reading the buffer it either stalls or secretly allocates a new one.
+
+  A StreamBuffer is one buffer object split into REGION_COUNT equal regions. Each frame the CPU writes into one region
+  while the GPU is still reading the regions of the previous frames. After the draws that read a region are submitted we
+  put a fence (glFenceSync) behind them; before the CPU writes that region again it checks the fence, so it never
+  overwrites data the GPU hasn't consumed yet.
+
+  Persistent mode (GL 4.4 / ARB_buffer_storage):
+  The storage is created with glBufferStorage(GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) and mapped once for the
+  lifetime of the buffer. Writes go straight into memory the GPU can read: no map/unmap calls and no driver copies.
+
+  Map-range mode (plain GL 3.3):
+  The current region is mapped each frame with glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT), which is safe because the
+  fence already told us the GPU is done with it. If the fence isn't signaled yet we orphan the buffer (glBufferData with
+  NULL) instead of waiting: the driver hands us fresh storage and frees the old one once the GPU is finished with it.
+*/
+
+class StreamBuffer
+{
+public:
+    enum Mode
+    {
+        MODE_PERSISTENT,
+        MODE_MAP_RANGE
+    };
+
+    static const int REGION_COUNT = 3; //frames the CPU may run ahead of the GPU
+
+    StreamBuffer();
+    ~StreamBuffer();
+
+    //Creates the buffer with regionSize bytes per region. Persistent mode is used when the context supports it unless
+    //forceMapRange is set. Leaves the buffer bound to target.
+    bool init(GLenum target, size_t regionSize, bool forceMapRange = false);
+    void shutdown();
+
+    //Returns a pointer to the current region, waiting for (persistent) or orphaning (map-range) if the GPU still reads
+    //it. The buffer is bound to its target afterwards.
+    void* beginWrite();
+
+    //Ends the CPU writes to the current region. In map-range mode this unmaps it, after which the pointer is invalid.
+    void endWrite();
+
+    //Call after submitting every draw that reads the current region: fences it and moves on to the next one.
+    void endFrame();
+
+    GLuint buffer() const { return bufferObject.get(); }
+    Mode mode() const { return bufferMode; }
+    size_t regionSize() const { return bytesPerRegion; }
+    size_t regionOffset() const { return currentRegion * bytesPerRegion; } //byte offset of the current region
+
+    //how often beginWrite had to wait for / orphan a region because the GPU fell behind
+    unsigned long long stallCount() const { return stalls; }
+    unsigned long long orphanCount() const { return orphans; }
+
+    static const char* modeName(Mode mode);
+
+private:
+    StreamBuffer(const StreamBuffer&);
+    StreamBuffer& operator=(const StreamBuffer&);
+
+    void waitForRegion(int region);
+
+    GLenum bufferTarget;
+    GLBuffer bufferObject;
+    Mode bufferMode;
+    size_t bytesPerRegion;
+    int currentRegion;
+    char* persistentPointer; //whole buffer, persistent mode only
+    void* mappedRegion;      //current region, map-range mode only
+    GLFence fences[REGION_COUNT]; //one per region, behind the last commands that read it
+    unsigned long long stalls;
+    unsigned long long orphans;
+};
@@ -0,0 +1,279 @@
+#include "TextureManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+
+const int TextureManager::MAX_TEXTURES;
+const size_t TextureManager::UPLOAD_BUDGET;
+const int TextureManager::MAX_UPLOADS;
+
+//chunks start on this boundary inside the pixel buffer, which covers the row alignment of every format
+static const size_t UPLOAD_ALIGNMENT = 16;
+
+bool textureFormatSupported(const TextureFormat& format)
+{
+    switch (format.family)
+    {
+    case TextureFormat::FAMILY_UNCOMPRESSED: return true;
+    case TextureFormat::FAMILY_RGTC: return true; //core since GL 3.0
+    case TextureFormat::FAMILY_S3TC: return glext.textureS3tc;
+    case TextureFormat::FAMILY_S3TC_SRGB: return glext.textureS3tcSrgb;
+    case TextureFormat::FAMILY_BPTC: return glext.textureBptc;
+    case TextureFormat::FAMILY_ETC2: return glext.textureEtc2;
+    case TextureFormat::FAMILY_ASTC: return glext.textureAstc;
+    }
+    return false;
+}
+
+TextureManager::TextureManager()
+    : textureCount(0), arrayTotal(0), pendingCount(0), uploaded(0), frames(0)
+{
+}
+
+bool TextureManager::init(const std::vector<const char*>& files, bool forceMapRange, bool verbose)
+{
+    shutdown();
+
+    // read the headers and sort the textures into arrays
+    // ------------------------------------
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (textureCount == MAX_TEXTURES)
+        {
+            std::cout << "WARNING::TEXTURE::TOO_MANY_TEXTURES only the first " << MAX_TEXTURES << " are loaded" << std::endl;
+            break;
+        }
+        Texture& t = textures[textureCount];
+        if (!t.file.open(files[i]))
+        {
+            std::cout << "ERROR::TEXTURE::FILE_NOT_READ " << files[i] << std::endl;
+            continue;
+        }
+        if (!t.view.parse(t.file.data(), t.file.size()))
+        {
+            std::cout << "ERROR::TEXTURE::NOT_LOADED " << files[i] << std::endl;
+            t.file.close();
+            continue;
+        }
+        const TextureFormat& format = t.view.format();
+        if (!textureFormatSupported(format))
+        {
+            std::cout << "ERROR::TEXTURE::UNSUPPORTED_FORMAT " << format.name << " in " << files[i] << std::endl;
+            t.file.close();
+            continue;
+        }
+
+        //one array per format, size and level count; every layer of an array has all three in common
+        int a = 0;
+        while (a < arrayTotal && !(arrays[a].format == &format && arrays[a].width == t.view.width() &&
+            arrays[a].height == t.view.height() && arrays[a].levels == t.view.levelCount()))
+            a++;
+        if (a == arrayTotal)
+        {
+            arrays[a].format = &format;
+            arrays[a].width = t.view.width();
+            arrays[a].height = t.view.height();
+            arrays[a].levels = t.view.levelCount();
+            arrays[a].layers = 0;
+            arrayTotal++;
+        }
+        t.path = files[i];
+        t.array = a;
+        t.layer = arrays[a].layers++;
+        t.nextLevel = t.view.levelCount() - 1;
+        t.nextRow = 0;
+        t.finestLevel = t.view.levelCount();
+        textureCount++;
+        pendingCount++;
+        if (verbose)
+            std::cout << "Texture: " << files[i] << ", " << t.view.width() << "x" << t.view.height() << " " << format.name
+                << ", " << t.view.levelCount() << " levels, array " << a << " layer " << t.layer << std::endl;
+    }
+    if (textureCount == 0)
+        return false;
+    // ------------------------------------
+
+    // storage for every level now, the data later
+    // ------------------------------------
+    for (int a = 0; a < arrayTotal; a++)
+    {
+        if (!allocate(arrays[a]))
+        {
+            std::cout << "ERROR::TEXTURE::ALLOCATION_FAILED " << arrays[a].width << "x" << arrays[a].height << " "
+                << arrays[a].format->name << " x " << arrays[a].layers << std::endl;
+            shutdown();
+            return false;
+        }
+    }
+    if (!pixelBuffer.init(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUDGET, forceMapRange))
+    {
+        std::cout << "ERROR::TEXTURE::PIXEL_BUFFER_CREATION_FAILED" << std::endl;
+        shutdown();
+        return false;
+    }
+    //a bound unpack buffer turns the data pointer of every glTexImage into an offset, so it is only bound in update()
+    GLStateCache::current().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (verbose)
+        std::cout << "Textures: " << textureCount << " in " << arrayTotal << " arrays, "
+            << (glext.textureStorage ? "immutable storage" : "mutable storage") << ", streamed through "
+            << StreamBuffer::modeName(pixelBuffer.mode()) << " pixel buffers" << std::endl;
+    // ------------------------------------
+    return true;
+}
+
+bool TextureManager::allocate(TextureArray& array)
+{
+    if (!array.texture.create("texture array"))
+        return false;
+    GLStateCache::current().bindTexture(0, GL_TEXTURE_2D_ARRAY, array.texture.get());
+    const TextureFormat& format = *array.format;
+    if (glext.textureStorage)
+        glext.TexStorage3D(GL_TEXTURE_2D_ARRAY, array.levels, format.internalFormat, array.width, array.height,
+            array.layers);
+    else
+    {
+        for (int level = 0; level < array.levels; level++)
+        {
+            int width = std::max(1, array.width >> level);
+            int height = std::max(1, array.height >> level);
+            if (format.compressed())
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, width, height, array.layers, 0,
+                    (GLsizei)(format.levelBytes(width, height) * array.layers), NULL);
+            else
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, width, height, array.layers, 0, GL_RGBA,
+                    GL_UNSIGNED_BYTE, NULL);
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, array.levels - 1);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void TextureManager::shutdown()
+{
+    pixelBuffer.shutdown();
+    for (int a = 0; a < arrayTotal; a++)
+        arrays[a].texture.reset();
+    for (int t = 0; t < textureCount; t++)
+        textures[t].file.close();
+    textureCount = 0;
+    arrayTotal = 0;
+    pendingCount = 0;
+}
+
+int TextureManager::nextTexture() const
+{
+    int best = -1;
+    size_t bestBytes = 0;
+    for (int t = 0; t < textureCount; t++)
+    {
+        const Texture& texture = textures[t];
+        if (texture.nextLevel < 0)
+            continue;
+        size_t bytes = texture.view.levelBytes(texture.nextLevel);
+        if (best < 0 || bytes < bestBytes)
+        {
+            best = t;
+            bestBytes = bytes;
+        }
+    }
+    return best;
+}
+
+bool TextureManager::update()
+{
+    if (pendingCount == 0)
+        return false;
+
+    // copy the next block rows into this frame's region
+    // ------------------------------------
+    //The uploads can only be issued once the region is unmapped again (map-range mode), so they are collected first.
+    char* region = (char*)pixelBuffer.beginWrite();
+    if (!region)
+        return false;
+    size_t used = 0;
+    int uploadCount = 0;
+    bool sharper = false;
+    while (uploadCount < MAX_UPLOADS)
+    {
+        int t = nextTexture();
+        if (t < 0)
+            break;
+        Texture& texture = textures[t];
+        const TextureFormat& format = texture.view.format();
+        int level = texture.nextLevel;
+        int width = texture.view.levelWidth(level);
+        int height = texture.view.levelHeight(level);
+        size_t rowBytes = format.levelBytes(width, format.blockHeight); //one row of blocks
+        int blockRows = (height + format.blockHeight - 1) / format.blockHeight;
+
+        //whole block rows only, GL takes compressed data in whole blocks
+        int rows = std::min(blockRows - texture.nextRow, (int)((UPLOAD_BUDGET - used) / rowBytes));
+        if (rows <= 0)
+            break; //the budget is used up
+        size_t bytes = rows * rowBytes;
+        memcpy(region + used, texture.view.levelData(level) + texture.nextRow * rowBytes, bytes);
+
+        Upload& upload = uploads[uploadCount++];
+        upload.texture = t;
+        upload.level = level;
+        upload.y = texture.nextRow * format.blockHeight;
+        upload.height = std::min(rows * format.blockHeight, height - upload.y);
+        upload.offset = (GLintptr)(pixelBuffer.regionOffset() + used);
+        upload.bytes = bytes;
+        used = std::min(UPLOAD_BUDGET, (used + bytes + UPLOAD_ALIGNMENT - 1) & ~(UPLOAD_ALIGNMENT - 1));
+
+        texture.nextRow += rows;
+        if (texture.nextRow == blockRows)
+        {
+            texture.nextLevel--;
+            texture.nextRow = 0;
+            if (texture.nextLevel < 0)
+            {
+                texture.file.close(); //every byte of it is in the pixel buffer now
+                pendingCount--;
+            }
+        }
+    }
+    pixelBuffer.endWrite();
+    // ------------------------------------
+
+    // the uploads, read from the pixel buffer by the GPU
+    // ------------------------------------
+    GLStateCache& state = GLStateCache::current();
+    state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer.buffer());
+    for (int i = 0; i < uploadCount; i++)
+    {
+        const Upload& upload = uploads[i];
+        Texture& texture = textures[upload.texture];
+        const TextureFormat& format = texture.view.format();
+        int width = texture.view.levelWidth(upload.level);
+        state.bindTexture(0, GL_TEXTURE_2D_ARRAY, arrays[texture.array].texture.get());
+        if (format.compressed())
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, upload.level, 0, upload.y, texture.layer, width, upload.height,
+                1, format.internalFormat, (GLsizei)upload.bytes, (const void*)upload.offset);
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, upload.level, 0, upload.y, texture.layer, width, upload.height, 1,
+                GL_RGBA, GL_UNSIGNED_BYTE, (const void*)upload.offset);
+
+        //the shader may sample a level as soon as its last rows are queued; GL runs the upload before later draws
+        if (upload.y + upload.height == texture.view.levelHeight(upload.level))
+        {
+            texture.finestLevel = upload.level;
+            sharper = true;
+        }
+        uploaded += upload.bytes;
+    }
+    state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pixelBuffer.endFrame();
+    frames++;
+    // ------------------------------------
+    return sharper;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+#include "GLResource.h"
+#include "KtxFile.h"
+#include "MappedFile.h"
+#include "StreamBuffer.h"
+
+//TEXTURES
+//***********************************************************
+/*
+  Every --texture file is a KTX2 file (KtxFile.h) whose levels are already in a format the GPU samples directly, so
+  loading one is copying bytes; the manager's job is to copy them without stalling a frame and to keep the draws from
+  rebinding textures.
+
+  Immutable storage
+  glTexStorage3D (GL 4.2 / ARB_texture_storage) allocates every level at once with a format and size that can't change
+  afterwards. The driver knows the texture is complete from the start and never has to check again whether a later
+  glTexImage redefined a level. Without it each level is allocated with glTexImage3D / glCompressedTexImage3D and no
+  data, which gives the same texture with more checks behind it.
+
+  Texture arrays
+  Textures of the same format, size and level count share one GL_TEXTURE_2D_ARRAY, one layer each. Which one a draw
+  shows is then a layer index in a uniform block, not a glBindTexture, so every draw of the frame can pick its own
+  without the program or the bindings changing. Bindless handles (ARB_bindless_texture) would go further, any texture
+  from any draw, but they are an extension outside the GL 3.3 path this program keeps working on; arrays are core.
+
+  Mip streaming
+  Nothing is uploaded during setup. Each frame copies at most UPLOAD_BUDGET bytes out of the mapped files into a
+  StreamBuffer bound as GL_PIXEL_UNPACK_BUFFER, and the glCompressedTexSubImage3D / glTexSubImage3D calls read from that
+  pixel buffer instead of client memory: the call returns as soon as it is queued and the GPU copies on its own time.
+  The levels go coarsest first, for every texture before any gets its finer ones, so a texture shows blurry within a
+  frame or two and sharpens as the big levels arrive. Until then the shader clamps its level of detail to the finest
+  level that is there (finestLevel()); the levels below it hold whatever the allocation left in them.
+
+  A file stays mapped until its last level is in the pixel buffer, then it is closed (the page cache keeps nothing
+  alive for us). Render thread only; update() never allocates on the heap.
+*/
+
+class TextureManager
+{
+public:
+    static const int MAX_TEXTURES = 16;
+    static const size_t UPLOAD_BUDGET = 2 * 1024 * 1024; //bytes per frame, the size of one pixel buffer region
+    static const int MAX_UPLOADS = 64;                   //glTex*SubImage3D calls per frame
+
+    TextureManager();
+
+    //Maps and checks every file and allocates the arrays. Files that can't be read, or whose format the driver doesn't
+    //decode, are skipped with an error. Returns false if none is left.
+    bool init(const std::vector<const char*>& files, bool forceMapRange, bool verbose);
+    void shutdown();
+
+    //Once per frame, before the draws: uploads the next levels, as much as UPLOAD_BUDGET allows. Returns true if a
+    //texture got a finer level.
+    bool update();
+
+    int count() const { return textureCount; }
+    bool streaming() const { return pendingCount > 0; }
+
+    //Texture t's array and layer, and the finest level of it that is uploaded. resident() once it has any level.
+    GLuint texture(int t) const { return arrays[textures[t].array].texture.get(); }
+    int layer(int t) const { return textures[t].layer; }
+    int finestLevel(int t) const { return textures[t].finestLevel; }
+    bool resident(int t) const { return textures[t].finestLevel < textures[t].view.levelCount(); }
+    const char* path(int t) const { return textures[t].path; }
+
+    int arrayCount() const { return arrayTotal; }
+    size_t uploadedBytes() const { return uploaded; }
+    unsigned long long uploadFrames() const { return frames; } //frames update() uploaded anything in
+
+private:
+    TextureManager(const TextureManager&);
+    TextureManager& operator=(const TextureManager&);
+
+    struct Texture
+    {
+        const char* path;
+        MappedFile file;
+        KtxFileView view;
+        int array;
+        int layer;
+        int nextLevel;   //the next level to upload, counting down to 0; -1 when everything is uploaded
+        int nextRow;     //first block row of nextLevel that isn't uploaded yet
+        int finestLevel; //levelCount() until the coarsest level is there
+    };
+
+    struct TextureArray
+    {
+        GLTexture texture;
+        const TextureFormat* format;
+        int width;
+        int height;
+        int levels;
+        int layers;
+    };
+
+    //one glTex*SubImage3D from the pixel buffer
+    struct Upload
+    {
+        int texture;
+        int level;
+        int y;      //texels
+        int height;
+        GLintptr offset;
+        size_t bytes;
+    };
+
+    bool allocate(TextureArray& array);
+    int nextTexture() const; //the texture whose next level is the smallest, -1 if none is left
+
+    Texture textures[MAX_TEXTURES];
+    int textureCount;
+    TextureArray arrays[MAX_TEXTURES];
+    int arrayTotal;
+    int pendingCount; //textures with levels left to upload
+    StreamBuffer pixelBuffer;
+    Upload uploads[MAX_UPLOADS];
+    size_t uploaded;
+    unsigned long long frames;
+};
+
+//Whether the driver decodes format (see the flags in GLExtensions.h).
+bool textureFormatSupported(const TextureFormat& format);
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <iostream>
+
+#include "Std140.h"
+
+//UNIFORM BLOCKS
+//***********************************************************
+/*
+  Every uniform a shader reads comes from one of these blocks. They live in the UniformRing instead of program state,
+  so the CPU writes them with plain stores and a draw only needs a glBindBufferRange to see its own values, no matter
+  how many glUniform* calls that would have been.
+
+  Each block is declared twice, once as a C++ struct and once as the GLSL text that the shader sources paste in, right
+  next to each other so they are changed together. The static_asserts check the struct against the std140 offsets of
+  the GLSL block, see Std140.h.
+
+  GLSL 3.30 has no layout (binding = N), so the binding points are assigned from the CPU with glUniformBlockBinding
+  once a program is linked (assignUniformBlockBindings below).
+*/
+
+enum UniformBinding
+{
+    UNIFORM_BINDING_FRAME = 0, //FrameUniforms, bound once per frame
+    UNIFORM_BINDING_DRAW = 1   //DrawUniforms, bound per draw
+};
+
+//Same for every draw of the frame: the 2D view (see Frustum.h) and the texture layer the instanced draws show, -1 for
+//none, with the finest of its levels that is uploaded so far (see TextureManager.h)
+struct alignas(16) FrameUniforms
+{
+    std140::vec2 pan;
+    float zoom;
+    int textureLayer;
+    float textureMinLod;
+};
+STD140_OFFSET(FrameUniforms, pan, 0);
+STD140_OFFSET(FrameUniforms, zoom, 8);
+STD140_OFFSET(FrameUniforms, textureLayer, 12);
+STD140_OFFSET(FrameUniforms, textureMinLod, 16);
+STD140_SIZE(FrameUniforms, 32);
+
+#define FRAME_UNIFORMS_GLSL \
+"layout (std140) uniform FrameUniforms\n" \
+"{\n" \
+"    vec2 uPan;\n" \
+"    float uZoom;\n" \
+"    int uTextureLayer;\n" \
+"    float uTextureMinLod;\n" \
+"};\n"
+
+//One per draw: a color and a 2D transform applied to the whole draw (every instance of an instanced one)
+struct DrawUniforms
+{
+    std140::vec4 color;
+    std140::vec2 offset;
+    float scale;
+};
+STD140_OFFSET(DrawUniforms, color, 0);
+STD140_OFFSET(DrawUniforms, offset, 16);
+STD140_OFFSET(DrawUniforms, scale, 24);
+STD140_SIZE(DrawUniforms, 32);
+
+#define DRAW_UNIFORMS_GLSL \
+"layout (std140) uniform DrawUniforms\n" \
+"{\n" \
+"    vec4 uColor;\n" \
+"    vec2 uOffset;\n" \
+"    float uScale;\n" \
+"};\n"
+
+//Points the blocks a program uses at their binding points, and checks their size against the structs. Blocks the
+//program doesn't declare (or that the compiler removed as unused) are skipped.
+inline void assignUniformBlockBindings(GLuint program)
+{
+    struct Block
+    {
+        const char* name;
+        GLuint binding;
+        GLint size;
+    };
+    static const Block blocks[] = {
+        { "FrameUniforms", UNIFORM_BINDING_FRAME, (GLint)sizeof(FrameUniforms) },
+        { "DrawUniforms", UNIFORM_BINDING_DRAW, (GLint)sizeof(DrawUniforms) }
+    };
+
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        GLuint index = glGetUniformBlockIndex(program, blocks[i].name);
+        if (index == GL_INVALID_INDEX)
+            continue;
+        glUniformBlockBinding(program, index, blocks[i].binding);
+
+        GLint size = 0;
+        glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        if (size != blocks[i].size)
+            std::cout << "WARNING::UNIFORM_BLOCK::SIZE_MISMATCH " << blocks[i].name << " is " << size << " bytes in GLSL, "
+                << blocks[i].size << " in C++" << std::endl;
+    }
+}
@@ -0,0 +1,66 @@
+#include "UniformRing.h"
+#include "GLStateCache.h"
+
+#include <cstring>
+
+UniformRing::UniformRing()
+    : alignment(256), regionUsed(0), region(NULL)
+{
+}
+
+bool UniformRing::init(size_t largestBlock, int maxBlocks, bool forceMapRange)
+{
+    //256 is the largest alignment any driver asks for, in case the query fails
+    GLint offsetAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    alignment = (size_t)offsetAlignment;
+
+    size_t blockSize = (largestBlock + alignment - 1) / alignment * alignment;
+    return stream.init(GL_UNIFORM_BUFFER, blockSize * maxBlocks, forceMapRange);
+}
+
+void UniformRing::shutdown()
+{
+    stream.shutdown();
+    region = NULL;
+    regionUsed = 0;
+}
+
+void UniformRing::beginFrame()
+{
+    if (!enabled())
+        return;
+    region = (char*)stream.beginWrite();
+    regionUsed = 0;
+}
+
+void UniformRing::endWrite()
+{
+    if (region)
+        stream.endWrite();
+    region = NULL;
+}
+
+void UniformRing::endFrame()
+{
+    if (enabled())
+        stream.endFrame();
+}
+
+GLintptr UniformRing::push(const void* data, size_t size)
+{
+    if (!region || regionUsed + size > stream.regionSize())
+        return -1;
+
+    GLintptr offset = (GLintptr)(stream.regionOffset() + regionUsed);
+    memcpy(region + regionUsed, data, size);
+    regionUsed += (size + alignment - 1) / alignment * alignment;
+    return offset;
+}
+
+void UniformRing::bind(GLuint binding, GLintptr offset, GLsizeiptr size)
+{
+    if (offset < 0)
+        return;
+    GLStateCache::current().bindBufferRange(GL_UNIFORM_BUFFER, binding, stream.buffer(), offset, size);
+}
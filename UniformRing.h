@@ -0,0 +1,61 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+#include "StreamBuffer.h"
+
+//UNIFORM RING
+//***********************************************************
+/*
+  All uniform blocks of a frame go into one big uniform buffer. It is a StreamBuffer, so each frame writes its own
+  fenced region and never waits for (or overwrites) what the GPU is still reading from earlier frames.
+
+  Within the region the blocks are handed out back to back like a FrameArena, each one starting on a multiple of
+  GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT because that is what glBindBufferRange accepts. push() copies a block in and
+  returns its offset; bind() points a binding at it. Switching between draws is one glBindBufferRange instead of a
+  glUniform* call per value, and the data costs nothing to "upload": it's already in the buffer.
+
+      beginFrame()            maps the region (map-range mode) or waits for its fence
+      push() ...              every block of the frame, before any draw reads one
+      endWrite()              unmaps; from here on only bind() and draws
+      endFrame()              after the last draw, fences the region
+
+  The blocks have to be written before the draws: in map-range mode the buffer can't stay mapped while the GPU reads
+  from it.
+*/
+
+class UniformRing
+{
+public:
+    UniformRing();
+
+    //Makes room for maxBlocks blocks of up to largestBlock bytes per frame.
+    bool init(size_t largestBlock, int maxBlocks, bool forceMapRange = false);
+    void shutdown();
+
+    void beginFrame();
+    void endWrite();
+    void endFrame();
+
+    //Copies a block into this frame's region and returns its byte offset in buffer(), or -1 if the region is full (or
+    //not mapped).
+    GLintptr push(const void* data, size_t size);
+    template <class Block>
+    GLintptr push(const Block& block) { return push(&block, sizeof(Block)); }
+
+    //glBindBufferRange of a block returned by push(). -1 leaves the binding alone.
+    void bind(GLuint binding, GLintptr offset, GLsizeiptr size);
+    template <class Block>
+    void bind(GLuint binding, GLintptr offset) { bind(binding, offset, sizeof(Block)); }
+
+    bool enabled() const { return stream.buffer() != 0; }
+    GLuint buffer() const { return stream.buffer(); }
+    size_t used() const { return regionUsed; } //bytes pushed this frame
+
+private:
+    StreamBuffer stream;
+    size_t alignment;
+    size_t regionUsed;
+    char* region; //current region while it is written, NULL otherwise
+};
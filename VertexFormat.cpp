@@ -0,0 +1,220 @@
+#include "VertexFormat.h"
+
+#include <cmath>
+#include <cstring>
+
+VertexFormat::VertexFormat()
+    : vertexStride(0)
+{
+}
+
+int VertexFormat::add(GLuint location, int components, Type type, GLuint divisor)
+{
+    if (type == TYPE_SNORM_2_10_10_10)
+        components = 4;
+
+    Attribute attribute;
+    attribute.location = location;
+    attribute.components = components;
+    attribute.type = type;
+    attribute.divisor = divisor;
+    attribute.offset = vertexStride;
+    attributes.push_back(attribute);
+
+    vertexStride += (attributeSize(components, type) + 3) & ~(size_t)3; //keep the next attribute 4-byte aligned
+    return (int)attributes.size() - 1;
+}
+
+size_t VertexFormat::attributeSize(int components, Type type)
+{
+    switch (type)
+    {
+    case TYPE_FLOAT: return components * sizeof(GLfloat);
+    case TYPE_HALF: return components * sizeof(GLushort);
+    case TYPE_SNORM8:
+    case TYPE_UNORM8: return components * sizeof(GLbyte);
+    case TYPE_SNORM16:
+    case TYPE_UNORM16: return components * sizeof(GLshort);
+    case TYPE_SNORM_2_10_10_10: return sizeof(GLuint);
+    }
+    return 0;
+}
+
+const char* VertexFormat::typeName(Type type)
+{
+    switch (type)
+    {
+    case TYPE_FLOAT: return "float";
+    case TYPE_HALF: return "half";
+    case TYPE_SNORM8: return "byte";
+    case TYPE_UNORM8: return "ubyte";
+    case TYPE_SNORM16: return "short";
+    case TYPE_UNORM16: return "ushort";
+    case TYPE_SNORM_2_10_10_10: return "packed";
+    }
+    return "?";
+}
+
+bool VertexFormat::parseType(const char* name, Type& type)
+{
+    static const Type types[] = { TYPE_FLOAT, TYPE_HALF, TYPE_SNORM16, TYPE_SNORM8, TYPE_SNORM_2_10_10_10 };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if (strcmp(name, typeName(types[i])) == 0)
+        {
+            type = types[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void VertexFormat::enableAttributes() const
+{
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        glEnableVertexAttribArray(attributes[i].location); //enables vertex attribute, they are disabled by default
+        glVertexAttribDivisor(attributes[i].location, attributes[i].divisor);
+    }
+}
+
+void VertexFormat::pointAttributes(size_t baseOffset) const
+{
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        const Attribute& a = attributes[i];
+        const void* pointer = (const void*)(baseOffset + a.offset);
+        GLsizei stride = (GLsizei)vertexStride;
+
+        //type and normalized flag: how the stored values turn back into the floats the shader sees
+        switch (a.type)
+        {
+        case TYPE_FLOAT: glVertexAttribPointer(a.location, a.components, GL_FLOAT, GL_FALSE, stride, pointer); break;
+        case TYPE_HALF: glVertexAttribPointer(a.location, a.components, GL_HALF_FLOAT, GL_FALSE, stride, pointer); break;
+        case TYPE_SNORM8: glVertexAttribPointer(a.location, a.components, GL_BYTE, GL_TRUE, stride, pointer); break;
+        case TYPE_UNORM8: glVertexAttribPointer(a.location, a.components, GL_UNSIGNED_BYTE, GL_TRUE, stride, pointer); break;
+        case TYPE_SNORM16: glVertexAttribPointer(a.location, a.components, GL_SHORT, GL_TRUE, stride, pointer); break;
+        case TYPE_UNORM16: glVertexAttribPointer(a.location, a.components, GL_UNSIGNED_SHORT, GL_TRUE, stride, pointer); break;
+        case TYPE_SNORM_2_10_10_10: glVertexAttribPointer(a.location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, pointer); break;
+        }
+    }
+}
+
+static float clampf(float value, float low, float high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+//float in [-1, 1] (or [0, 1]) to a normalized integer with maxValue as 1.0
+static int toNormalized(float value, int maxValue, bool isSigned)
+{
+    value = clampf(value, isSigned ? -1.0f : 0.0f, 1.0f);
+    return (int)std::floor(value * maxValue + 0.5f);
+}
+
+void VertexFormat::write(void* vertex, int index, const float* values) const
+{
+    const Attribute& a = attributes[index];
+    unsigned char* out = (unsigned char*)vertex + a.offset;
+
+    switch (a.type)
+    {
+    case TYPE_FLOAT:
+        memcpy(out, values, a.components * sizeof(float));
+        break;
+    case TYPE_HALF:
+        for (int c = 0; c < a.components; c++)
+            ((GLushort*)out)[c] = floatToHalf(values[c]);
+        break;
+    case TYPE_SNORM8:
+        for (int c = 0; c < a.components; c++)
+            ((GLbyte*)out)[c] = (GLbyte)toNormalized(values[c], 127, true);
+        break;
+    case TYPE_UNORM8:
+        for (int c = 0; c < a.components; c++)
+            ((GLubyte*)out)[c] = (GLubyte)toNormalized(values[c], 255, false);
+        break;
+    case TYPE_SNORM16:
+        for (int c = 0; c < a.components; c++)
+            ((GLshort*)out)[c] = (GLshort)toNormalized(values[c], 32767, true);
+        break;
+    case TYPE_UNORM16:
+        for (int c = 0; c < a.components; c++)
+            ((GLushort*)out)[c] = (GLushort)toNormalized(values[c], 65535, false);
+        break;
+    case TYPE_SNORM_2_10_10_10:
+    {
+        //x in bits 0-9, y in 10-19, z in 20-29, w in 30-31; each field is two's complement
+        GLuint x = (GLuint)toNormalized(values[0], 511, true) & 0x3FF;
+        GLuint y = (GLuint)toNormalized(values[1], 511, true) & 0x3FF;
+        GLuint z = (GLuint)toNormalized(values[2], 511, true) & 0x3FF;
+        GLuint w = 1; //only 2 bits, and positions come with 3 components; 1 decodes to 1.0
+        GLuint packed = x | (y << 10) | (z << 20) | (w << 30);
+        memcpy(out, &packed, sizeof(packed));
+        break;
+    }
+    }
+}
+
+void VertexFormat::encodePositions(const std::vector<float>& positions, std::vector<unsigned char>& bytes) const
+{
+    size_t count = positions.size() / 3;
+    bytes.assign(count * vertexStride, 0);
+    for (size_t v = 0; v < count; v++)
+    {
+        for (size_t a = 0; a < attributes.size(); a++)
+        {
+            if (attributes[a].location == 0)
+                write(&bytes[v * vertexStride], (int)a, &positions[v * 3]);
+        }
+    }
+}
+
+bool VertexFormat::matches(const VertexFormat& other) const
+{
+    if (vertexStride != other.vertexStride || attributes.size() != other.attributes.size())
+        return false;
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        const Attribute& a = attributes[i];
+        const Attribute& b = other.attributes[i];
+        if (a.location != b.location || a.components != b.components || a.type != b.type || a.divisor != b.divisor ||
+            a.offset != b.offset)
+            return false;
+    }
+    return true;
+}
+
+GLushort floatToHalf(float value)
+{
+    GLuint bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    GLuint sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    GLuint mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) //infinity or NaN
+        return (GLushort)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31) //too big, becomes infinity
+        return (GLushort)(sign | 0x7C00);
+    if (exponent <= 0) //subnormal half or zero
+    {
+        if (exponent < -10)
+            return (GLushort)sign;
+        mantissa |= 0x800000; //implicit leading 1
+        int shift = 14 - exponent;
+        GLuint half = mantissa >> shift;
+        GLuint rest = mantissa & ((1u << shift) - 1);
+        GLuint halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return (GLushort)(sign | half);
+    }
+
+    GLuint half = sign | ((GLuint)exponent << 10) | (mantissa >> 13);
+    GLuint rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++; //may carry into the exponent, which correctly rounds up to the next power of two or infinity
+    return (GLushort)half;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+//VERTEX FORMATS
+//***********************************************************
+/*
+  glVertexAttribPointer doesn't require the data to be floats. The type parameter says how the values are stored in the
+  buffer and the normalized parameter says how integers are turned back into floats for the shader:
+      GL_HALF_FLOAT                   16-bit floats, half the size of GL_FLOAT
+      GL_BYTE / GL_SHORT, normalized  signed integers mapped to [-1, 1] (127 or 32767 becomes 1.0)
+      GL_UNSIGNED_BYTE, normalized    mapped to [0, 1], the usual choice for colors
+      GL_INT_2_10_10_10_REV           x, y, z in 10 bits each and w in 2 bits, packed into one 32-bit integer
+  The shader still declares a vec3/vec4 and never notices; the vertex fetch hardware does the conversion for free. A
+  position drops from 12 bytes to 8 (half, short) or 4 (2_10_10_10), and so does the memory bandwidth per vertex.
+
+  A VertexFormat describes one interleaved vertex: which attributes it has, at which location, stored how. From that it
+  computes the offsets and the stride, issues the matching glVertexAttribPointer calls for the bound VAO, and encodes
+  float data into the packed layout. Normalized formats can only hold values in [-1, 1] ([0, 1] unsigned), so they
+  suit positions only when the mesh fits in that box, as ours do.
+
+  Every attribute starts on a 4-byte boundary: some hardware fetches misaligned attributes on a slow path.
+*/
+
+class VertexFormat
+{
+public:
+    enum Type
+    {
+        TYPE_FLOAT,
+        TYPE_HALF,
+        TYPE_SNORM8,
+        TYPE_UNORM8,
+        TYPE_SNORM16,
+        TYPE_UNORM16,
+        TYPE_SNORM_2_10_10_10 //always 4 components, w gets 2 bits
+    };
+
+    struct Attribute
+    {
+        GLuint location;
+        int components;
+        Type type;
+        GLuint divisor; //0 = per vertex, 1 = per instance
+        size_t offset;
+    };
+
+    VertexFormat();
+
+    //Appends an attribute after the previous ones and returns its index.
+    int add(GLuint location, int components, Type type, GLuint divisor = 0);
+
+    size_t stride() const { return vertexStride; }
+    int attributeCount() const { return (int)attributes.size(); }
+    const Attribute& attribute(int index) const { return attributes[index]; }
+
+    //Enables every attribute of the bound VAO and sets its divisor. Only needed once per VAO.
+    void enableAttributes() const;
+
+    //Points every attribute at the buffer bound to GL_ARRAY_BUFFER, starting baseOffset bytes in.
+    void pointAttributes(size_t baseOffset = 0) const;
+
+    //Encodes values (one float per component) into attribute index of the vertex at dst. Out of range values of
+    //normalized types are clamped.
+    void write(void* vertex, int index, const float* values) const;
+
+    //Encodes positions (x, y, z per vertex) into every attribute at location 0 of a new vertex array in bytes; the
+    //other attributes are zero.
+    void encodePositions(const std::vector<float>& positions, std::vector<unsigned char>& bytes) const;
+
+    //Same attributes at the same offsets and the same stride.
+    bool matches(const VertexFormat& other) const;
+
+    static size_t attributeSize(int components, Type type);
+    static const char* typeName(Type type);
+
+    //"float", "half", "short", "byte" or "packed" as used by --vertex-format; false if name is none of them.
+    static bool parseType(const char* name, Type& type);
+
+private:
+    std::vector<Attribute> attributes;
+    size_t vertexStride;
+};
+
+//IEEE 754 half precision, rounded to nearest even.
+GLushort floatToHalf(float value);
@@ -0,0 +1,373 @@
+#include "WindowPresenter.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "GLDebug.h"
+
+const int WindowPresenter::MAX_WINDOWS;
+const int WindowPresenter::SLOT_COUNT;
+const int WindowPresenter::ALLOCATION_STEP;
+
+static int roundUpToStep(int size)
+{
+    return (std::max(1, size) + WindowPresenter::ALLOCATION_STEP - 1) / WindowPresenter::ALLOCATION_STEP *
+        WindowPresenter::ALLOCATION_STEP;
+}
+
+WindowPresenter::WindowPresenter()
+    : count(0), running(false), latest(-1), sequence(0), stopping(false), readyCount(0), publishedCount(0),
+      droppedCount(0)
+{
+    for (int i = 0; i < MAX_WINDOWS; i++)
+    {
+        Window& w = windows[i];
+        w.window = NULL;
+        w.width.store(1);
+        w.height.store(1);
+        w.presented.store(0);
+        for (int s = 0; s < SLOT_COUNT; s++)
+            w.attached[s] = 0;
+    }
+    for (int s = 0; s < SLOT_COUNT; s++)
+    {
+        Slot& slot = slots[s];
+        slot.capacityWidth = slot.capacityHeight = 0;
+        slot.width = slot.height = 0;
+        slot.generation = 0;
+        slot.written = 0;
+        for (int i = 0; i < MAX_WINDOWS; i++)
+            slot.read[i] = 0;
+        slot.readers = 0;
+    }
+}
+
+WindowPresenter::~WindowPresenter()
+{
+    //stop() needs the render context; this only makes sure no thread outlives the object
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_all();
+    for (int i = 0; i < count; i++)
+        if (windows[i].thread.joinable())
+            windows[i].thread.join();
+}
+
+bool WindowPresenter::addWindow(GLFWwindow* window, int width, int height)
+{
+    if (count == MAX_WINDOWS)
+        return false;
+    Window& w = windows[count++];
+    w.window = window;
+    w.width.store(std::max(1, width));
+    w.height.store(std::max(1, height));
+    return true;
+}
+
+bool WindowPresenter::resize(GLFWwindow* window, int width, int height)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (windows[i].window != window)
+            continue;
+        windows[i].width.store(std::max(1, width));
+        windows[i].height.store(std::max(1, height));
+        return true;
+    }
+    return false;
+}
+
+bool WindowPresenter::start()
+{
+    if (count == 0)
+        return false;
+    for (int s = 0; s < SLOT_COUNT; s++)
+    {
+        if (!slots[s].framebuffer.create("mirror slot framebuffer"))
+        {
+            std::cout << "ERROR::WINDOWS::FRAMEBUFFER_CREATION_FAILED" << std::endl;
+            stop();
+            return false;
+        }
+    }
+    stopping = false;
+    readyCount = 0;
+    for (int i = 0; i < count; i++)
+        windows[i].thread = std::thread(&WindowPresenter::presenterMain, this, i);
+    //the first frame waits for the presenters to be set up, or its first copies would wait in their place
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (readyCount < count)
+            frameReady.wait(lock);
+    }
+    running = true;
+    return true;
+}
+
+void WindowPresenter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_all();
+    for (int i = 0; i < count; i++)
+        if (windows[i].thread.joinable())
+            windows[i].thread.join();
+    running = false;
+
+    //the presenters are gone, what they fenced is deleted from here (sync objects are shared too)
+    for (int s = 0; s < SLOT_COUNT; s++)
+    {
+        Slot& slot = slots[s];
+        if (slot.written)
+            glDeleteSync(slot.written);
+        slot.written = 0;
+        for (int i = 0; i < MAX_WINDOWS; i++)
+        {
+            if (slot.read[i])
+                glDeleteSync(slot.read[i]);
+            slot.read[i] = 0;
+        }
+        slot.texture.reset();
+        slot.framebuffer.reset();
+        slot.capacityWidth = slot.capacityHeight = 0;
+    }
+    latest = -1;
+}
+
+bool WindowPresenter::allocate(Slot& slot, int width, int height)
+{
+    //a new texture, like RenderTarget: the presenters' framebuffers keep the old one alive until they move on
+    GLTexture texture;
+    if (!texture.create("mirror slot color"))
+        return false;
+    GLStateCache::current().bindTexture(0, GL_TEXTURE_2D, texture.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, roundUpToStep(width), roundUpToStep(height), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+        NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, slot.framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.get(), 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::WINDOWS::INCOMPLETE 0x" << std::hex << status << std::dec << std::endl;
+        return false;
+    }
+
+    slot.texture = std::move(texture);
+    slot.capacityWidth = roundUpToStep(width);
+    slot.capacityHeight = roundUpToStep(height);
+    slot.generation++;
+    return true;
+}
+
+void WindowPresenter::publish(int width, int height)
+{
+    if (!running)
+        return;
+    width = std::max(1, width);
+    height = std::max(1, height);
+
+    // a slot nobody holds, the oldest first
+    // ------------------------------------
+    int s = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int k = 1; k <= SLOT_COUNT && s < 0; k++)
+        {
+            int candidate = (latest + k + SLOT_COUNT) % SLOT_COUNT;
+            if (candidate != latest && slots[candidate].readers == 0)
+                s = candidate;
+        }
+        if (s < 0)
+        {
+            droppedCount++; //every presenter is still on an older frame
+            return;
+        }
+        //the GPU waits for the blits out of it that may still be running, the CPU doesn't
+        Slot& slot = slots[s];
+        for (int i = 0; i < count; i++)
+        {
+            if (!slot.read[i])
+                continue;
+            glWaitSync(slot.read[i], 0, GL_TIMEOUT_IGNORED);
+            glDeleteSync(slot.read[i]);
+            slot.read[i] = 0;
+        }
+        //only presenters that took the slot waited for it, and none holds it now
+        if (slot.written)
+            glDeleteSync(slot.written);
+        slot.written = 0;
+    }
+    // ------------------------------------
+
+    // copy the back buffer into it
+    // ------------------------------------
+    //outside the lock; presenters only ever take the latest slot, which this one isn't
+    Slot& slot = slots[s];
+    bool grow = width > slot.capacityWidth || height > slot.capacityHeight;
+    bool shrink = roundUpToStep(width) * roundUpToStep(height) * 2 < slot.capacityWidth * slot.capacityHeight;
+    if ((grow || shrink) && !allocate(slot, width, height))
+    {
+        std::cout << "WARNING::WINDOWS::SLOT_ALLOCATION_FAILED" << std::endl;
+        droppedCount++;
+        return;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, slot.framebuffer.get());
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLsync written = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush(); //the presenters' contexts wait for this fence
+    // ------------------------------------
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slot.width = width;
+        slot.height = height;
+        slot.written = written;
+        latest = s;
+        sequence++;
+    }
+    frameReady.notify_all();
+    publishedCount++;
+}
+
+void WindowPresenter::presenterMain(int index)
+{
+    Window& w = windows[index];
+    glfwMakeContextCurrent(w.window);
+    w.glState.makeCurrent();
+    w.glObjects.makeCurrent();
+    w.deletionQueue.makeCurrent();
+    if (glDebugOutputEnabled())
+        enableGLDebugOutput("present", true);
+    //every window waits for its own display's refresh, which only blocks this thread
+    glfwSwapInterval(1);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    bool ok = true;
+    for (int s = 0; s < SLOT_COUNT && ok; s++)
+        ok = w.framebuffers[s].create("mirror window framebuffer");
+    if (ok)
+        warmUp(w);
+    else
+        std::cout << "ERROR::WINDOWS::FRAMEBUFFER_CREATION_FAILED window " << index + 2 << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readyCount++;
+    }
+    frameReady.notify_all();
+
+    unsigned long long shown = 0;
+    while (ok)
+    {
+        // take the newest frame
+        // ------------------------------------
+        int s;
+        GLsync written;
+        GLuint texture;
+        unsigned int generation;
+        int width, height;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && sequence == shown)
+                frameReady.wait(lock);
+            if (stopping)
+                break;
+            shown = sequence;
+            s = latest;
+            Slot& slot = slots[s];
+            slot.readers++;
+            written = slot.written;
+            texture = slot.texture.get();
+            generation = slot.generation;
+            width = slot.width;
+            height = slot.height;
+        }
+        // ------------------------------------
+
+        glWaitSync(written, 0, GL_TIMEOUT_IGNORED); //the render context's blit into it runs first
+        present(w, s, texture, generation, width, height);
+        GLsync read = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush(); //publish() waits for it on the render context
+
+        // hand it back
+        // ------------------------------------
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Slot& slot = slots[s];
+            if (slot.read[index])
+                glDeleteSync(slot.read[index]); //publish() collects these when it reuses the slot, so only ever at exit
+            slot.read[index] = read;
+            slot.readers--;
+        }
+        // ------------------------------------
+
+        glfwSwapBuffers(w.window);
+        w.presented.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (int s = 0; s < SLOT_COUNT; s++)
+        w.framebuffers[s].reset();
+    w.deletionQueue.flush();
+    w.glObjects.reportLeaks();
+    glfwMakeContextCurrent(NULL);
+}
+
+void WindowPresenter::warmUp(Window& w)
+{
+    //a texture of the size the slots will have, shown once at 1:1 and once scaled, which drivers may do differently;
+    //then thrown away
+    int width = w.width.load();
+    int height = w.height.load();
+    GLTexture texture;
+    if (!texture.create("mirror warm-up color"))
+        return;
+    GLStateCache::current().bindTexture(0, GL_TEXTURE_2D, texture.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, roundUpToStep(width), roundUpToStep(height), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+        NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, w.framebuffers[0].get());
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.get(), 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width / 2, height / 2, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glFinish();
+    texture.reset();
+    w.deletionQueue.flush(); //the GPU is done with it, glFinish said so
+}
+
+void WindowPresenter::present(Window& w, int s, GLuint texture, unsigned int generation, int width, int height)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, w.framebuffers[s].get());
+    if (w.attached[s] != generation)
+    {
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        w.attached[s] = generation;
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    //scaled to fit with the aspect ratio kept, the bars left black
+    int windowWidth = w.width.load();
+    int windowHeight = w.height.load();
+    float scale = std::min((float)windowWidth / width, (float)windowHeight / height);
+    int shownWidth = (int)(width * scale + 0.5f);
+    int shownHeight = (int)(height * scale + 0.5f);
+    int x = (windowWidth - shownWidth) / 2;
+    int y = (windowHeight - shownHeight) / 2;
+    glViewport(0, 0, windowWidth, windowHeight);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBlitFramebuffer(0, 0, width, height, x, y, x + shownWidth, y + shownHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
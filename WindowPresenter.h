@@ -0,0 +1,133 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "GLDeletionQueue.h"
+#include "GLObjects.h"
+#include "GLResource.h"
+#include "GLStateCache.h"
+
+//MORE WINDOWS
+//***********************************************************
+/*
+  With --windows <n> the frame is shown in n windows, one per monitor where there are enough of them. The obvious ways
+  to get there both waste something:
+
+  N processes: every process uploads its own copy of every buffer, program and texture, so video memory grows with
+  every screen, and the scenes drift apart.
+  One thread swapping N windows: with vsync each glfwSwapBuffers blocks until its display's next refresh, so the swaps
+  queue up behind each other. Two 60 Hz displays that aren't in phase leave the thread waiting twice per frame, and a
+  30 Hz display drags a 144 Hz one down to its rate.
+
+  Here the render thread draws the scene once, into the main window, exactly as without --windows. Every other window
+  has a context of its own that shares objects with the render context (the share argument of glfwCreateWindow), and a
+  presenter thread that owns that context and does nothing but show the newest frame and swap. Its swap blocks only
+  itself, so each window runs at its own display's rate, and one that falls behind simply skips frames.
+
+  Buffers, textures, programs and sync objects are shared between contexts, but vertex arrays and framebuffers are
+  not: they are containers that only point at other objects and stay with the context that made them. That is why the
+  other contexts don't draw the scene themselves, which would need their own VAOs and the whole replay. The render
+  thread copies the finished back buffer into one of SLOT_COUNT shared textures (a glBlitFramebuffer on the GPU, no
+  read back), and a presenter blits that texture into its window through a framebuffer of its own, scaled to fit.
+  The slots are shared by every window, so what another screen costs is its swap chain and a thread, nothing that
+  grows with the scene.
+
+  Neither side ever waits for the other on the CPU:
+      publish()    picks a slot no presenter holds, queues a glWaitSync for the reads of it still on the GPU, blits
+                   the frame into it and fences that. If every slot is held, the frame is not mirrored (dropped()).
+      presenters   take the newest slot, queue a glWaitSync for its fence, blit, fence the read and hand the slot
+                   back, then swap.
+  The fences are flushed right away, a context may not wait for a fence another context hasn't flushed yet.
+*/
+
+class WindowPresenter
+{
+public:
+    static const int MAX_WINDOWS = 8;  //besides the main window
+    static const int SLOT_COUNT = 3;   //shared frame textures, for every window together
+    static const int ALLOCATION_STEP = 64;
+
+    WindowPresenter();
+    ~WindowPresenter();
+
+    //Main thread, before start(). window's context has to share objects with the render context; width x height is
+    //its framebuffer size. Returns false when MAX_WINDOWS are taken.
+    bool addWindow(GLFWwindow* window, int width, int height);
+    //Main thread: a window's framebuffer has a new size. Returns false if window isn't one of ours.
+    bool resize(GLFWwindow* window, int width, int height);
+
+    //Render thread, context current: creates the slot framebuffers and starts a presenter thread per window. Returns
+    //once each has its context set up and has blitted once.
+    bool start();
+    //Render thread, after the frame was drawn into the width x height back buffer and before the swap.
+    void publish(int width, int height);
+    //Render thread: stops the presenters and deletes the slots.
+    void stop();
+
+    int windowCount() const { return count; }
+    bool active() const { return running; }
+    unsigned long long published() const { return publishedCount; }
+    unsigned long long dropped() const { return droppedCount; }
+    unsigned long long presented(int window) const { return windows[window].presented.load(std::memory_order_relaxed); }
+
+private:
+    WindowPresenter(const WindowPresenter&);
+    WindowPresenter& operator=(const WindowPresenter&);
+
+    //one frame texture, render context side
+    struct Slot
+    {
+        GLTexture texture;
+        GLFramebuffer framebuffer;
+        int capacityWidth;
+        int capacityHeight;
+        int width;          //of the frame in it
+        int height;
+        unsigned int generation; //bumped with every new texture, so presenters know to point their framebuffer at it
+        GLsync written;     //behind the blit that filled it
+        GLsync read[MAX_WINDOWS]; //behind each presenter's last blit out of it, 0 if none is outstanding
+        int readers;        //presenters between taking and handing back the slot
+    };
+
+    //one extra window and its presenter thread
+    struct Window
+    {
+        GLFWwindow* window;
+        std::thread thread;
+        std::atomic<int> width;  //framebuffer size, set by the main thread
+        std::atomic<int> height;
+        std::atomic<unsigned long long> presented;
+        unsigned int attached[SLOT_COUNT]; //slot generation each framebuffer below points at, 0 for none
+
+        //the presenter's own per-context state, see GLStateCache.h / GLObjects.h
+        GLStateCache glState;
+        GLObjects glObjects;
+        GLDeletionQueue deletionQueue;
+        GLFramebuffer framebuffers[SLOT_COUNT]; //framebuffers aren't shared, so each context points its own at the slots
+    };
+
+    bool allocate(Slot& slot, int width, int height);
+    void presenterMain(int index);
+    void warmUp(Window& window); //drivers build their blit shaders on first use, better before the first frame
+    void present(Window& window, int slot, GLuint texture, unsigned int generation, int width, int height);
+
+    Window windows[MAX_WINDOWS];
+    int count;
+    bool running;
+
+    Slot slots[SLOT_COUNT];
+    std::mutex mutex;            //guards the slots' fences, readers and the fields below
+    std::condition_variable frameReady;
+    int latest;                  //slot of the newest frame, -1 before the first
+    unsigned long long sequence; //frames published so far
+    bool stopping;
+    int readyCount;              //presenters done with their setup
+
+    unsigned long long publishedCount;
+    unsigned long long droppedCount;
+};
@@ -0,0 +1,6 @@
+// See basic.vert for what is declared in front of this file.
+out vec4 FragColor;
+void main()
+{
+   FragColor = uColor;
+}
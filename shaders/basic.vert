@@ -0,0 +1,9 @@
+// The tutorial triangle. The renderer puts "#version 330 core" and the uniform blocks of UniformBlocks.h in front of
+// this file, so uColor, uOffset, uScale (DrawUniforms) and uPan, uZoom, uTextureLayer, uTextureMinLod (FrameUniforms) are
+// already declared.
+// Saved changes are picked up while the program runs.
+layout (location = 0) in vec3 aPos;
+void main()
+{
+   gl_Position = vec4(aPos.xy * uScale + uOffset, aPos.z, 1.0);
+}
@@ -0,0 +1,18 @@
+// See basic.vert for what is declared in front of this file. uTexture is the texture array TextureManager.h binds to
+// unit 0: layer uTextureLayer of it is shown, none if that is -1, and levels finer than uTextureMinLod aren't uploaded
+// yet.
+in vec4 vColor;
+in vec2 vUV;
+uniform sampler2DArray uTexture;
+out vec4 FragColor;
+void main()
+{
+   // the level texture() would pick, clamped to the ones that are there
+   vec2 texel = vUV * vec2(textureSize(uTexture, 0).xy);
+   vec2 dx = dFdx(texel);
+   vec2 dy = dFdy(texel);
+   float lod = max(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), uTextureMinLod);
+   FragColor = vColor;
+   if (uTextureLayer >= 0)
+      FragColor *= textureLod(uTexture, vec3(vUV, float(uTextureLayer)), lod);
+}
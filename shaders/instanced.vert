@@ -0,0 +1,19 @@
+// Each copy of the mesh gets its own offset, scale, rotation and color from the instance VBO. The locations match
+// InstancedBatch::TRANSFORM_LOCATION and InstancedBatch::COLOR_LOCATION. FrameUniforms pans and zooms the whole scene
+// the same way Frustum::fromView() assumes; DrawUniforms tints and moves one draw. See basic.vert for what is declared
+// in front of this file.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aTransform; // xy = offset, z = scale, w = rotation
+layout (location = 2) in vec4 aColor;
+out vec4 vColor;
+out vec2 vUV;
+void main()
+{
+   float c = cos(aTransform.w);
+   float s = sin(aTransform.w);
+   vec2 p = mat2(c, s, -s, c) * aPos.xy * aTransform.z + aTransform.xy;
+   p = p * uScale + uOffset;
+   gl_Position = vec4((p - uPan) * uZoom, aPos.z, 1.0);
+   vColor = aColor * uColor;
+   vUV = aPos.xy + 0.5; // the meshes have no texture coordinates, so the texture is projected onto them from the front
+}